@@ -0,0 +1,136 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CTFFlatFile.h
+/// \brief Flat, memory-mappable alternative to the CTF tree: the flat EncodedBlocks images
+/// of the detectors are stored page-aligned, followed by the index of the TFs and a trailer.
+///
+/// Layout: [CTFFlatFileHeader, padded to page] [image]...[image] [CTFFlatTFEntry x nTFs] [CTFFlatFileTrailer]
+/// Every image starts at a page boundary, so that the mapped images satisfy the EncodedBlocks alignment
+/// and can be used in place via EncodedBlocks::getImage.
+
+#ifndef ALICEO2_CTF_FLATFILE_H
+#define ALICEO2_CTF_FLATFILE_H
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DetectorsCommonDataFormats/DetID.h"
+#include "DetectorsCommonDataFormats/CTFHeader.h"
+
+namespace o2
+{
+namespace ctf
+{
+
+struct CTFFlatFileHeader {
+  static constexpr uint64_t Magic = 0x544c46465443324f; // "O2CTFFLT" in little endian
+  static constexpr uint32_t Version = 1;
+  static constexpr uint32_t PageSize = 4096;
+
+  uint64_t magic = Magic;
+  uint32_t version = Version;
+  uint32_t pageSize = PageSize;
+};
+
+struct CTFFlatBlockEntry {
+  uint64_t offset = 0; // offset of the image from the file start
+  uint64_t size = 0;   // size of the image in bytes, 0 if the detector is absent
+};
+
+struct CTFFlatTFEntry {
+  uint64_t run = 0;
+  uint32_t firstTForbit = 0;
+  uint32_t detectors = 0; // mask of stored detectors
+  std::array<CTFFlatBlockEntry, o2::detectors::DetID::nDetectors> blocks{};
+
+  CTFHeader getCTFHeader() const { return CTFHeader{run, firstTForbit, o2::detectors::DetID::mask_t(detectors)}; }
+};
+
+struct CTFFlatFileTrailer {
+  uint64_t indexOffset = 0; // offset of the 1st CTFFlatTFEntry
+  uint64_t nTFs = 0;
+  uint64_t magic = CTFFlatFileHeader::Magic;
+};
+
+/// sequential writer of the flat CTF file
+class CTFFlatFileWriter
+{
+ public:
+  CTFFlatFileWriter() = default;
+  ~CTFFlatFileWriter() { close(); }
+
+  void open(const std::string& fname);
+  bool isOpen() const { return mFile.is_open(); }
+  const std::string& getName() const { return mName; }
+
+  /// append page-aligned image of the detector to the current TF, return number of bytes written (including padding)
+  size_t addBlock(o2::detectors::DetID det, const void* data, size_t size);
+
+  /// close the current TF, registering it in the index with the provided header
+  void finishTF(const CTFHeader& header);
+
+  /// write index and trailer and close the file
+  void close();
+
+  size_t getNTFs() const { return mIndex.size(); }
+  size_t getSize() const { return mOffset; }
+
+ private:
+  size_t pad();
+
+  std::string mName;
+  std::ofstream mFile;
+  uint64_t mOffset = 0;
+  CTFFlatTFEntry mCurrent;
+  std::vector<CTFFlatTFEntry> mIndex;
+};
+
+/// random-access reader of the flat CTF file, the file is mapped into memory and the images are served w/o copying
+class CTFFlatFileReader
+{
+ public:
+  CTFFlatFileReader() = default;
+  ~CTFFlatFileReader() { close(); }
+
+  /// check if the file is in the flat CTF format (by its leading magic)
+  static bool isFlatFile(const std::string& fname);
+
+  void open(const std::string& fname);
+  void close();
+  bool isOpen() const { return mMapping != nullptr; }
+  const std::string& getName() const { return mName; }
+
+  size_t getNTFs() const { return mNTFs; }
+  const CTFFlatTFEntry& getEntry(size_t tf) const { return mIndex[tf]; }
+  CTFHeader getCTFHeader(size_t tf) const { return mIndex[tf].getCTFHeader(); }
+
+  /// pointer on the image of the detector for given TF (nullptr if absent), size is set to its size in bytes
+  const char* getBlock(size_t tf, o2::detectors::DetID det, size_t& size) const;
+
+  /// mapped region, to be owned by whoever needs the images to survive closing of the reader
+  const std::shared_ptr<const char>& getMapping() const { return mMapping; }
+
+ private:
+  std::string mName;
+  std::shared_ptr<const char> mMapping;
+  size_t mFileSize = 0;
+  size_t mNTFs = 0;
+  const CTFFlatTFEntry* mIndex = nullptr;
+};
+
+} // namespace ctf
+} // namespace o2
+
+#endif
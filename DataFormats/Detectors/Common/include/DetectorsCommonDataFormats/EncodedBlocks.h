@@ -18,6 +18,9 @@
 #define ALICEO2_ENCODED_BLOCKS_H
 
 #include <type_traits>
+#include <atomic>
+#include <future>
+#include <tuple>
 #include <Rtypes.h>
 #include "rANS/rans.h"
 #include "rANS/utils.h"
@@ -34,6 +37,25 @@ namespace ctf
 namespace detail
 {
 
+/// call functor with the number of interleaved rANS streams as a compile time constant
+template <typename F>
+inline decltype(auto) dispatchNStreams(uint8_t nStreams, F&& f)
+{
+  switch (nStreams) {
+    case 2:
+      return f(std::integral_constant<size_t, 2>{});
+    case 4:
+      return f(std::integral_constant<size_t, 4>{});
+    case 8:
+      return f(std::integral_constant<size_t, 8>{});
+    case 16:
+      return f(std::integral_constant<size_t, 16>{});
+    default:
+      LOG(ERROR) << "Unsupported number of interleaved rANS streams " << int(nStreams);
+      throw std::runtime_error("unsupported number of interleaved rANS streams");
+  }
+}
+
 template <class, class Enable = void>
 struct is_iterator : std::false_type {
 };
@@ -47,11 +69,49 @@ struct is_iterator<T, std::enable_if_t<
 
 template <class T>
 inline constexpr bool is_iterator_v = is_iterator<T>::value;
+
+/// call f(i) for i in [0, nJobs) distributing the calls over up to nThreads threads, exceptions are rethrown in the caller
+template <typename F>
+inline void runParallel(int nJobs, int nThreads, F&& f)
+{
+  nThreads = std::max(1, std::min(nThreads, nJobs));
+  if (nThreads == 1) {
+    for (int i = 0; i < nJobs; i++) {
+      f(i);
+    }
+    return;
+  }
+  std::atomic<int> next{0};
+  auto worker = [&]() {
+    int i;
+    while ((i = next++) < nJobs) {
+      f(i);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  for (int it = 1; it < nThreads; it++) {
+    futures.emplace_back(std::async(std::launch::async, worker));
+  }
+  worker();
+  for (auto& fut : futures) {
+    fut.get();
+  }
+}
+
+/// call f on the element of tuple t with runtime index i
+template <typename Tuple, typename F, size_t... Is>
+inline void visitTupleElement(Tuple& t, size_t i, F&& f, std::index_sequence<Is...>)
+{
+  ((i == Is ? f(std::get<Is>(t)) : void()), ...);
+}
 } // namespace detail
 
 using namespace o2::rans;
 constexpr size_t Alignment = 16;
 
+constexpr size_t SizeEstMarginAbs = 10 * 1024; // absolute margin (in words) for the estimate of the encoded data size
+constexpr float SizeEstMarginRel = 1.05;        // relative margin for the estimate of the encoded data size
+
 constexpr int WrappersSplitLevel = 99;
 constexpr int WrappersCompressionLevel = 1;
 
@@ -117,6 +177,8 @@ struct Metadata {
   int nDictWords = 0;
   int nDataWords = 0;
   int nLiteralWords = 0;
+  uint8_t nStreams = rans::internal::DefaultNStreams; // number of interleaved rANS states used for entropy coding
+  uint32_t dictID = 0;                                // ID of the (adaptive) dictionary used for encoding, 0 if not shared between CTFs
 
   void clear()
   {
@@ -129,8 +191,10 @@ struct Metadata {
     nDictWords = 0;
     nDataWords = 0;
     nLiteralWords = 0;
+    nStreams = rans::internal::DefaultNStreams;
+    dictID = 0;
   }
-  ClassDefNV(Metadata, 1);
+  ClassDefNV(Metadata, 3);
 };
 
 /// registry struct for the buffer start and offsets of writable space
@@ -257,6 +321,22 @@ struct Block {
     }
   }
 
+  // fill data of a block which can either be empty or contain a dict. by the provided functor writing to the block memory
+  template <typename F, std::enable_if_t<std::is_invocable_v<F, W*>, bool> = true>
+  void storeData(int _ndata, F&& fill)
+  {
+    if (getNStored() > getNDict()) {
+      throw std::runtime_error("trying to write in occupied block");
+    }
+    assert(registry); // this method is valid only for flat version, which has a registry
+    assert(estimateSize(_ndata) <= registry->getFreeSize());
+    setNData(_ndata);
+    if (nData) {
+      fill(getCreateData());
+      realignBlock();
+    }
+  }
+
   // store a dictionary to a block which can either be empty or contain a dict.
   void storeLiterals(int _nliterals, const W* _literals)
   {
@@ -320,6 +400,51 @@ struct Block {
   ClassDefNV(Block, 1);
 }; // namespace ctf
 
+/// source of a single slot for EncodedBlocks::encodeParallel, the container must be contiguous
+template <typename VE>
+struct SlotInput {
+  const VE& src;
+  uint8_t symbolTablePrecision = 0;
+  Metadata::OptStore opt = Metadata::OptStore::EENCODE;
+  const void* encoderExt = nullptr; // optional external encoder
+  uint8_t nStreams = rans::internal::DefaultNStreams;
+  uint32_t dictID = 0;                             // ID of the dictionary of the external encoder, if it is shared between CTFs
+  const o2::rans::FrequencyTable* dict = nullptr; // dictionary of the external encoder to store in the block, if any
+};
+
+template <typename VE>
+inline SlotInput<VE> makeSlotInput(const VE& src, uint8_t symbolTablePrecision, Metadata::OptStore opt, const void* encoderExt = nullptr, uint8_t nStreams = rans::internal::DefaultNStreams)
+{
+  return SlotInput<VE>{src, symbolTablePrecision, opt, encoderExt, nStreams};
+}
+
+/// destination of a single slot for EncodedBlocks::decodeParallel (will be resized as needed)
+template <typename VD>
+struct SlotOutput {
+  VD& dest;
+  const void* decoderExt = nullptr; // optional external decoder
+};
+
+template <typename VD>
+inline SlotOutput<VD> makeSlotOutput(VD& dest, const void* decoderExt = nullptr)
+{
+  return SlotOutput<VD>{dest, decoderExt};
+}
+
+/// block content prepared outside of the flat buffer, used to encode the slots independently of each other
+template <typename W>
+struct SlotEncoding {
+  Metadata metadata;
+  std::vector<W> dict;                  // dictionary words
+  std::vector<W> data;                  // entropy encoded data words
+  std::vector<W> literals;              // literal words (padded)
+  const void* rawData = nullptr;        // data stored w/o entropy encoding are copied from the source directly to the flat buffer
+  size_t rawDataSize = 0;               // in bytes!!!
+  int nRawDataWords = 0;                // number of W words occupied by the raw data
+
+  int getNWords() const { return rawData ? nRawDataWords : int(dict.size() + data.size() + literals.size()); }
+};
+
 ///<<======================== Auxiliary classes =======================<<
 
 template <typename H, int N, typename W = uint32_t>
@@ -413,14 +538,14 @@ class EncodedBlocks
 
   /// encode vector src to bloc at provided slot
   template <typename VE, typename buffer_T>
-  inline void encode(const VE& src, int slot, uint8_t symbolTablePrecision, Metadata::OptStore opt, buffer_T* buffer = nullptr, const void* encoderExt = nullptr)
+  inline void encode(const VE& src, int slot, uint8_t symbolTablePrecision, Metadata::OptStore opt, buffer_T* buffer = nullptr, const void* encoderExt = nullptr, uint8_t nStreams = rans::internal::DefaultNStreams)
   {
-    encode(std::begin(src), std::end(src), slot, symbolTablePrecision, opt, buffer, encoderExt);
+    encode(std::begin(src), std::end(src), slot, symbolTablePrecision, opt, buffer, encoderExt, nStreams);
   }
 
-  /// encode vector src to bloc at provided slot
+  /// encode vector src to bloc at provided slot, using nStreams (2, 4, 8 or 16) interleaved rANS states
   template <typename input_IT, typename buffer_T>
-  void encode(const input_IT srcBegin, const input_IT srcEnd, int slot, uint8_t symbolTablePrecision, Metadata::OptStore opt, buffer_T* buffer = nullptr, const void* encoderExt = nullptr);
+  void encode(const input_IT srcBegin, const input_IT srcEnd, int slot, uint8_t symbolTablePrecision, Metadata::OptStore opt, buffer_T* buffer = nullptr, const void* encoderExt = nullptr, uint8_t nStreams = rans::internal::DefaultNStreams);
 
   /// decode block at provided slot to destination vector (will be resized as needed)
   template <class container_T, class container_IT = typename container_T::iterator>
@@ -430,6 +555,19 @@ class EncodedBlocks
   template <typename D_IT, std::enable_if_t<detail::is_iterator_v<D_IT>, bool> = true>
   void decode(D_IT dest, int slot, const void* decoderExt = nullptr) const;
 
+  /// encode all N slots at once, one input per slot in the slot order. The slots are encoded concurrently on up to
+  /// nThreads threads, the buffer (already holding the created container) is expanded only once to the final size
+  template <typename buffer_T, typename... VE>
+  static void encodeParallel(buffer_T& buffer, int nThreads, const SlotInput<VE>&... inputs);
+
+  /// decode all N slots at once, one output per slot in the slot order, using up to nThreads threads
+  template <typename... VD>
+  void decodeParallel(int nThreads, const SlotOutput<VD>&... outputs) const;
+
+  /// encode a single message to a SlotEncoding, w/o touching the flat buffer (can be called concurrently for different slots)
+  template <typename VE>
+  static void encodeToSlotEncoding(const SlotInput<VE>& input, SlotEncoding<W>& enc);
+
   /// create a special EncodedBlocks containing only dictionaries made from provided vector of frequency tables
   static std::vector<char> createDictionaryBlocks(const std::vector<o2::rans::FrequencyTable>& vfreq, const std::vector<Metadata>& prbits);
 
@@ -741,7 +879,7 @@ void EncodedBlocks<H, N, W>::decode(D_IT dest,                    // iterator to
       }
       const o2::rans::LiteralDecoder64<dest_t>* decoder = reinterpret_cast<const o2::rans::LiteralDecoder64<dest_t>*>(decoderExt);
       std::unique_ptr<o2::rans::LiteralDecoder64<dest_t>> decoderLoc;
-      if (block.getNDict()) { // if dictionaty is saved, prefer it
+      if (block.getNDict() && !(decoderExt && md.dictID)) { // if dictionaty is saved, prefer it, unless the external decoder was built from the same shared dictionary
         o2::rans::FrequencyTable frequencies;
         frequencies.addFrequencies(block.getDict(), block.getDict() + block.getNDict(), md.min, md.max);
         decoderLoc = std::make_unique<o2::rans::LiteralDecoder64<dest_t>>(frequencies, md.probabilityBits);
@@ -761,11 +899,13 @@ void EncodedBlocks<H, N, W>::decode(D_IT dest,                    // iterator to
         // to D-word array
         literals = std::vector<dest_t>{reinterpret_cast<const dest_t*>(block.getLiterals()), reinterpret_cast<const dest_t*>(block.getLiterals()) + md.nLiterals};
       }
-      decoder->process(block.getData() + block.getNData(), dest, md.messageLength, literals);
+      detail::dispatchNStreams(md.nStreams, [&](auto nStreams) {
+        decoder->template process<decltype(nStreams)::value>(block.getData() + block.getNData(), dest, md.messageLength, literals);
+      });
     } else { // data was stored as is
       using destPtr_t = typename std::iterator_traits<D_IT>::pointer;
       destPtr_t srcBegin = reinterpret_cast<destPtr_t>(block.payload);
-      destPtr_t srcEnd = srcBegin + md.messageLength * sizeof(dest_t);
+      destPtr_t srcEnd = srcBegin + md.messageLength;
       std::copy(srcBegin, srcEnd, dest);
       //std::memcpy(dest, block.payload, md.messageLength * sizeof(dest_t));
     }
@@ -781,7 +921,8 @@ void EncodedBlocks<H, N, W>::encode(const input_IT srcBegin,      // iterator be
                                     uint8_t symbolTablePrecision, // encoding into
                                     Metadata::OptStore opt,       // option for data compression
                                     buffer_T* buffer,             // optional buffer (vector) providing memory for encoded blocks
-                                    const void* encoderExt)       // optional external encoder
+                                    const void* encoderExt,       // optional external encoder
+                                    uint8_t nStreams)             // number of interleaved rANS states
 {
 
   using storageBuffer_t = W;
@@ -832,9 +973,6 @@ void EncodedBlocks<H, N, W>::encode(const input_IT srcBegin,      // iterator be
   // case 3: message where entropy coding should be applied
   if (opt == Metadata::OptStore::EENCODE) {
     // build symbol statistics
-    constexpr size_t SizeEstMarginAbs = 10 * 1024;
-    constexpr float SizeEstMarginRel = 1.05;
-
     const auto [inplaceEncoder, frequencyTable] = [&]() {
       if (encoderExt) {
         return std::make_tuple(ransEncoder_t{}, rans::FrequencyTable{});
@@ -860,7 +998,9 @@ void EncodedBlocks<H, N, W>::encode(const input_IT srcBegin,      // iterator be
     // directly encode source message into block buffer.
     storageBuffer_t* const blockBufferBegin = thisBlock->getCreateData();
     const size_t maxBufferSize = thisBlock->registry->getFreeSize(); // note: "this" might be not valid after expandStorage call!!!
-    const auto encodedMessageEnd = encoder->process(srcBegin, srcEnd, blockBufferBegin, literals);
+    const auto encodedMessageEnd = detail::dispatchNStreams(nStreams, [&](auto nStreamsC) {
+      return encoder->template process<decltype(nStreamsC)::value>(srcBegin, srcEnd, blockBufferBegin, literals);
+    });
     rans::utils::checkBounds(encodedMessageEnd, blockBufferBegin + maxBufferSize);
     dataSize = encodedMessageEnd - thisBlock->getData();
     thisBlock->setNData(dataSize);
@@ -868,19 +1008,17 @@ void EncodedBlocks<H, N, W>::encode(const input_IT srcBegin,      // iterator be
     // update the size claimed by encode message directly inside the block
 
     // store incompressible symbols if any
-    const size_t nLiteralSymbols = [&]() {
-      const size_t nSymbols = literals.size();
-      if (!literals.empty()) {
-        // introduce padding in case literals don't align;
-        const size_t nLiteralSymbolsPadded = calculatePaddedSize<input_t, storageBuffer_t>(nSymbols);
-        literals.resize(nLiteralSymbolsPadded, {});
-
-        const size_t nLiteralStorageElems = calculateNDestTElements<input_t, storageBuffer_t>(nSymbols);
-        expandStorage(nLiteralStorageElems);
-        thisBlock->storeLiterals(nLiteralStorageElems, reinterpret_cast<const storageBuffer_t*>(literals.data()));
-      }
-      return nSymbols;
-    }();
+    const size_t nLiteralSymbols = literals.size();
+    size_t nLiteralStorageElems = 0;
+    if (!literals.empty()) {
+      // introduce padding in case literals don't align;
+      const size_t nLiteralSymbolsPadded = calculatePaddedSize<input_t, storageBuffer_t>(nLiteralSymbols);
+      literals.resize(nLiteralSymbolsPadded, {});
+
+      nLiteralStorageElems = calculateNDestTElements<input_t, storageBuffer_t>(nLiteralSymbols);
+      expandStorage(nLiteralStorageElems);
+      thisBlock->storeLiterals(nLiteralStorageElems, reinterpret_cast<const storageBuffer_t*>(literals.data()));
+    }
 
     *thisMetadata = Metadata{messageLength,
                              nLiteralSymbols,
@@ -892,24 +1030,152 @@ void EncodedBlocks<H, N, W>::encode(const input_IT srcBegin,      // iterator be
                              encoder->getMaxSymbol(),
                              static_cast<int32_t>(frequencyTable.size()),
                              dataSize,
-                             static_cast<int32_t>(literals.size())};
-  } else { // store original data w/o EEncoding
-    //FIXME(milettri): we should be able to do without an intermediate vector;
-    // provided iterator is not necessarily pointer, need to use intermediate vector!!!
-
-    // introduce padding in case literals don't align;
-    const size_t nSourceElemsPadded = calculatePaddedSize<input_t, storageBuffer_t>(messageLength);
-    std::vector<input_t> tmp(nSourceElemsPadded, {});
-    std::copy(srcBegin, srcEnd, std::begin(tmp));
-
+                             static_cast<int32_t>(nLiteralStorageElems),
+                             nStreams};
+  } else { // store original data w/o EEncoding, copying it directly to the block
     const size_t nBufferElems = calculateNDestTElements<input_t, storageBuffer_t>(messageLength);
     expandStorage(nBufferElems);
-    thisBlock->storeData(thisMetadata->nDataWords, reinterpret_cast<const storageBuffer_t*>(tmp.data()));
+    thisBlock->storeData(nBufferElems, [&](storageBuffer_t* dest) {
+      // zero the last word first, since the message might not fill it completely
+      dest[nBufferElems - 1] = 0;
+      std::copy(srcBegin, srcEnd, reinterpret_cast<input_t*>(dest));
+    });
 
     *thisMetadata = Metadata{messageLength, 0, sizeof(ransState_t), sizeof(storageBuffer_t), symbolTablePrecision, opt, 0, 0, 0, static_cast<int>(nBufferElems), 0};
   }
 }
 
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+template <typename VE>
+void EncodedBlocks<H, N, W>::encodeToSlotEncoding(const SlotInput<VE>& input, SlotEncoding<W>& enc)
+{
+  using storageBuffer_t = W;
+  using input_t = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(input.src))>>;
+  using ransEncoder_t = typename rans::LiteralEncoder64<input_t>;
+  using ransState_t = typename ransEncoder_t::coder_t;
+  using ransStream_t = typename ransEncoder_t::stream_t;
+  static_assert(std::is_same_v<storageBuffer_t, ransStream_t>);
+
+  const auto srcBegin = std::data(input.src);
+  const auto srcEnd = srcBegin + std::size(input.src);
+  const size_t messageLength = std::size(input.src);
+
+  if (messageLength == 0) {
+    enc.metadata = Metadata{0, 0, sizeof(ransState_t), sizeof(ransStream_t), input.symbolTablePrecision, Metadata::OptStore::NODATA, 0, 0, 0, 0, 0};
+    return;
+  }
+
+  if (input.opt != Metadata::OptStore::EENCODE) { // will be copied directly from the source
+    enc.rawData = srcBegin;
+    enc.rawDataSize = messageLength * sizeof(input_t);
+    enc.nRawDataWords = calculateNDestTElements<input_t, storageBuffer_t>(messageLength);
+    enc.metadata = Metadata{messageLength, 0, sizeof(ransState_t), sizeof(storageBuffer_t), input.symbolTablePrecision, input.opt, 0, 0, 0, enc.nRawDataWords, 0};
+    return;
+  }
+
+  rans::FrequencyTable frequencyTable{};
+  std::unique_ptr<ransEncoder_t> encoderLoc;
+  const ransEncoder_t* encoder = reinterpret_cast<const ransEncoder_t*>(input.encoderExt);
+  if (!encoder) {
+    frequencyTable.addSamples(srcBegin, srcEnd);
+    encoderLoc = std::make_unique<ransEncoder_t>(frequencyTable, input.symbolTablePrecision);
+    encoder = encoderLoc.get();
+    enc.dict.assign(frequencyTable.data(), frequencyTable.data() + frequencyTable.size());
+  } else if (input.dict) { // dictionary of the external encoder is stored, e.g. for adaptive dictionaries
+    enc.dict.assign(input.dict->data(), input.dict->data() + input.dict->size());
+  }
+
+  // estimate size of encode buffer, in words
+  const size_t dataSize = rans::calculateMaxBufferSize(messageLength, encoder->getAlphabetRangeBits(), sizeof(input_t)) / sizeof(storageBuffer_t);
+  enc.data.resize(SizeEstMarginAbs + size_t(SizeEstMarginRel * dataSize) + (sizeof(input_t) < sizeof(storageBuffer_t)));
+  std::vector<input_t> literals;
+  const auto encodedMessageEnd = detail::dispatchNStreams(input.nStreams, [&](auto nStreamsC) {
+    return encoder->template process<decltype(nStreamsC)::value>(srcBegin, srcEnd, enc.data.data(), literals);
+  });
+  rans::utils::checkBounds(encodedMessageEnd, enc.data.data() + enc.data.size());
+  enc.data.resize(encodedMessageEnd - enc.data.data());
+
+  const size_t nLiteralSymbols = literals.size();
+  if (nLiteralSymbols) {
+    literals.resize(calculatePaddedSize<input_t, storageBuffer_t>(nLiteralSymbols), {});
+    const size_t nLiteralStorageElems = calculateNDestTElements<input_t, storageBuffer_t>(nLiteralSymbols);
+    const auto* literalsBegin = reinterpret_cast<const storageBuffer_t*>(literals.data());
+    enc.literals.assign(literalsBegin, literalsBegin + nLiteralStorageElems);
+  }
+
+  enc.metadata = Metadata{messageLength,
+                          nLiteralSymbols,
+                          sizeof(ransState_t),
+                          sizeof(ransStream_t),
+                          static_cast<uint8_t>(encoder->getSymbolTablePrecision()),
+                          input.opt,
+                          encoder->getMinSymbol(),
+                          encoder->getMaxSymbol(),
+                          static_cast<int32_t>(enc.dict.size()),
+                          static_cast<int32_t>(enc.data.size()),
+                          static_cast<int32_t>(enc.literals.size()),
+                          input.nStreams,
+                          input.encoderExt ? input.dictID : 0};
+}
+
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+template <typename buffer_T, typename... VE>
+void EncodedBlocks<H, N, W>::encodeParallel(buffer_T& buffer, int nThreads, const SlotInput<VE>&... inputs)
+{
+  static_assert(sizeof...(VE) == N, "one input per block must be provided");
+  if (get(buffer.data())->mRegistry.nFilledBlocks) {
+    throw std::runtime_error("parallel encoding requires empty container");
+  }
+
+  // encode slots independently of the flat buffer
+  std::array<SlotEncoding<W>, N> encodings;
+  const auto inputsTuple = std::forward_as_tuple(inputs...);
+  detail::runParallel(N, nThreads, [&](int slot) {
+    detail::visitTupleElement(inputsTuple, slot, [&](const auto& input) { encodeToSlotEncoding(input, encodings[slot]); }, std::make_index_sequence<N>{});
+  });
+
+  // expand the buffer once to the final size and fill the slots consecutively
+  size_t sz = alignSize(sizeof(base));
+  for (const auto& enc : encodings) {
+    sz += estimateBlockSize(enc.getNWords());
+  }
+  auto ctf = get(buffer.data());
+  if (sz > ctf->size()) {
+    ctf = expand(buffer, sz);
+  }
+  for (int slot = 0; slot < N; slot++) {
+    const auto& enc = encodings[slot];
+    auto& block = ctf->mBlocks[slot];
+    ctf->mMetadata[slot] = enc.metadata;
+    if (enc.rawData) {
+      block.storeData(enc.nRawDataWords, [&enc](W* dest) {
+        dest[enc.nRawDataWords - 1] = 0;
+        memcpy(dest, enc.rawData, enc.rawDataSize);
+      });
+    } else if (enc.metadata.opt != Metadata::OptStore::NODATA) {
+      block.store(enc.dict.size(), enc.data.size(), enc.literals.size(),
+                  enc.dict.empty() ? nullptr : enc.dict.data(),
+                  enc.data.empty() ? nullptr : enc.data.data(),
+                  enc.literals.empty() ? nullptr : enc.literals.data());
+    }
+    ctf->mRegistry.nFilledBlocks++;
+  }
+}
+
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+template <typename... VD>
+void EncodedBlocks<H, N, W>::decodeParallel(int nThreads, const SlotOutput<VD>&... outputs) const
+{
+  static_assert(sizeof...(VD) == N, "one output per block must be provided");
+  const auto outputsTuple = std::forward_as_tuple(outputs...);
+  detail::runParallel(N, nThreads, [&](int slot) {
+    detail::visitTupleElement(outputsTuple, slot, [&](const auto& output) { decode(output.dest, slot, output.decoderExt); }, std::make_index_sequence<N>{});
+  });
+}
+
 /// create a special EncodedBlocks containing only dictionaries made from provided vector of frequency tables
 template <typename H, int N, typename W>
 std::vector<char> EncodedBlocks<H, N, W>::createDictionaryBlocks(const std::vector<o2::rans::FrequencyTable>& vfreq, const std::vector<Metadata>& vmd)
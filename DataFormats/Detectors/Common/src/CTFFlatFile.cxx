@@ -0,0 +1,176 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CTFFlatFile.cxx
+/// \brief Flat, memory-mappable CTF container
+
+#include "DetectorsCommonDataFormats/CTFFlatFile.h"
+#include <Framework/Logger.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace o2::ctf;
+using DetID = o2::detectors::DetID;
+
+///_____________________________________________________________________________
+void CTFFlatFileWriter::open(const std::string& fname)
+{
+  close();
+  mFile.open(fname, std::ios::binary | std::ios::trunc);
+  if (!mFile.is_open()) {
+    throw std::runtime_error(fmt::format("Failed to open flat CTF file {} for writing", fname));
+  }
+  mName = fname;
+  CTFFlatFileHeader header;
+  mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  mOffset = sizeof(header);
+  mCurrent = CTFFlatTFEntry{};
+  mIndex.clear();
+}
+
+///_____________________________________________________________________________
+size_t CTFFlatFileWriter::pad()
+{
+  static const std::array<char, CTFFlatFileHeader::PageSize> zeros{};
+  size_t npad = (CTFFlatFileHeader::PageSize - mOffset % CTFFlatFileHeader::PageSize) % CTFFlatFileHeader::PageSize;
+  mFile.write(zeros.data(), npad);
+  mOffset += npad;
+  return npad;
+}
+
+///_____________________________________________________________________________
+size_t CTFFlatFileWriter::addBlock(DetID det, const void* data, size_t size)
+{
+  if (!isOpen()) {
+    throw std::runtime_error("flat CTF file is not open");
+  }
+  size_t sz = pad();
+  auto& bl = mCurrent.blocks[det];
+  bl.offset = mOffset;
+  bl.size = size;
+  mFile.write(reinterpret_cast<const char*>(data), size);
+  if (!mFile.good()) {
+    throw std::runtime_error(fmt::format("Failed to write {} block of {} bytes to {}", det.getName(), size, mName));
+  }
+  mOffset += size;
+  mCurrent.detectors |= det.getMask().to_ulong();
+  return sz + size;
+}
+
+///_____________________________________________________________________________
+void CTFFlatFileWriter::finishTF(const CTFHeader& header)
+{
+  mCurrent.run = header.run;
+  mCurrent.firstTForbit = header.firstTForbit;
+  mCurrent.detectors = (header.detectors & DetID::mask_t(mCurrent.detectors)).to_ulong();
+  mIndex.push_back(mCurrent);
+  mCurrent = CTFFlatTFEntry{};
+}
+
+///_____________________________________________________________________________
+void CTFFlatFileWriter::close()
+{
+  if (!isOpen()) {
+    return;
+  }
+  pad();
+  CTFFlatFileTrailer trailer;
+  trailer.indexOffset = mOffset;
+  trailer.nTFs = mIndex.size();
+  mFile.write(reinterpret_cast<const char*>(mIndex.data()), mIndex.size() * sizeof(CTFFlatTFEntry));
+  mFile.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+  mOffset += mIndex.size() * sizeof(CTFFlatTFEntry) + sizeof(trailer);
+  mFile.close();
+  if (mFile.fail()) {
+    throw std::runtime_error(fmt::format("Failed to finalize flat CTF file {}", mName));
+  }
+  mIndex.clear();
+}
+
+///_____________________________________________________________________________
+bool CTFFlatFileReader::isFlatFile(const std::string& fname)
+{
+  std::ifstream inp(fname, std::ios::binary);
+  CTFFlatFileHeader header;
+  header.magic = 0;
+  inp.read(reinterpret_cast<char*>(&header), sizeof(header));
+  return inp.good() && header.magic == CTFFlatFileHeader::Magic;
+}
+
+///_____________________________________________________________________________
+void CTFFlatFileReader::open(const std::string& fname)
+{
+  close();
+  int fd = ::open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(fmt::format("Failed to open flat CTF file {}", fname));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CTFFlatFileHeader) + sizeof(CTFFlatFileTrailer)) {
+    ::close(fd);
+    throw std::runtime_error(fmt::format("Flat CTF file {} is truncated", fname));
+  }
+  size_t fsize = st.st_size;
+  void* addr = mmap(nullptr, fsize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // the mapping stays valid
+  if (addr == MAP_FAILED) {
+    throw std::runtime_error(fmt::format("Failed to map flat CTF file {}", fname));
+  }
+  mMapping = std::shared_ptr<const char>(reinterpret_cast<const char*>(addr), [fsize](const char* p) { munmap(const_cast<char*>(p), fsize); });
+  mFileSize = fsize;
+  mName = fname;
+
+  const auto& header = *reinterpret_cast<const CTFFlatFileHeader*>(mMapping.get());
+  const auto& trailer = *reinterpret_cast<const CTFFlatFileTrailer*>(mMapping.get() + fsize - sizeof(CTFFlatFileTrailer));
+  if (header.magic != CTFFlatFileHeader::Magic || trailer.magic != CTFFlatFileHeader::Magic) {
+    close();
+    throw std::runtime_error(fmt::format("{} is not a flat CTF file or was not closed", fname));
+  }
+  if (header.version != CTFFlatFileHeader::Version || header.pageSize != CTFFlatFileHeader::PageSize) {
+    close();
+    throw std::runtime_error(fmt::format("Flat CTF file {} has unsupported version {} / page size {}", fname, header.version, header.pageSize));
+  }
+  if (trailer.indexOffset + trailer.nTFs * sizeof(CTFFlatTFEntry) + sizeof(CTFFlatFileTrailer) != fsize) {
+    close();
+    throw std::runtime_error(fmt::format("Corrupted index in flat CTF file {}", fname));
+  }
+  mNTFs = trailer.nTFs;
+  mIndex = reinterpret_cast<const CTFFlatTFEntry*>(mMapping.get() + trailer.indexOffset);
+  for (size_t i = 0; i < mNTFs; i++) {
+    for (const auto& bl : mIndex[i].blocks) {
+      if (bl.size && (bl.offset % CTFFlatFileHeader::PageSize || bl.offset + bl.size > trailer.indexOffset)) {
+        close();
+        throw std::runtime_error(fmt::format("Corrupted block entry of TF {} in flat CTF file {}", i, fname));
+      }
+    }
+  }
+  madvise(const_cast<char*>(mMapping.get()), fsize, MADV_SEQUENTIAL);
+}
+
+///_____________________________________________________________________________
+void CTFFlatFileReader::close()
+{
+  mMapping.reset();
+  mIndex = nullptr;
+  mNTFs = 0;
+  mFileSize = 0;
+}
+
+///_____________________________________________________________________________
+const char* CTFFlatFileReader::getBlock(size_t tf, DetID det, size_t& size) const
+{
+  const auto& bl = mIndex[tf].blocks[det];
+  size = bl.size;
+  return bl.size ? mMapping.get() + bl.offset : nullptr;
+}
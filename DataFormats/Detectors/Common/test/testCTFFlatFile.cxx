@@ -0,0 +1,63 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test CTFFlatFile
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#include "DetectorsCommonDataFormats/CTFFlatFile.h"
+
+using namespace o2::ctf;
+using DetID = o2::detectors::DetID;
+
+BOOST_AUTO_TEST_CASE(CTFFlatFile_test)
+{
+  const std::string fname = "test_ctf_flat.ctf";
+  std::vector<char> itsData(10000), tofData(123);
+  std::iota(itsData.begin(), itsData.end(), 0);
+  std::iota(tofData.begin(), tofData.end(), 7);
+  {
+    CTFFlatFileWriter writer;
+    writer.open(fname);
+    writer.addBlock(DetID::ITS, itsData.data(), itsData.size());
+    writer.addBlock(DetID::TOF, tofData.data(), tofData.size());
+    writer.finishTF(CTFHeader{123, 256, DetID::getMask(DetID::ITS) | DetID::getMask(DetID::TOF)});
+    writer.addBlock(DetID::TOF, tofData.data(), tofData.size());
+    writer.finishTF(CTFHeader{123, 512, DetID::getMask(DetID::TOF)});
+    writer.close();
+  }
+  BOOST_CHECK(CTFFlatFileReader::isFlatFile(fname));
+
+  CTFFlatFileReader reader;
+  reader.open(fname);
+  BOOST_CHECK(reader.getNTFs() == 2);
+  BOOST_CHECK(reader.getCTFHeader(1).firstTForbit == 512);
+  BOOST_CHECK(reader.getCTFHeader(0).detectors[DetID::ITS] && !reader.getCTFHeader(1).detectors[DetID::ITS]);
+
+  size_t sz = 0;
+  const char* img = reader.getBlock(0, DetID::ITS, sz);
+  BOOST_REQUIRE(img != nullptr && sz == itsData.size());
+  BOOST_CHECK(reinterpret_cast<uintptr_t>(img) % CTFFlatFileHeader::PageSize == 0);
+  BOOST_CHECK(std::memcmp(img, itsData.data(), sz) == 0);
+  img = reader.getBlock(1, DetID::TOF, sz);
+  BOOST_REQUIRE(img != nullptr && sz == tofData.size());
+  BOOST_CHECK(std::memcmp(img, tofData.data(), sz) == 0);
+  BOOST_CHECK(reader.getBlock(1, DetID::ITS, sz) == nullptr && sz == 0);
+
+  // the mapping outlives the reader if it is owned by someone else
+  auto mapping = reader.getMapping();
+  img = reader.getBlock(1, DetID::TOF, sz);
+  reader.close();
+  BOOST_CHECK(std::memcmp(img, tofData.data(), sz) == 0);
+}
@@ -0,0 +1,149 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test EncodedBlocks
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+#include "DetectorsCommonDataFormats/EncodedBlocks.h"
+
+using namespace o2::ctf;
+using TestBlocks = EncodedBlocks<CTFDictHeader, 4, uint32_t>;
+
+namespace
+{
+struct TestData {
+  std::vector<uint16_t> adc;   // entropy encoded
+  std::vector<int16_t> time;   // entropy encoded with the external coder, with literals
+  std::vector<uint16_t> flags; // stored as is
+  std::vector<uint32_t> empty; // no data
+  std::unique_ptr<o2::rans::LiteralEncoder64<int16_t>> timeEncoder;
+  std::unique_ptr<o2::rans::LiteralDecoder64<int16_t>> timeDecoder;
+  TestData()
+  {
+    std::mt19937 gen(12345);
+    std::poisson_distribution<int> adcDist(20);
+    std::normal_distribution<double> timeDist(0., 50.);
+    for (int i = 0; i < 10000; i++) {
+      adc.push_back(adcDist(gen));
+      time.push_back(int16_t(timeDist(gen)));
+      flags.push_back(uint16_t(i * 7));
+    }
+    flags.resize(flags.size() - 3); // not a multiple of the word size
+    // the external coder is trained on the core of the distribution only, the tails go to literals
+    std::vector<int16_t> timeCore;
+    std::copy_if(time.begin(), time.end(), std::back_inserter(timeCore), [](auto t) { return std::abs(t) < 50; });
+    o2::rans::FrequencyTable freq;
+    freq.addSamples(timeCore.begin(), timeCore.end());
+    timeEncoder = std::make_unique<o2::rans::LiteralEncoder64<int16_t>>(freq, 16);
+    timeDecoder = std::make_unique<o2::rans::LiteralDecoder64<int16_t>>(freq, 16);
+  }
+};
+
+const std::vector<Metadata::OptStore> Opts{Metadata::OptStore::EENCODE, Metadata::OptStore::EENCODE, Metadata::OptStore::NONE, Metadata::OptStore::EENCODE};
+
+void encodeSequential(const TestData& d, std::vector<char>& buff)
+{
+  TestBlocks::create(buff);
+  TestBlocks::get(buff.data())->encode(d.adc, 0, 16, Opts[0], &buff);
+  TestBlocks::get(buff.data())->encode(d.time, 1, 16, Opts[1], &buff, d.timeEncoder.get());
+  TestBlocks::get(buff.data())->encode(d.flags, 2, 16, Opts[2], &buff);
+  TestBlocks::get(buff.data())->encode(d.empty, 3, 16, Opts[3], &buff);
+}
+
+void encodeParallel(const TestData& d, std::vector<char>& buff, int nThreads)
+{
+  TestBlocks::create(buff);
+  TestBlocks::encodeParallel(buff, nThreads,
+                             makeSlotInput(d.adc, 16, Opts[0]),
+                             makeSlotInput(d.time, 16, Opts[1], d.timeEncoder.get()),
+                             makeSlotInput(d.flags, 16, Opts[2]),
+                             makeSlotInput(d.empty, 16, Opts[3]));
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(EncodedBlocks_raw_slot)
+{
+  TestData d;
+  std::vector<char> buff;
+  encodeSequential(d, buff);
+  const auto* ctf = TestBlocks::get(buff.data());
+  BOOST_CHECK(ctf->getMetadata(2).opt == Metadata::OptStore::NONE);
+  BOOST_CHECK(ctf->getMetadata(2).messageLength == d.flags.size());
+  BOOST_CHECK(ctf->getBlock(2).getNData() == int((d.flags.size() * sizeof(uint16_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t)));
+
+  std::vector<uint16_t> flags;
+  ctf->decode(flags, 2);
+  BOOST_CHECK(flags == d.flags);
+
+  // the decoding must not touch memory beyond the message
+  std::vector<uint16_t> flagsGuarded(2 * d.flags.size(), 0xabab);
+  ctf->decode(flagsGuarded.begin(), 2);
+  BOOST_CHECK(std::equal(d.flags.begin(), d.flags.end(), flagsGuarded.begin()));
+  BOOST_CHECK(std::all_of(flagsGuarded.begin() + d.flags.size(), flagsGuarded.end(), [](auto v) { return v == 0xabab; }));
+}
+
+BOOST_AUTO_TEST_CASE(EncodedBlocks_parallel_vs_sequential)
+{
+  TestData d;
+  std::vector<char> buffSeq, buffPar;
+  encodeSequential(d, buffSeq);
+  encodeParallel(d, buffPar, 4);
+  const auto* ctfSeq = TestBlocks::get(buffSeq.data());
+  const auto* ctfPar = TestBlocks::get(buffPar.data());
+  BOOST_REQUIRE(ctfSeq->getMetadata(1).nLiterals > 0);
+
+  for (int i = 0; i < TestBlocks::getNBlocks(); i++) {
+    const auto &mdS = ctfSeq->getMetadata(i), &mdP = ctfPar->getMetadata(i);
+    BOOST_CHECK(mdS.messageLength == mdP.messageLength);
+    BOOST_CHECK(mdS.nLiterals == mdP.nLiterals);
+    BOOST_CHECK(mdS.opt == mdP.opt);
+    BOOST_CHECK(mdS.min == mdP.min && mdS.max == mdP.max);
+    BOOST_CHECK(mdS.probabilityBits == mdP.probabilityBits);
+    BOOST_CHECK(mdS.nDictWords == mdP.nDictWords);
+    BOOST_CHECK(mdS.nDataWords == mdP.nDataWords);
+    BOOST_CHECK(mdS.nLiteralWords == mdP.nLiteralWords);
+    BOOST_CHECK(mdS.nStreams == mdP.nStreams);
+    // the literals word count must agree with the stored block
+    BOOST_CHECK(mdS.nLiteralWords == ctfSeq->getBlock(i).getNLiterals());
+
+    const auto &blS = ctfSeq->getBlock(i), &blP = ctfPar->getBlock(i);
+    BOOST_CHECK(blS.getNDict() == blP.getNDict());
+    BOOST_CHECK(blS.getNData() == blP.getNData());
+    BOOST_CHECK(blS.getNLiterals() == blP.getNLiterals());
+    BOOST_REQUIRE(blS.getNStored() == blP.getNStored());
+    // same layout of the flat buffers and same content of the payloads
+    if (blS.getNStored()) {
+      BOOST_CHECK(reinterpret_cast<const char*>(blS.payload) - buffSeq.data() == reinterpret_cast<const char*>(blP.payload) - buffPar.data());
+      BOOST_CHECK(std::memcmp(blS.payload, blP.payload, blS.getNStored() * sizeof(uint32_t)) == 0);
+    }
+  }
+  BOOST_CHECK(ctfSeq->size() - ctfSeq->getFreeSize() == ctfPar->size() - ctfPar->getFreeSize());
+
+  // parallel decoding of either container gives the source data back
+  for (const auto* ctf : {ctfSeq, ctfPar}) {
+    std::vector<uint16_t> adc;
+    std::vector<int16_t> time;
+    std::vector<uint16_t> flags;
+    std::vector<uint32_t> empty{1, 2, 3};
+    ctf->decodeParallel(4, makeSlotOutput(adc), makeSlotOutput(time, d.timeDecoder.get()), makeSlotOutput(flags), makeSlotOutput(empty));
+    BOOST_CHECK(adc == d.adc);
+    BOOST_CHECK(time == d.time);
+    BOOST_CHECK(flags == d.flags);
+    BOOST_CHECK(empty.empty());
+  }
+}
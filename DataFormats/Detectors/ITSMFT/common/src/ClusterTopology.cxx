@@ -93,7 +93,8 @@ unsigned int ClusterTopology::hashFunction(const void* key, int len)
 unsigned long ClusterTopology::getCompleteHash(int nRow, int nCol,
                                                const unsigned char patt[ClusterPattern::MaxPatternBytes])
 {
-  unsigned char extended_pattern[ClusterPattern::kExtendedPatternBytes] = {0};
+  // only the first nBytes + 2 bytes are used, no need to clear the whole buffer
+  unsigned char extended_pattern[ClusterPattern::kExtendedPatternBytes];
   extended_pattern[0] = (unsigned char)nRow;
   extended_pattern[1] = (unsigned char)nCol;
   int nBits = nRow * nCol;
@@ -16,12 +16,14 @@
 #ifndef _ALICEO2_CTFCODER_BASE_H_
 #define _ALICEO2_CTFCODER_BASE_H_
 
+#include <algorithm>
 #include <memory>
 #include <TFile.h>
 #include <TTree.h>
 #include "DetectorsCommonDataFormats/DetID.h"
 #include "DetectorsCommonDataFormats/NameConf.h"
 #include "DetectorsCommonDataFormats/CTFDictHeader.h"
+#include "DetectorsCommonDataFormats/EncodedBlocks.h"
 #include "rANS/rans.h"
 
 namespace o2
@@ -42,7 +44,7 @@ class CTFCoderBase
                             Decoder };
 
   CTFCoderBase() = delete;
-  CTFCoderBase(int n, DetID det) : mCoders(n), mDet(det) {}
+  CTFCoderBase(int n, DetID det) : mCoders(n), mDet(det), mAdaptiveSlots(n) {}
 
   std::unique_ptr<TFile> loadDictionaryTreeFile(const std::string& dictPath, bool mayFail = false);
 
@@ -86,6 +88,30 @@ class CTFCoderBase
     }
   }
 
+  /// number of threads to use for the parallel encoding/decoding of the blocks
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
+  /// Adaptive dictionaries: the symbol statistics of every slot are accumulated over TFs and the encoder is rebuilt only
+  /// when the estimated relative loss of compression with the current dictionary exceeds maxLoss. The statistics are
+  /// checked every checkPeriod TFs, in between the current encoder is used w/o histogramming the data.
+  /// The dictionary is stored in every CTF encoded with it, so that each CTF can be decoded on its own, in any order and
+  /// by any pipeline lane. The CTFs also carry its ID: the decoder reuses the decoder built for the previous CTF as long
+  /// as the dictionary does not change.
+  void setAdaptiveDictionaries(bool v, float maxLoss = 0.02f, int checkPeriod = 1);
+  bool getAdaptiveDictionaries() const { return mAdaptive; }
+
+  /// provide the input for the slot to be used with EncodedBlocks::encodeParallel, using the adaptive dictionary if requested
+  template <typename VE>
+  o2::ctf::SlotInput<VE> getSlotInput(const VE& src, int slot, uint8_t probabilityBits, Metadata::OptStore opt);
+
+  /// provide the output for the slot to be used with EncodedBlocks::decodeParallel, resolving the adaptive dictionary if needed
+  template <typename VD, typename CTF>
+  o2::ctf::SlotOutput<VD> getSlotOutput(VD& dest, const CTF& ec, int slot);
+
+  /// estimate relative increase of the encoded size of the sample when it is encoded using the reference statistics
+  static double estimateCompressionLoss(const o2::rans::FrequencyTable& reference, const o2::rans::FrequencyTable& sample);
+
  protected:
   std::string getPrefix() const { return o2::utils::Str::concat_string(mDet.getName(), "_CTF: "); }
   void assignDictVersion(CTFDictHeader& h) const
@@ -99,10 +125,91 @@ class CTFCoderBase
   std::vector<std::shared_ptr<void>> mCoders; // encoders/decoders
   DetID mDet;
   CTFDictHeader mExtHeader; // external dictionary header
+  int mNThreads = 1;        //! number of threads for parallel encoding/decoding of the blocks
+
+  struct AdaptiveSlot {
+    std::shared_ptr<void> coder;       // encoder/decoder built from the current dictionary
+    o2::rans::FrequencyTable dict;     // current dictionary
+    o2::rans::FrequencyTable stats;    // statistics accumulated since the current dictionary was built
+    uint32_t dictID = 0;               // ID of the current dictionary, 0 if none
+    int nTFs = 0;                      // number of TFs since the last statistics check
+    std::vector<uint32_t> decodedDict; // stored dictionary the decoder was built from
+    int32_t decodedMin = 0;            // min symbol of the stored dictionary the decoder was built from
+    uint8_t decodedBits = 0;           // probability bits of the decoder
+  };
+  bool mAdaptive = false;                   //! use adaptive dictionaries
+  float mAdaptiveMaxLoss = 0.02f;           //! max relative compression loss before the dictionary is rebuilt
+  int mAdaptiveCheckPeriod = 1;             //! check the statistics every this number of TFs
+  uint32_t mLastDictID = 0;                 //! last assigned adaptive dictionary ID
+  std::vector<AdaptiveSlot> mAdaptiveSlots; //! per slot adaptive dictionaries
 
   ClassDefNV(CTFCoderBase, 1);
 };
 
+///________________________________
+template <typename VE>
+o2::ctf::SlotInput<VE> CTFCoderBase::getSlotInput(const VE& src, int slot, uint8_t probabilityBits, Metadata::OptStore opt)
+{
+  auto input = o2::ctf::makeSlotInput(src, probabilityBits, opt, mCoders[slot].get());
+  if (!mAdaptive || opt != Metadata::OptStore::EENCODE || mCoders[slot] || !std::size(src)) { // external dictionary has priority
+    return input;
+  }
+  using S = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(src))>>;
+  auto& as = mAdaptiveSlots[slot];
+  if (!as.coder || ++as.nTFs >= mAdaptiveCheckPeriod) {
+    constexpr size_t MaxAccumulatedSamples = 1ul << 30; // protect the 32 bit counters
+    as.nTFs = 0;
+    o2::rans::FrequencyTable sample;
+    sample.addSamples(std::data(src), std::data(src) + std::size(src));
+    if (as.stats.getNumSamples() + sample.getNumSamples() > MaxAccumulatedSamples) {
+      as.stats = o2::rans::FrequencyTable{};
+    }
+    as.stats.addFrequencies(sample.cbegin(), sample.cend(), sample.getMinSymbol(), sample.getMaxSymbol());
+    double loss = as.coder ? estimateCompressionLoss(as.dict, sample) : 0.;
+    if (!as.coder || loss > mAdaptiveMaxLoss) {
+      LOGP(DEBUG, "{}rebuilding adaptive dictionary for slot {}, estimated compression loss {}", getPrefix(), slot, loss);
+      as.dict = std::move(as.stats);
+      as.stats = o2::rans::FrequencyTable{};
+      as.coder = std::make_shared<o2::rans::LiteralEncoder64<S>>(as.dict, probabilityBits);
+      as.dictID = ++mLastDictID;
+    }
+  }
+  input.encoderExt = as.coder.get();
+  input.dictID = as.dictID;
+  input.dict = &as.dict; // stored in every CTF, which can then be decoded independently of the others
+  return input;
+}
+
+///________________________________
+template <typename VD, typename CTF>
+o2::ctf::SlotOutput<VD> CTFCoderBase::getSlotOutput(VD& dest, const CTF& ec, int slot)
+{
+  const auto& md = ec.getMetadata(slot);
+  if (!md.dictID || md.opt != Metadata::OptStore::EENCODE) {
+    return o2::ctf::makeSlotOutput(dest, mCoders[slot].get());
+  }
+  using S = typename VD::value_type;
+  auto& as = mAdaptiveSlots[slot];
+  const auto& block = ec.getBlock(slot);
+  if (!block.getNDict()) {
+    LOGP(ERROR, "{}adaptive dictionary {} for slot {} is not stored in the CTF", getPrefix(), md.dictID, slot);
+    throw std::runtime_error("adaptive dictionary is not stored in the CTF");
+  }
+  // the decoder is rebuilt only when the dictionary changes; the ID alone does not identify it, since the CTFs of
+  // different encoders may use the same IDs
+  if (!as.coder || as.dictID != md.dictID || as.decodedMin != md.min || as.decodedBits != md.probabilityBits ||
+      !std::equal(as.decodedDict.begin(), as.decodedDict.end(), block.getDict(), block.getDict() + block.getNDict())) {
+    o2::rans::FrequencyTable dict;
+    dict.addFrequencies(block.getDict(), block.getDict() + block.getNDict(), md.min, md.max);
+    as.coder = std::make_shared<o2::rans::LiteralDecoder64<S>>(dict, md.probabilityBits);
+    as.dictID = md.dictID;
+    as.decodedDict.assign(block.getDict(), block.getDict() + block.getNDict());
+    as.decodedMin = md.min;
+    as.decodedBits = md.probabilityBits;
+  }
+  return o2::ctf::makeSlotOutput(dest, as.coder.get());
+}
+
 } // namespace ctf
 } // namespace o2
 
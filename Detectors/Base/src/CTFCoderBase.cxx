@@ -16,6 +16,8 @@
 #include "DetectorsCommonDataFormats/CTFHeader.h"
 #include "DetectorsBase/CTFCoderBase.h"
 #include <filesystem>
+#include <cmath>
+#include <limits>
 
 using namespace o2::ctf;
 
@@ -73,3 +75,40 @@ void CTFCoderBase::checkDictVersion(const CTFDictHeader& h) const
     }
   }
 }
+
+void CTFCoderBase::setAdaptiveDictionaries(bool v, float maxLoss, int checkPeriod)
+{
+  mAdaptive = v;
+  mAdaptiveMaxLoss = maxLoss;
+  mAdaptiveCheckPeriod = std::max(1, checkPeriod);
+  mAdaptiveSlots.clear();
+  mAdaptiveSlots.resize(mCoders.size());
+}
+
+double CTFCoderBase::estimateCompressionLoss(const o2::rans::FrequencyTable& reference, const o2::rans::FrequencyTable& sample)
+{
+  // compare the entropy of the sample with the cross-entropy wrt the reference distribution. Symbols absent in the reference
+  // are encoded as literals, for which we assume the cost of the rarest symbol plus a 32 bit word.
+  constexpr double LiteralCost = 32.;
+  const size_t nSample = sample.getNumSamples(), nRef = reference.getNumSamples();
+  if (!nSample) {
+    return 0.;
+  }
+  if (!nRef) {
+    return std::numeric_limits<double>::max();
+  }
+  const double log2NRef = std::log2(double(nRef)), log2NSample = std::log2(double(nSample));
+  const auto refMin = reference.getMinSymbol(), refMax = reference.getMaxSymbol();
+  double entropy = 0., crossEntropy = 0.;
+  for (size_t i = 0; i < sample.size(); i++) {
+    const double c = sample.at(i);
+    if (!c) {
+      continue;
+    }
+    const auto symbol = sample.getMinSymbol() + int(i);
+    entropy += c * (log2NSample - std::log2(c));
+    const double cRef = (symbol >= refMin && symbol <= refMax) ? reference.at(symbol - refMin) : 0.;
+    crossEntropy += c * (cRef ? log2NRef - std::log2(cRef) : log2NRef + LiteralCost);
+  }
+  return entropy > 0. ? crossEntropy / entropy - 1. : (crossEntropy > 0. ? std::numeric_limits<double>::max() : 0.);
+}
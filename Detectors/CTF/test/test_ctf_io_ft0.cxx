@@ -150,3 +150,77 @@ BOOST_AUTO_TEST_CASE(CTFTest)
     BOOST_CHECK(cor.QTCAmpl == cdc.QTCAmpl);
   }
 }
+
+BOOST_AUTO_TEST_CASE(CTFAdaptiveDictTest)
+{
+  // the same adaptive coder encodes several TFs, each CTF stores the dictionaries it was encoded with
+  constexpr int NTF = 3;
+  std::vector<std::vector<Digit>> digitsTF(NTF);
+  std::vector<std::vector<ChannelData>> channelsTF(NTF);
+  std::vector<std::vector<o2::ctf::BufferType>> vecTF(NTF);
+  constexpr int MAXChan = 4 * (Geometry::NCellsA + Geometry::NCellsC);
+  CTFCoder coderEnc;
+  coderEnc.setAdaptiveDictionaries(true, 0.05);
+  for (int itf = 0; itf < NTF; itf++) {
+    auto& digits = digitsTF[itf];
+    auto& channels = channelsTF[itf];
+    o2::InteractionRecord ir(0, itf * 256);
+    for (int idig = 0; idig < 500; idig++) {
+      ir += 1 + gRandom->Integer(200);
+      auto start = channels.size();
+      for (int ich = gRandom->Poisson(10); ich < MAXChan; ich += 1 + gRandom->Poisson(10)) {
+        channels.emplace_back(ich, -2048 + int(gRandom->Integer(2048 * 2)), int(gRandom->Integer(4096)), gRandom->Rndm() > 0.5 ? 0 : 1);
+      }
+      Triggers trig;
+      trig.triggersignals = gRandom->Integer(128);
+      digits.emplace_back(start, channels.size() - start, ir, trig, idig);
+    }
+    coderEnc.encode(vecTF[itf], digits, channels);
+  }
+
+  auto checkTF = [&](int itf, const std::vector<Digit>& digitsD, const std::vector<ChannelData>& channelsD) {
+    const auto& digits = digitsTF[itf];
+    const auto& channels = channelsTF[itf];
+    BOOST_CHECK(digitsD.size() == digits.size());
+    BOOST_CHECK(channelsD.size() == channels.size());
+    for (int i = digits.size(); i--;) {
+      BOOST_CHECK(digits[i].mIntRecord == digitsD[i].mIntRecord);
+      BOOST_CHECK(digits[i].mTriggers.triggersignals == digitsD[i].mTriggers.triggersignals);
+    }
+    for (int i = channels.size(); i--;) {
+      BOOST_CHECK(channels[i].ChId == channelsD[i].ChId);
+      BOOST_CHECK(channels[i].ChainQTC == channelsD[i].ChainQTC);
+      BOOST_CHECK(channels[i].CFDTime == channelsD[i].CFDTime);
+      BOOST_CHECK(channels[i].QTCAmpl == channelsD[i].QTCAmpl);
+    }
+  };
+
+  // the dictionaries are reused for the following TFs, but stored in every CTF
+  for (int itf = 0; itf < NTF; itf++) {
+    const auto ctfImage = CTF::getImage(vecTF[itf].data());
+    const auto& md = ctfImage.getMetadata(CTF::BLC_idChan);
+    BOOST_CHECK(md.dictID != 0);
+    BOOST_CHECK(ctfImage.getBlock(CTF::BLC_idChan).getNDict() != 0);
+    if (itf) {
+      BOOST_CHECK(md.dictID == CTF::getImage(vecTF[itf - 1].data()).getMetadata(CTF::BLC_idChan).dictID);
+    }
+  }
+
+  // every CTF can be decoded on its own, e.g. by a pipeline lane or a reader skipping TFs
+  {
+    CTFCoder coderDec;
+    std::vector<Digit> digitsD;
+    std::vector<ChannelData> channelsD;
+    coderDec.decode(CTF::getImage(vecTF[NTF - 1].data()), digitsD, channelsD);
+    checkTF(NTF - 1, digitsD, channelsD);
+  }
+
+  // the same decoder processing the CTFs in any order reuses the decoders while the dictionaries do not change
+  CTFCoder coderDec;
+  for (int itf = NTF; itf--;) {
+    std::vector<Digit> digitsD;
+    std::vector<ChannelData> channelsD;
+    coderDec.decode(CTF::getImage(vecTF[itf].data()), digitsD, channelsD);
+    checkTF(itf, digitsD, channelsD);
+  }
+}
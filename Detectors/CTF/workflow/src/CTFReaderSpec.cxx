@@ -24,6 +24,7 @@
 #include "DetectorsCommonDataFormats/EncodedBlocks.h"
 #include "DetectorsCommonDataFormats/NameConf.h"
 #include "DetectorsCommonDataFormats/CTFHeader.h"
+#include "DetectorsCommonDataFormats/CTFFlatFile.h"
 #include "DataFormatsITSMFT/CTF.h"
 #include "DataFormatsTPC/CTF.h"
 #include "DataFormatsTRD/CTF.h"
@@ -74,11 +75,18 @@ class CTFReaderSpec : public o2::framework::Task
 
  private:
   void openCTFFile(const std::string& flname);
+  void closeCTFFile();
+  size_t getNEntries() const { return mCTFFlatFile ? mCTFFlatFile->getNTFs() : mCTFTree->GetEntries(); }
+  std::string getFileName() const { return mCTFFlatFile ? mCTFFlatFile->getName() : std::string(mCTFFile->GetName()); }
+  template <typename C>
+  void processDetector(DetID det, const CTFHeader& ctfHeader, ProcessingContext& pc);
+  void setFirstTFOrbit(const std::string& label, const CTFHeader& ctfHeader, ProcessingContext& pc);
 
   DetID::mask_t mDets;             // detectors
   std::vector<std::string> mInput; // input files
   std::unique_ptr<TFile> mCTFFile;
   std::unique_ptr<TTree> mCTFTree;
+  std::unique_ptr<CTFFlatFileReader> mCTFFlatFile; // set instead of mCTFFile/mCTFTree for the flat CTF files
   uint32_t mCTFCounter = 0;
   size_t mNextToProcess = 0;
   int mCurrEntry = 0;
@@ -106,6 +114,12 @@ void CTFReaderSpec::init(InitContext& ic)
 ///_______________________________________
 void CTFReaderSpec::openCTFFile(const std::string& flname)
 {
+  mCurrEntry = 0;
+  if (CTFFlatFileReader::isFlatFile(flname)) {
+    mCTFFlatFile = std::make_unique<CTFFlatFileReader>();
+    mCTFFlatFile->open(flname);
+    return;
+  }
   mCTFFile.reset(TFile::Open(flname.c_str()));
   if (!mCTFFile->IsOpen() || mCTFFile->IsZombie()) {
     LOG(ERROR) << "Failed to open file " << flname;
@@ -115,7 +129,52 @@ void CTFReaderSpec::openCTFFile(const std::string& flname)
   if (!mCTFTree) {
     throw std::runtime_error("failed to load CTF tree");
   }
-  mCurrEntry = 0;
+}
+
+///_______________________________________
+void CTFReaderSpec::closeCTFFile()
+{
+  if (mCTFFlatFile) {
+    mCTFFlatFile.reset(); // the mapping is kept alive by the messages still referring to it
+  } else {
+    mCTFTree.reset();
+    mCTFFile->Close();
+    mCTFFile.reset();
+  }
+}
+
+///_______________________________________
+template <typename C>
+void CTFReaderSpec::processDetector(DetID det, const CTFHeader& ctfHeader, ProcessingContext& pc)
+{
+  if (!(mDets & ctfHeader.detectors)[det]) {
+    return;
+  }
+  if (mCTFFlatFile) { // the mapped image is sent as it is, the message shares the ownership of the mapping
+    size_t sz = 0;
+    auto* img = mCTFFlatFile->getBlock(mCurrEntry, det, sz);
+    if (!img) {
+      throw std::runtime_error(o2::utils::Str::concat_string("no CTF image for ", det.getName()));
+    }
+    auto* owner = new std::shared_ptr<const char>(mCTFFlatFile->getMapping());
+    auto freefct = [](void* data, void* hint) { delete static_cast<std::shared_ptr<const char>*>(hint); };
+    pc.outputs().adoptChunk(Output{det.getDataOrigin(), "CTFDATA", 0, Lifetime::Timeframe}, const_cast<char*>(img), sz, freefct, owner);
+  } else {
+    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(C));
+    C::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
+  }
+  setFirstTFOrbit(det.getName(), ctfHeader, pc);
+}
+
+///_______________________________________
+void CTFReaderSpec::setFirstTFOrbit(const std::string& label, const CTFHeader& ctfHeader, ProcessingContext& pc)
+{
+  auto* hd = pc.outputs().findMessageHeader({label});
+  if (!hd) {
+    throw std::runtime_error(o2::utils::Str::concat_string("failed to find output message header for ", label));
+  }
+  hd->firstTForbit = ctfHeader.firstTForbit;
+  hd->tfCounter = mCTFCounter;
 }
 
 ///_______________________________________
@@ -131,146 +190,45 @@ void CTFReaderSpec::run(ProcessingContext& pc)
   auto cput = mTimer.CpuTime();
   mTimer.Start(false);
 
-  if (!mCTFTree) { // there is still a tree open with multiple entries
+  if (!mCTFTree && !mCTFFlatFile) { // there is still a tree open with multiple entries
     std::string inputFile = o2::utils::Str::concat_string(mCTFDir, mInput[mNextToProcess]);
     LOG(INFO) << "Reading CTF input " << mNextToProcess << ' ' << inputFile;
     openCTFFile(inputFile);
   }
   CTFHeader ctfHeader;
-  if (!readFromTree(*(mCTFTree.get()), "CTFHeader", ctfHeader, mCurrEntry)) {
+  if (mCTFFlatFile) {
+    ctfHeader = mCTFFlatFile->getCTFHeader(mCurrEntry);
+  } else if (!readFromTree(*(mCTFTree.get()), "CTFHeader", ctfHeader, mCurrEntry)) {
     throw std::runtime_error("did not find CTFHeader");
   }
   LOG(INFO) << ctfHeader;
 
-  auto setFirstTFOrbit = [&pc, &ctfHeader, this](const std::string& label) {
-    auto* hd = pc.outputs().findMessageHeader({label});
-    if (!hd) {
-      throw std::runtime_error(o2::utils::Str::concat_string("failed to find output message header for ", label));
-    }
-    hd->firstTForbit = ctfHeader.firstTForbit;
-    hd->tfCounter = this->mCTFCounter;
-  };
-
   // send CTF Header
   pc.outputs().snapshot({"header"}, ctfHeader);
-  setFirstTFOrbit("header");
-
-  DetID::mask_t detsTF = mDets & ctfHeader.detectors;
-  DetID det;
-
-  det = DetID::ITS;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::itsmft::CTF));
-    o2::itsmft::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::MFT;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::itsmft::CTF));
-    o2::itsmft::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::TPC;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::tpc::CTF));
-    o2::tpc::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::TRD;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::trd::CTF));
-    o2::trd::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::FT0;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::ft0::CTF));
-    o2::ft0::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::FV0;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::fv0::CTF));
-    o2::fv0::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::FDD;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::fdd::CTF));
-    o2::fdd::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::TOF;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::tof::CTF));
-    o2::tof::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::MID;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::mid::CTF));
-    o2::mid::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::MCH;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::mch::CTF));
-    o2::mch::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::EMC;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::emcal::CTF));
-    o2::emcal::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::PHS;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::phos::CTF));
-    o2::phos::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::CPV;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::cpv::CTF));
-    o2::cpv::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::ZDC;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::zdc::CTF));
-    o2::zdc::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
-
-  det = DetID::HMP;
-  if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::hmpid::CTF));
-    o2::hmpid::CTF::readFromTree(bufVec, *(mCTFTree.get()), det.getName(), mCurrEntry);
-    setFirstTFOrbit(det.getName());
-  }
+  setFirstTFOrbit("header", ctfHeader, pc);
+
+  processDetector<o2::itsmft::CTF>(DetID::ITS, ctfHeader, pc);
+  processDetector<o2::itsmft::CTF>(DetID::MFT, ctfHeader, pc);
+  processDetector<o2::tpc::CTF>(DetID::TPC, ctfHeader, pc);
+  processDetector<o2::trd::CTF>(DetID::TRD, ctfHeader, pc);
+  processDetector<o2::ft0::CTF>(DetID::FT0, ctfHeader, pc);
+  processDetector<o2::fv0::CTF>(DetID::FV0, ctfHeader, pc);
+  processDetector<o2::fdd::CTF>(DetID::FDD, ctfHeader, pc);
+  processDetector<o2::tof::CTF>(DetID::TOF, ctfHeader, pc);
+  processDetector<o2::mid::CTF>(DetID::MID, ctfHeader, pc);
+  processDetector<o2::mch::CTF>(DetID::MCH, ctfHeader, pc);
+  processDetector<o2::emcal::CTF>(DetID::EMC, ctfHeader, pc);
+  processDetector<o2::phos::CTF>(DetID::PHS, ctfHeader, pc);
+  processDetector<o2::cpv::CTF>(DetID::CPV, ctfHeader, pc);
+  processDetector<o2::zdc::CTF>(DetID::ZDC, ctfHeader, pc);
+  processDetector<o2::hmpid::CTF>(DetID::HMP, ctfHeader, pc);
 
   mTimer.Stop();
-  LOGP(INFO, "Read CTF#{} ({} of {} in {}) in {:.3f} s", mCTFCounter, mCurrEntry, mCTFTree->GetEntries(), mCTFFile->GetName(), mTimer.CpuTime() - cput);
+  LOGP(INFO, "Read CTF#{} ({} of {} in {}) in {:.3f} s", mCTFCounter, mCurrEntry, getNEntries(), getFileName(), mTimer.CpuTime() - cput);
 
-  bool moreToProcess = (++mCurrEntry < mCTFTree->GetEntries());
+  bool moreToProcess = (++mCurrEntry < getNEntries());
   if (!moreToProcess) { // this file is done, check if there are other files
-    mCTFTree.reset();
-    mCTFFile->Close();
-    mCTFFile.reset();
+    closeCTFFile();
     moreToProcess = true;
     if (++mNextToProcess >= mInput.size()) {
       if (++mLoopsCounter >= mLoops) {
@@ -99,18 +99,19 @@ void CTFCoder::encode(VEC& buff, const gsl::span<const Digit>& digitVec, const g
   assignDictVersion(static_cast<o2::ctf::CTFDictHeader&>(ec->getHeader()));
   ec->getANSHeader().majorVersion = 0;
   ec->getANSHeader().minorVersion = 1;
-  // at every encoding the buffer might be autoexpanded, so we don't work with fixed pointer ec
-#define ENCODEFT0(part, slot, bits) CTF::get(buff.data())->encode(part, int(slot), bits, optField[int(slot)], &buff, mCoders[int(slot)].get());
+  // the blocks are encoded concurrently, the buffer is expanded once to the final size
+#define SRCFT0(part, slot, bits) getSlotInput(part, int(slot), bits, optField[int(slot)])
   // clang-format off
-  ENCODEFT0(cd.trigger,   CTF::BLC_trigger,  0);
-  ENCODEFT0(cd.bcInc,     CTF::BLC_bcInc,    0);
-  ENCODEFT0(cd.orbitInc,  CTF::BLC_orbitInc, 0);
-  ENCODEFT0(cd.nChan,     CTF::BLC_nChan,    0);
-  ENCODEFT0(cd.eventFlags, CTF::BLC_flags,    0);
-  ENCODEFT0(cd.idChan ,   CTF::BLC_idChan,   0);
-  ENCODEFT0(cd.qtcChain,  CTF::BLC_qtcChain, 0);
-  ENCODEFT0(cd.cfdTime,   CTF::BLC_cfdTime,  0);
-  ENCODEFT0(cd.qtcAmpl,   CTF::BLC_qtcAmpl,  0);
+  CTF::encodeParallel(buff, mNThreads,
+                      SRCFT0(cd.trigger,    CTF::BLC_trigger,  0),
+                      SRCFT0(cd.bcInc,      CTF::BLC_bcInc,    0),
+                      SRCFT0(cd.orbitInc,   CTF::BLC_orbitInc, 0),
+                      SRCFT0(cd.nChan,      CTF::BLC_nChan,    0),
+                      SRCFT0(cd.eventFlags, CTF::BLC_flags,    0),
+                      SRCFT0(cd.idChan,     CTF::BLC_idChan,   0),
+                      SRCFT0(cd.qtcChain,   CTF::BLC_qtcChain, 0),
+                      SRCFT0(cd.cfdTime,    CTF::BLC_cfdTime,  0),
+                      SRCFT0(cd.qtcAmpl,    CTF::BLC_qtcAmpl,  0));
   // clang-format on
   CTF::get(buff.data())->print(getPrefix());
 }
@@ -123,17 +124,18 @@ void CTFCoder::decode(const CTF::base& ec, VDIG& digitVec, VCHAN& channelVec)
   cd.header = ec.getHeader();
   checkDictVersion(static_cast<const o2::ctf::CTFDictHeader&>(cd.header));
   ec.print(getPrefix());
-#define DECODEFT0(part, slot) ec.decode(part, int(slot), mCoders[int(slot)].get())
+#define DSTFT0(part, slot) getSlotOutput(part, ec, int(slot))
   // clang-format off
-  DECODEFT0(cd.trigger,   CTF::BLC_trigger);
-  DECODEFT0(cd.bcInc,     CTF::BLC_bcInc);
-  DECODEFT0(cd.orbitInc,  CTF::BLC_orbitInc);
-  DECODEFT0(cd.nChan,     CTF::BLC_nChan);
-  DECODEFT0(cd.eventFlags,     CTF::BLC_flags);
-  DECODEFT0(cd.idChan,    CTF::BLC_idChan);
-  DECODEFT0(cd.qtcChain,  CTF::BLC_qtcChain);
-  DECODEFT0(cd.cfdTime,   CTF::BLC_cfdTime);
-  DECODEFT0(cd.qtcAmpl,   CTF::BLC_qtcAmpl);
+  ec.decodeParallel(mNThreads,
+                    DSTFT0(cd.trigger,    CTF::BLC_trigger),
+                    DSTFT0(cd.bcInc,      CTF::BLC_bcInc),
+                    DSTFT0(cd.orbitInc,   CTF::BLC_orbitInc),
+                    DSTFT0(cd.nChan,      CTF::BLC_nChan),
+                    DSTFT0(cd.eventFlags, CTF::BLC_flags),
+                    DSTFT0(cd.idChan,     CTF::BLC_idChan),
+                    DSTFT0(cd.qtcChain,   CTF::BLC_qtcChain),
+                    DSTFT0(cd.cfdTime,    CTF::BLC_cfdTime),
+                    DSTFT0(cd.qtcAmpl,    CTF::BLC_qtcAmpl));
   // clang-format on
   //
   decompress(cd, digitVec, channelVec);
@@ -36,6 +36,7 @@ void EntropyDecoderSpec::init(o2::framework::InitContext& ic)
   if (!dictPath.empty() && dictPath != "none") {
     mCTFCoder.createCoders(dictPath, o2::ctf::CTFCoderBase::OpType::Decoder);
   }
+  mCTFCoder.setNThreads(ic.options().get<int>("ctf-threads"));
 }
 
 void EntropyDecoderSpec::run(ProcessingContext& pc)
@@ -73,7 +74,8 @@ DataProcessorSpec getEntropyDecoderSpec()
     Inputs{InputSpec{"ctf", "FT0", "CTFDATA", 0, Lifetime::Timeframe}},
     outputs,
     AlgorithmSpec{adaptFromTask<EntropyDecoderSpec>()},
-    Options{{"ctf-dict", VariantType::String, o2::base::NameConf::getCTFDictFileName(), {"File of CTF decoding dictionary"}}}};
+    Options{{"ctf-dict", VariantType::String, o2::base::NameConf::getCTFDictFileName(), {"File of CTF decoding dictionary"}},
+            {"ctf-threads", VariantType::Int, 1, {"Number of threads for parallel decoding of CTF blocks"}}}};
 }
 
 } // namespace ft0
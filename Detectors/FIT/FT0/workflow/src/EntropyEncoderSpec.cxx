@@ -37,6 +37,11 @@ void EntropyEncoderSpec::init(o2::framework::InitContext& ic)
   if (!dictPath.empty() && dictPath != "none") {
     mCTFCoder.createCoders(dictPath, o2::ctf::CTFCoderBase::OpType::Encoder);
   }
+  mCTFCoder.setNThreads(ic.options().get<int>("ctf-threads"));
+  float adaptiveLoss = ic.options().get<float>("ctf-adaptive-dict");
+  if (adaptiveLoss > 0.f) {
+    mCTFCoder.setAdaptiveDictionaries(true, adaptiveLoss, ic.options().get<int>("ctf-adaptive-period"));
+  }
 }
 
 void EntropyEncoderSpec::run(ProcessingContext& pc)
@@ -73,7 +78,10 @@ DataProcessorSpec getEntropyEncoderSpec()
     inputs,
     Outputs{{"FT0", "CTFDATA", 0, Lifetime::Timeframe}},
     AlgorithmSpec{adaptFromTask<EntropyEncoderSpec>()},
-    Options{{"ctf-dict", VariantType::String, o2::base::NameConf::getCTFDictFileName(), {"File of CTF encoding dictionary"}}}};
+    Options{{"ctf-dict", VariantType::String, o2::base::NameConf::getCTFDictFileName(), {"File of CTF encoding dictionary"}},
+            {"ctf-threads", VariantType::Int, 1, {"Number of threads for parallel encoding of CTF blocks"}},
+            {"ctf-adaptive-dict", VariantType::Float, 0.f, {"If >0, use adaptive dictionaries rebuilt when the estimated compression loss exceeds this value"}},
+            {"ctf-adaptive-period", VariantType::Int, 1, {"Check adaptive dictionaries statistics every this number of TFs"}}}};
 }
 
 } // namespace ft0
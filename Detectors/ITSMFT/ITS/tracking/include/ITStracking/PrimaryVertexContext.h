@@ -53,6 +53,13 @@ class PrimaryVertexContext
   auto& getCellsNeighbours() { return mCellsNeighbours; }
   auto& getRoads() { return mRoads; }
 
+  /// Radii, z and phi coordinates and used flags of the clusters of each layer, stored as separate arrays in the
+  /// order of getClusters(), i.e. sorted by index table bin, for the contiguous scans of the candidates of a bin row
+  const auto& getClustersR() const { return mClustersR; }
+  const auto& getClustersZ() const { return mClustersZ; }
+  const auto& getClustersPhi() const { return mClustersPhi; }
+  const auto& getSortedUsedClusters() const { return mSortedUsedClusters; }
+
   float getMinR(int layer) { return mMinR[layer]; }
   float getMaxR(int layer) { return mMaxR[layer]; }
 
@@ -76,6 +83,10 @@ class PrimaryVertexContext
   std::vector<float> mMaxR;
   std::vector<std::vector<Cluster>> mClusters;
   std::vector<std::vector<bool>> mUsedClusters;
+  std::vector<std::vector<float>> mClustersR;
+  std::vector<std::vector<float>> mClustersZ;
+  std::vector<std::vector<float>> mClustersPhi;
+  std::vector<std::vector<unsigned char>> mSortedUsedClusters;
   std::vector<std::vector<Cell>> mCells;
   std::vector<std::vector<int>> mCellsLookupTable;
   std::vector<std::vector<std::vector<int>>> mCellsNeighbours;
@@ -50,6 +50,7 @@ class TrackerTraitsCPU : public TrackerTraits
  protected:
   std::vector<std::vector<Tracklet>> mTracklets;
   std::vector<std::vector<Cell>> mCells;
+  std::vector<unsigned char> mSelectedCandidates; ///< flags of the next layer clusters of the current bin row
 };
 } // namespace its
 } // namespace o2
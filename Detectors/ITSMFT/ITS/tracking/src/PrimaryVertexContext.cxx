@@ -43,6 +43,10 @@ void PrimaryVertexContext::initialise(const MemoryParameters& memParam, const Tr
     mMaxR.resize(trkParam.NLayers, -1.);
     mClusters.resize(trkParam.NLayers);
     mUsedClusters.resize(trkParam.NLayers);
+    mClustersR.resize(trkParam.NLayers);
+    mClustersZ.resize(trkParam.NLayers);
+    mClustersPhi.resize(trkParam.NLayers);
+    mSortedUsedClusters.resize(trkParam.NLayers);
     mCells.resize(trkParam.CellsPerRoad());
     mCellsLookupTable.resize(trkParam.CellsPerRoad() - 1);
     mCellsNeighbours.resize(trkParam.CellsPerRoad() - 1);
@@ -61,6 +65,9 @@ void PrimaryVertexContext::initialise(const MemoryParameters& memParam, const Tr
       mClusters[iLayer].resize(clustersNum);
       mUsedClusters[iLayer].clear();
       mUsedClusters[iLayer].resize(clustersNum, false);
+      mClustersR[iLayer].resize(clustersNum);
+      mClustersZ[iLayer].resize(clustersNum);
+      mClustersPhi[iLayer].resize(clustersNum);
 
       std::fill(clsPerBin.begin(), clsPerBin.end(), 0);
 
@@ -95,11 +102,15 @@ void PrimaryVertexContext::initialise(const MemoryParameters& memParam, const Tr
 
       for (int iCluster{0}; iCluster < clustersNum; ++iCluster) {
         ClusterHelper& h = cHelper[iCluster];
-        Cluster& c = mClusters[iLayer][lutPerBin[h.bin] + h.ind];
+        const int sortedIndex{lutPerBin[h.bin] + h.ind};
+        Cluster& c = mClusters[iLayer][sortedIndex];
         c = currentLayer[iCluster];
         c.phiCoordinate = h.phi;
         c.rCoordinate = h.r;
         c.indexTableBinIndex = h.bin;
+        mClustersR[iLayer][sortedIndex] = h.r;
+        mClustersZ[iLayer][sortedIndex] = c.zCoordinate;
+        mClustersPhi[iLayer][sortedIndex] = h.phi;
       }
 
       if (iLayer > 0) {
@@ -113,6 +124,15 @@ void PrimaryVertexContext::initialise(const MemoryParameters& memParam, const Tr
     }
   }
 
+  /// Clusters used by the previous passes, gathered in the sorted order
+  for (unsigned int iLayer{0}; iLayer < mClusters.size(); ++iLayer) {
+    const int clustersNum{static_cast<int>(mClusters[iLayer].size())};
+    mSortedUsedClusters[iLayer].resize(clustersNum);
+    for (int iCluster{0}; iCluster < clustersNum; ++iCluster) {
+      mSortedUsedClusters[iLayer][iCluster] = mUsedClusters[iLayer][mClusters[iLayer][iCluster].clusterId];
+    }
+  }
+
   mRoads.clear();
 
   for (unsigned int iLayer{0}; iLayer < mClusters.size(); ++iLayer) {
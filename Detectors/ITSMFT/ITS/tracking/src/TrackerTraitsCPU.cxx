@@ -22,6 +22,7 @@
 #include "ITStracking/Tracklet.h"
 #include <fmt/format.h>
 #include "ReconstructionDataFormats/Track.h"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -32,6 +33,27 @@ namespace o2
 namespace its
 {
 
+namespace
+{
+/// Flag the clusters of a bin row of the next layer which are unused and compatible in z and phi with the current
+/// cluster. The loop runs without branches over contiguous arrays, so that it is vectorised by the compiler.
+void selectTrackletCandidates(const int nCandidates, const float* GPUrestrict() r, const float* GPUrestrict() z,
+                              const float* GPUrestrict() phi, const unsigned char* GPUrestrict() used,
+                              const Cluster& currentCluster, const float tanLambda, const float maxDeltaZ,
+                              const float maxDeltaPhi, unsigned char* GPUrestrict() selected)
+{
+  const float currentR{currentCluster.rCoordinate};
+  const float currentZ{currentCluster.zCoordinate};
+  const float currentPhi{currentCluster.phiCoordinate};
+  for (int iCandidate{0}; iCandidate < nCandidates; ++iCandidate) {
+    const float deltaZ{o2::gpu::GPUCommonMath::Abs(tanLambda * (r[iCandidate] - currentR) + currentZ - z[iCandidate])};
+    const float deltaPhi{o2::gpu::GPUCommonMath::Abs(currentPhi - phi[iCandidate])};
+    selected[iCandidate] = !used[iCandidate] & (deltaZ < maxDeltaZ) &
+                           ((deltaPhi < maxDeltaPhi) | (o2::gpu::GPUCommonMath::Abs(deltaPhi - constants::math::TwoPi) < maxDeltaPhi));
+  }
+}
+} // namespace
+
 void TrackerTraitsCPU::computeLayerTracklets()
 {
   PrimaryVertexContext* primaryVertexContext = mPrimaryVertexContext;
@@ -42,11 +64,17 @@ void TrackerTraitsCPU::computeLayerTracklets()
 
     const float3& primaryVertex = primaryVertexContext->getPrimaryVertex();
     const int currentLayerClustersNum{static_cast<int>(primaryVertexContext->getClusters()[iLayer].size())};
+    const int nextLayerClustersNum{static_cast<int>(primaryVertexContext->getClusters()[iLayer + 1].size())};
+    const float* nextLayerR{primaryVertexContext->getClustersR()[iLayer + 1].data()};
+    const float* nextLayerZ{primaryVertexContext->getClustersZ()[iLayer + 1].data()};
+    const float* nextLayerPhi{primaryVertexContext->getClustersPhi()[iLayer + 1].data()};
+    const unsigned char* nextLayerUsed{primaryVertexContext->getSortedUsedClusters()[iLayer + 1].data()};
+    const auto& currentLayerUsed{primaryVertexContext->getSortedUsedClusters()[iLayer]};
 
     for (int iCluster{0}; iCluster < currentLayerClustersNum; ++iCluster) {
       const Cluster& currentCluster{primaryVertexContext->getClusters()[iLayer][iCluster]};
 
-      if (primaryVertexContext->isClusterUsed(iLayer, currentCluster.clusterId)) {
+      if (currentLayerUsed[iCluster]) {
         continue;
       }
 
@@ -76,39 +104,35 @@ void TrackerTraitsCPU::computeLayerTracklets()
         const int firstBinIndex{primaryVertexContext->mIndexTableUtils.getBinIndex(selectedBinsRect.x, iPhiBin)};
         const int maxBinIndex{firstBinIndex + selectedBinsRect.z - selectedBinsRect.x + 1};
         const int firstRowClusterIndex = primaryVertexContext->getIndexTables()[iLayer][firstBinIndex];
-        const int maxRowClusterIndex = primaryVertexContext->getIndexTables()[iLayer][maxBinIndex];
-
-        for (int iNextLayerCluster{firstRowClusterIndex}; iNextLayerCluster < maxRowClusterIndex;
-             ++iNextLayerCluster) {
-
-          if (iNextLayerCluster >= (int)primaryVertexContext->getClusters()[iLayer + 1].size()) {
-            break;
-          }
-
-          const Cluster& nextCluster{primaryVertexContext->getClusters()[iLayer + 1][iNextLayerCluster]};
+        const int maxRowClusterIndex = std::min(primaryVertexContext->getIndexTables()[iLayer][maxBinIndex], nextLayerClustersNum);
+        const int nCandidates{maxRowClusterIndex - firstRowClusterIndex};
+        if (nCandidates <= 0) {
+          continue;
+        }
+        if (nCandidates > (int)mSelectedCandidates.size()) {
+          mSelectedCandidates.resize(nCandidates);
+        }
+        selectTrackletCandidates(nCandidates, nextLayerR + firstRowClusterIndex, nextLayerZ + firstRowClusterIndex,
+                                 nextLayerPhi + firstRowClusterIndex, nextLayerUsed + firstRowClusterIndex, currentCluster,
+                                 tanLambda, mTrkParams.TrackletMaxDeltaZ[iLayer], mTrkParams.TrackletMaxDeltaPhi,
+                                 mSelectedCandidates.data());
 
-          if (primaryVertexContext->isClusterUsed(iLayer + 1, nextCluster.clusterId)) {
+        for (int iCandidate{0}; iCandidate < nCandidates; ++iCandidate) {
+          if (!mSelectedCandidates[iCandidate]) {
             continue;
           }
+          const int iNextLayerCluster{firstRowClusterIndex + iCandidate};
+          const Cluster& nextCluster{primaryVertexContext->getClusters()[iLayer + 1][iNextLayerCluster]};
 
-          const float deltaZ{o2::gpu::GPUCommonMath::Abs(tanLambda * (nextCluster.rCoordinate - currentCluster.rCoordinate) +
-                                                         currentCluster.zCoordinate - nextCluster.zCoordinate)};
-          const float deltaPhi{o2::gpu::GPUCommonMath::Abs(currentCluster.phiCoordinate - nextCluster.phiCoordinate)};
-
-          if (deltaZ < mTrkParams.TrackletMaxDeltaZ[iLayer] &&
-              (deltaPhi < mTrkParams.TrackletMaxDeltaPhi ||
-               o2::gpu::GPUCommonMath::Abs(deltaPhi - constants::math::TwoPi) < mTrkParams.TrackletMaxDeltaPhi)) {
-
-            if (iLayer > 0 &&
-                primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] == constants::its::UnusedIndex) {
-
-              primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] =
-                primaryVertexContext->getTracklets()[iLayer].size();
-            }
+          if (iLayer > 0 &&
+              primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] == constants::its::UnusedIndex) {
 
-            primaryVertexContext->getTracklets()[iLayer].emplace_back(iCluster, iNextLayerCluster, currentCluster,
-                                                                      nextCluster);
+            primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] =
+              primaryVertexContext->getTracklets()[iLayer].size();
           }
+
+          primaryVertexContext->getTracklets()[iLayer].emplace_back(iCluster, iNextLayerCluster, currentCluster,
+                                                                    nextCluster);
         }
       }
     }
@@ -0,0 +1,116 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file bench_TrackerTraitsCPU.cxx
+/// \brief Benchmark of the tracklet and cell finding of the ITS CA tracker on CPU
+///
+
+#include "benchmark/benchmark.h"
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ITStracking/Configuration.h"
+#include "ITStracking/PrimaryVertexContext.h"
+#include "ITStracking/TrackerTraitsCPU.h"
+
+using namespace o2::its;
+
+/// Clusters of a RO frame with nTracks primary tracks from the origin, smeared by the detector resolution,
+/// and as many noise clusters per layer
+std::vector<std::vector<Cluster>> generateClusters(int nTracks, const TrackingParameters& trkParams)
+{
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<float> phiDist(0.f, 2.f * M_PI);
+  std::uniform_real_distribution<float> tanLambdaDist(-1.f, 1.f);
+  std::uniform_real_distribution<float> curvatureDist(-1.f / 300.f, 1.f / 300.f); // pt > ~0.5 GeV in 0.5 T
+  std::normal_distribution<float> resolution(0.f, 5.e-4f);
+
+  std::vector<std::vector<Cluster>> clusters(trkParams.NLayers);
+  auto addCluster = [&clusters](int layer, float x, float y, float z) {
+    clusters[layer].emplace_back(x, y, z, clusters[layer].size());
+  };
+  for (int iTrack{0}; iTrack < nTracks; ++iTrack) {
+    const float phi0{phiDist(gen)}, tanLambda{tanLambdaDist(gen)}, curvature{curvatureDist(gen)};
+    for (int iLayer{0}; iLayer < trkParams.NLayers; ++iLayer) {
+      const float r{trkParams.LayerRadii[iLayer]};
+      const float halfAngle{std::asin(0.5f * r * curvature)}; // half of the azimuthal angle covered on the circle
+      const float length{std::abs(curvature) > 0.f ? 2.f * halfAngle / curvature : r};
+      const float z{tanLambda * length};
+      if (std::abs(z) > trkParams.LayerZ[iLayer] - 1.f) {
+        break;
+      }
+      const float phi{phi0 + halfAngle};
+      addCluster(iLayer, r * std::cos(phi) + resolution(gen), r * std::sin(phi) + resolution(gen), z + resolution(gen));
+    }
+  }
+  for (int iLayer{0}; iLayer < trkParams.NLayers; ++iLayer) {
+    std::uniform_real_distribution<float> zDist(1.f - trkParams.LayerZ[iLayer], trkParams.LayerZ[iLayer] - 1.f);
+    const float r{trkParams.LayerRadii[iLayer]};
+    for (int iNoise{0}; iNoise < nTracks; ++iNoise) {
+      const float phi{phiDist(gen)};
+      addCluster(iLayer, r * std::cos(phi), r * std::sin(phi), zDist(gen));
+    }
+  }
+  return clusters;
+}
+
+/// Time one step of the tracklet and cell finding, the steps before it being excluded from the timing
+template <int Step>
+static void benchmarkStep(benchmark::State& state)
+{
+  TrackingParameters trkParams;
+  MemoryParameters memParams;
+  const auto clusters = generateClusters(state.range(0), trkParams);
+
+  TrackerTraitsCPU traits;
+  traits.UpdateTrackingParameters(trkParams);
+  PrimaryVertexContext* context = traits.getPrimaryVertexContext();
+  auto runStep = [&](int step) {
+    if (step == 0) {
+      context->initialise(memParams, trkParams, clusters, {0.f, 0.f, 0.f}, 0);
+    } else if (step == 1) {
+      traits.computeLayerTracklets();
+    } else {
+      traits.computeLayerCells();
+    }
+  };
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int step{0}; step < Step; ++step) {
+      runStep(step);
+    }
+    state.ResumeTiming();
+    runStep(Step);
+  }
+
+  size_t nTracklets{0}, nCells{0};
+  for (auto& tracklets : context->getTracklets()) {
+    nTracklets += tracklets.size();
+  }
+  for (auto& cells : context->getCells()) {
+    nCells += cells.size();
+  }
+  state.counters["tracklets"] = nTracklets;
+  state.counters["cells"] = nCells;
+}
+
+static void BM_ContextInitialisation(benchmark::State& state) { benchmarkStep<0>(state); }
+static void BM_TrackletFinding(benchmark::State& state) { benchmarkStep<1>(state); }
+static void BM_CellFinding(benchmark::State& state) { benchmarkStep<2>(state); }
+
+BENCHMARK(BM_ContextInitialisation)->Arg(100)->Arg(1000)->Arg(4000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TrackletFinding)->Arg(100)->Arg(1000)->Arg(4000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CellFinding)->Arg(100)->Arg(1000)->Arg(4000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
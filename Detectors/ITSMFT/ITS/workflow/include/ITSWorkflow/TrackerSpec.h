@@ -46,13 +46,19 @@ class TrackerDPL : public framework::Task
   void endOfStream(framework::EndOfStreamContext& ec) final;
 
  private:
+  static constexpr int ROFsPerThread = 4; ///< RO frames prepared per thread before tracking them in parallel
+
   bool mIsMC = false;
   bool mRunVertexer = true;
+  int mNThreads = 1;
   std::string mMode = "sync";
+  o2::gpu::GPUDataTypes::DeviceType mDeviceType = o2::gpu::GPUDataTypes::DeviceType::CPU;
   o2::itsmft::TopologyDictionary mDict;
   std::unique_ptr<o2::gpu::GPUReconstruction> mRecChain = nullptr;
   std::unique_ptr<parameters::GRPObject> mGRP = nullptr;
   std::unique_ptr<Tracker> mTracker = nullptr;
+  std::vector<std::unique_ptr<TrackerTraits>> mTrackerTraitsPool; ///< CPU traits, hence primary vertex contexts, of the additional threads
+  std::vector<std::unique_ptr<Tracker>> mTrackerPool;             ///< trackers of the additional threads, mTracker being used by the first one
   std::unique_ptr<Vertexer> mVertexer = nullptr;
   TStopwatch mTimer;
 };
@@ -39,6 +39,10 @@
 #include "ITSReconstruction/FastMultEst.h"
 #include <fmt/format.h>
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace o2
 {
 using namespace framework;
@@ -46,7 +50,7 @@ namespace its
 {
 using Vertex = o2::dataformats::Vertex<o2::dataformats::TimeStamp<int>>;
 
-TrackerDPL::TrackerDPL(bool isMC, const std::string& trModeS, o2::gpu::GPUDataTypes::DeviceType dType) : mIsMC{isMC}, mMode{trModeS}, mRecChain{o2::gpu::GPUReconstruction::CreateInstance(dType, true)}
+TrackerDPL::TrackerDPL(bool isMC, const std::string& trModeS, o2::gpu::GPUDataTypes::DeviceType dType) : mIsMC{isMC}, mMode{trModeS}, mDeviceType{dType}, mRecChain{o2::gpu::GPUReconstruction::CreateInstance(dType, true)}
 {
   std::transform(mMode.begin(), mMode.end(), mMode.begin(), [](unsigned char c) { return std::tolower(c); });
 }
@@ -132,6 +136,33 @@ void TrackerDPL::init(InitContext& ic)
 
     double origD[3] = {0., 0., 0.};
     mTracker->setBz(field->getBz(origD));
+
+    mNThreads = std::max(1, ic.options().get<int>("nthreads"));
+    if (mNThreads > 1 && mDeviceType != o2::gpu::GPUDataTypes::DeviceType::CPU) {
+      LOG(WARNING) << "Parallel processing of RO frames is supported only on CPU, using 1 thread";
+      mNThreads = 1;
+    }
+    if (mNThreads > 1 && !mTracker->isMatLUT()) { // TGeo navigation is not thread-safe
+      LOG(WARNING) << "Parallel processing of RO frames needs the material LUT, using 1 thread";
+      mNThreads = 1;
+    }
+#ifndef WITH_OPENMP
+    if (mNThreads > 1) {
+      LOG(WARNING) << "Built without OpenMP, using 1 thread";
+      mNThreads = 1;
+    }
+#endif
+    // each additional thread gets its own tracker and primary vertex context
+    mTrackerTraitsPool.clear();
+    mTrackerPool.clear();
+    for (int ith = 1; ith < mNThreads; ith++) {
+      auto& traits = mTrackerTraitsPool.emplace_back(std::make_unique<TrackerTraitsCPU>());
+      auto& tracker = mTrackerPool.emplace_back(std::make_unique<Tracker>(traits.get()));
+      tracker->setParameters(memParams, trackParams);
+      tracker->getGlobalConfiguration();
+      tracker->setBz(mTracker->getBz());
+    }
+    LOG(INFO) << "ITS CA-Tracker processes RO frames with " << mNThreads << " thread(s)";
   } else {
     throw std::runtime_error(o2::utils::Str::concat_string("Cannot retrieve GRP from the ", filename));
   }
@@ -170,9 +201,7 @@ void TrackerDPL::run(ProcessingContext& pc)
     LOG(INFO) << labels->getIndexedSize() << " MC label objects , in " << mc2rofs.size() << " MC events";
   }
 
-  std::vector<o2::its::TrackITSExt> tracks;
   auto& allClusIdx = pc.outputs().make<std::vector<int>>(Output{"ITS", "TRACKCLSID", 0, Lifetime::Timeframe});
-  std::vector<o2::MCCompLabel> trackLabels;
   auto& allTracks = pc.outputs().make<std::vector<o2::its::TrackITS>>(Output{"ITS", "TRACKS", 0, Lifetime::Timeframe});
   std::vector<o2::MCCompLabel> allTrackLabels;
 
@@ -182,7 +211,6 @@ void TrackerDPL::run(ProcessingContext& pc)
   auto& irFrames = pc.outputs().make<std::vector<o2::dataformats::IRFrame>>(Output{"ITS", "IRFRAMES", 0, Lifetime::Timeframe});
 
   std::uint32_t roFrame = 0;
-  ROframe event(0, 7);
 
   bool continuous = mGRP->isDetContinuousReadOut("ITS");
   LOG(INFO) << "ITSTracker RO: continuous=" << continuous;
@@ -213,11 +241,65 @@ void TrackerDPL::run(ProcessingContext& pc)
     }
   };
 
+  // RO frames are independent: they are prepared (clusters loading, vertexing and selection) sequentially in batches,
+  // the accepted ones are tracked in parallel, each thread with its own tracker, and the tracks are stored in RO frame order
+  const int batchSize = mNThreads > 1 ? mNThreads * ROFsPerThread : 1;
+  std::vector<ROframe> events;
+  events.reserve(batchSize);
+  for (int iev = 0; iev < batchSize; iev++) {
+    events.emplace_back(0, 7);
+  }
+  std::vector<int> eventROFs(batchSize);
+  std::vector<std::vector<o2::its::TrackITSExt>> eventTracks(batchSize);
+  std::vector<std::vector<o2::MCCompLabel>> eventTrackLabels(batchSize);
+  int nEvents = 0, firstBatchROF = 0;
+
+  auto processBatch = [&](int lastROF) {
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+    for (int iev = 0; iev < nEvents; iev++) {
+      int ith = 0;
+#ifdef WITH_OPENMP
+      ith = omp_get_thread_num();
+#endif
+      auto& tracker = ith ? *mTrackerPool[ith - 1] : *mTracker;
+      tracker.setROFrame(eventROFs[iev]);
+      tracker.clustersToTracks(events[iev]);
+      eventTracks[iev].swap(tracker.getTracks());
+      eventTrackLabels[iev].swap(tracker.getTrackLabels());
+    }
+    for (int iev = 0, iROF = firstBatchROF; iROF < lastROF; iROF++) {
+      auto& rof = rofs[iROF];
+      int first = allTracks.size();
+      if (iev == nEvents || eventROFs[iev] != iROF) { // empty or rejected ROF
+        rof.setFirstEntry(first);
+        rof.setNEntries(0);
+        continue;
+      }
+      auto& tracks = eventTracks[iev];
+      LOG(INFO) << "ROframe: " << iROF << ", found tracks: " << tracks.size();
+      int number = tracks.size();
+      int shiftIdx = -rof.getFirstEntry(); // cluster entry!!!
+      rof.setFirstEntry(first);
+      rof.setNEntries(number);
+      copyTracks(tracks, allTracks, allClusIdx, shiftIdx);
+      std::copy(eventTrackLabels[iev].begin(), eventTrackLabels[iev].end(), std::back_inserter(allTrackLabels));
+      tracks.clear();
+      eventTrackLabels[iev].clear();
+      if (number) {
+        irFrames.emplace_back(rof.getBCData(), rof.getBCData() + nBCPerTF - 1);
+      }
+      iev++;
+    }
+    nEvents = 0;
+    firstBatchROF = lastROF;
+  };
+
   gsl::span<const unsigned char>::iterator pattIt = patterns.begin();
   for (auto& rof : rofs) {
+    auto& event = events[nEvents];
     int nclUsed = ioutils::loadROFrameData(rof, event, compClusters, pattIt, mDict, labels);
-    // prepare in advance output ROFRecords, even if this ROF to be rejected
-    int first = allTracks.size();
 
     if (nclUsed) {
       LOG(INFO) << "ROframe: " << roFrame << ", clusters loaded : " << nclUsed;
@@ -227,24 +309,23 @@ void TrackerDPL::run(ProcessingContext& pc)
       vtxROF.setFirstEntry(vertices.size());       // dedicated ROFRecord
       vtxROF.setNEntries(0);
 
+      bool selected = true;
       if (multEstConf.cutMultClusLow > 0 || multEstConf.cutMultClusHigh > 0) { // cut was requested
         auto mult = multEst.process(rof.getROFData(compClusters));
         if (mult < multEstConf.cutMultClusLow || mult > multEstConf.cutMultClusHigh) {
           LOG(INFO) << "Estimated cluster mult. " << mult << " is outside of requested range "
                     << multEstConf.cutMultClusLow << " : " << multEstConf.cutMultClusHigh << " | ROF " << rof.getBCData();
-          rof.setFirstEntry(first);
-          rof.setNEntries(0);
-          continue;
+          selected = false;
         }
       }
 
       std::vector<Vertex> vtxVecLoc;
-      if (mRunVertexer) {
+      if (selected && mRunVertexer) {
         mVertexer->clustersToVertices(event);
         vtxVecLoc = mVertexer->exportVertices();
       }
 
-      if (mRunVertexer && (multEstConf.cutMultVtxLow > 0 || multEstConf.cutMultVtxHigh > 0)) { // cut was requested
+      if (selected && mRunVertexer && (multEstConf.cutMultVtxLow > 0 || multEstConf.cutMultVtxHigh > 0)) { // cut was requested
         std::vector<o2::dataformats::Vertex<o2::dataformats::TimeStamp<int>>> vtxVecSel;
         vtxVecSel.swap(vtxVecLoc);
         for (const auto& vtx : vtxVecSel) {
@@ -255,40 +336,28 @@ void TrackerDPL::run(ProcessingContext& pc)
           }
           vtxVecLoc.push_back(vtx);
         }
-        if (vtxVecLoc.empty()) { // reject ROF
-          rof.setFirstEntry(first);
-          rof.setNEntries(0);
-          continue;
-        }
+        selected = !vtxVecLoc.empty(); // reject ROF
       }
 
-      if (mRunVertexer) {
-        event.addPrimaryVertices(vtxVecLoc);
-      } else {
-        event.addPrimaryVertex(0.f, 0.f, 0.f);
-      }
-      mTracker->setROFrame(roFrame);
-      mTracker->clustersToTracks(event);
-      tracks.swap(mTracker->getTracks());
-      LOG(INFO) << "Found tracks: " << tracks.size();
-      int number = tracks.size();
-      trackLabels.swap(mTracker->getTrackLabels()); /// FIXME: assignment ctor is not optimal.
-      int shiftIdx = -rof.getFirstEntry();          // cluster entry!!!
-      rof.setFirstEntry(first);
-      rof.setNEntries(number);
-      copyTracks(tracks, allTracks, allClusIdx, shiftIdx);
-      std::copy(trackLabels.begin(), trackLabels.end(), std::back_inserter(allTrackLabels));
-      trackLabels.clear();
-      vtxROF.setNEntries(vtxVecLoc.size());
-      for (const auto& vtx : vtxVecLoc) {
-        vertices.push_back(vtx);
-      }
-      if (number) {
-        irFrames.emplace_back(rof.getBCData(), rof.getBCData() + nBCPerTF - 1);
+      if (selected) {
+        if (mRunVertexer) {
+          event.addPrimaryVertices(vtxVecLoc);
+        } else {
+          event.addPrimaryVertex(0.f, 0.f, 0.f);
+        }
+        vtxROF.setNEntries(vtxVecLoc.size());
+        for (const auto& vtx : vtxVecLoc) {
+          vertices.push_back(vtx);
+        }
+        eventROFs[nEvents++] = roFrame;
       }
     }
     roFrame++;
+    if (nEvents == batchSize) {
+      processBatch(roFrame);
+    }
   }
+  processBatch(roFrame);
 
   LOG(INFO) << "ITSTracker pushed " << allTracks.size() << " tracks";
   if (mIsMC) {
@@ -335,7 +404,8 @@ DataProcessorSpec getTrackerSpec(bool useMC, const std::string& trModeS, o2::gpu
     Options{
       {"grp-file", VariantType::String, "o2sim_grp.root", {"Name of the grp file"}},
       {"its-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}},
-      {"material-lut-path", VariantType::String, "", {"Path of the material LUT file"}}}};
+      {"material-lut-path", VariantType::String, "", {"Path of the material LUT file"}},
+      {"nthreads", VariantType::Int, 1, {"Number of threads tracking RO frames in parallel (CPU only)"}}}};
 }
 
 } // namespace its
@@ -60,6 +60,9 @@ class Tracker : public TrackerConfig
   void setROFrame(std::uint32_t f) { mROFrame = f; }
   std::uint32_t getROFrame() const { return mROFrame; }
 
+  void setNumberOfThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNumberOfThreads() const { return mNThreads; }
+
   void initialize();
   void initConfig(const MFTTrackingParam& trkParam, bool printConfig = false);
 
@@ -73,6 +76,8 @@ class Tracker : public TrackerConfig
   void updateCellStatusInRoad();
 
   bool fitTracks(ROframe&);
+  template <class T>
+  void fitTrack(T&);
 
   const Int_t isDiskFace(Int_t layer) const { return (layer % 2); }
   const Float_t getDistanceToSeed(const Cluster&, const Cluster&, const Cluster&) const;
@@ -93,6 +98,7 @@ class Tracker : public TrackerConfig
   Int_t mMaxCellLevel = 0;
 
   bool mUseMC = false;
+  int mNThreads = 1;
 
   std::array<std::array<std::array<std::vector<Int_t>, constants::index_table::MaxRPhiBins>, (constants::mft::LayersNumber - 1)>, (constants::mft::LayersNumber - 1)> mBinsS;
   std::array<std::array<std::array<std::vector<Int_t>, constants::index_table::MaxRPhiBins>, (constants::mft::LayersNumber - 1)>, (constants::mft::LayersNumber - 1)> mBins;
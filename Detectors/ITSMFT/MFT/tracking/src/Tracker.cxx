@@ -750,25 +750,37 @@ void Tracker::addCellToCurrentTrackCA(const Int_t layer1, const Int_t cellId, RO
   trackCA.setPoint(cluster1, layer1, clsInLayer1, mcCompLabel1, extClsIndex);
 }
 
+//_________________________________________________________________________________________________
+template <class T>
+void Tracker::fitTrack(T& track)
+{
+  T outParam = track;
+  mTrackFitter->initTrack(track);
+  mTrackFitter->fit(track);
+  mTrackFitter->initTrack(outParam, true);
+  mTrackFitter->fit(outParam, true);
+  track.setOutParam(outParam);
+}
+
 //_________________________________________________________________________________________________
 bool Tracker::fitTracks(ROframe& event)
 {
-  for (auto& track : event.getTracksLTF()) {
-    TrackLTF outParam = track;
-    mTrackFitter->initTrack(track);
-    mTrackFitter->fit(track);
-    mTrackFitter->initTrack(outParam, true);
-    mTrackFitter->fit(outParam, true);
-    track.setOutParam(outParam);
-  }
-  for (auto& track : event.getTracksCA()) {
-    track.sort();
-    TrackCA outParam = track;
-    mTrackFitter->initTrack(track);
-    mTrackFitter->fit(track);
-    mTrackFitter->initTrack(outParam, true);
-    mTrackFitter->fit(outParam, true);
-    track.setOutParam(outParam);
+  // the tracks are independent and the fitter only holds its configuration, so they are fitted in parallel
+  auto& tracksLTF = event.getTracksLTF();
+  auto& tracksCA = event.getTracksCA();
+  const Int_t nTracksLTF = tracksLTF.size();
+  const Int_t nTracks = nTracksLTF + tracksCA.size();
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic, 8) num_threads(mNThreads) if (mNThreads > 1)
+#endif
+  for (Int_t iTrack = 0; iTrack < nTracks; ++iTrack) {
+    if (iTrack < nTracksLTF) {
+      fitTrack(tracksLTF[iTrack]);
+    } else {
+      auto& track = tracksCA[iTrack - nTracksLTF];
+      track.sort();
+      fitTrack(track);
+    }
   }
 
   return true;
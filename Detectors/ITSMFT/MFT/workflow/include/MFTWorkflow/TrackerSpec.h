@@ -37,10 +37,14 @@ class TrackerDPL : public o2::framework::Task
   void endOfStream(framework::EndOfStreamContext& ec) final;
 
  private:
+  static constexpr int ROFsPerThread = 4; ///< RO frames loaded per thread before tracking them in parallel
+
   bool mUseMC = false;
+  int mNThreads = 1;
   o2::itsmft::TopologyDictionary mDict;
   std::unique_ptr<o2::parameters::GRPObject> mGRP = nullptr;
   std::unique_ptr<o2::mft::Tracker> mTracker = nullptr;
+  std::vector<std::unique_ptr<o2::mft::Tracker>> mTrackerPool; ///< trackers of the additional threads, mTracker being used by the first one
   TStopwatch mTimer;
 };
 
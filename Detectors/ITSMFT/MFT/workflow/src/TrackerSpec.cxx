@@ -20,6 +20,7 @@
 #include "MFTTracking/TrackCA.h"
 #include "MFTBase/GeometryTGeo.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "TGeoGlobalMagField.h"
@@ -36,6 +37,10 @@
 #include "DetectorsBase/Propagator.h"
 #include "DetectorsCommonDataFormats/NameConf.h"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::framework;
 
 namespace o2
@@ -62,11 +67,29 @@ void TrackerDPL::init(InitContext& ic)
     // tracking configuration parameters
     auto& mftTrackingParam = MFTTrackingParam::Instance();
     // create the tracker: set the B-field, the configuration and initialize
-    mTracker = std::make_unique<o2::mft::Tracker>(mUseMC);
+    mNThreads = std::max(1, ic.options().get<int>("nthreads"));
+#ifndef WITH_OPENMP
+    if (mNThreads > 1) {
+      LOG(WARNING) << "Built without OpenMP, using 1 thread";
+      mNThreads = 1;
+    }
+#endif
     double centerMFT[3] = {0, 0, -61.4}; // Field at center of MFT
-    mTracker->setBz(field->getBz(centerMFT));
-    mTracker->initConfig(mftTrackingParam, true);
-    mTracker->initialize();
+    auto createTracker = [&](bool printConfig) {
+      auto tracker = std::make_unique<o2::mft::Tracker>(mUseMC);
+      tracker->setBz(field->getBz(centerMFT));
+      tracker->initConfig(mftTrackingParam, printConfig);
+      tracker->initialize();
+      tracker->setNumberOfThreads(mNThreads);
+      return tracker;
+    };
+    mTracker = createTracker(true);
+    // each additional thread tracks its RO frames with its own tracker
+    mTrackerPool.clear();
+    for (int ith = 1; ith < mNThreads; ith++) {
+      mTrackerPool.emplace_back(createTracker(false));
+    }
+    LOG(INFO) << "MFT Tracker processes RO frames with " << mNThreads << " thread(s)";
   } else {
     throw std::runtime_error(o2::utils::Str::concat_string("Cannot retrieve GRP from the ", filename));
   }
@@ -110,20 +133,16 @@ void TrackerDPL::run(ProcessingContext& pc)
 
   //std::vector<o2::mft::TrackMFTExt> tracks;
   auto& allClusIdx = pc.outputs().make<std::vector<int>>(Output{"MFT", "TRACKCLSID", 0, Lifetime::Timeframe});
-  std::vector<o2::MCCompLabel> trackLabels;
   std::vector<o2::MCCompLabel> allTrackLabels;
-  std::vector<o2::mft::TrackLTF> tracksLTF;
-  std::vector<o2::mft::TrackCA> tracksCA;
   auto& allTracksMFT = pc.outputs().make<std::vector<o2::mft::TrackMFT>>(Output{"MFT", "TRACKS", 0, Lifetime::Timeframe});
 
   std::uint32_t roFrame = 0;
-  o2::mft::ROframe event(0);
 
   Bool_t continuous = mGRP->isDetContinuousReadOut("MFT");
   LOG(INFO) << "MFTTracker RO: continuous=" << continuous;
 
   // snippet to convert found tracks to final output tracks with separate cluster indices
-  auto copyTracks = [&event](auto& tracks, auto& allTracks, auto& allClusIdx) {
+  auto copyTracks = [](auto& tracks, auto& allTracks, auto& allClusIdx) {
     for (auto& trc : tracks) {
       trc.setExternalClusterIndexOffset(allClusIdx.size());
       int ncl = trc.getNumberOfPoints();
@@ -135,40 +154,77 @@ void TrackerDPL::run(ProcessingContext& pc)
     }
   };
 
+  // RO frames are independent: they are loaded sequentially in batches, tracked in parallel, each thread with its
+  // own tracker, and their tracks are stored in RO frame order
+  const int batchSize = mNThreads > 1 ? mNThreads * ROFsPerThread : 1;
+  std::vector<o2::mft::ROframe> events;
+  events.reserve(batchSize);
+  for (int iev = 0; iev < batchSize; iev++) {
+    events.emplace_back(0);
+  }
+  std::vector<int> eventROFs(batchSize);
+  std::vector<std::vector<o2::MCCompLabel>> eventTrackLabels(batchSize);
+  int nEvents = 0;
+
+  auto processBatch = [&]() {
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(std::min(mNThreads, nEvents)) if (nEvents > 1)
+#endif
+    for (int iev = 0; iev < nEvents; iev++) {
+      int ith = 0;
+#ifdef WITH_OPENMP
+      ith = omp_get_thread_num();
+#endif
+      auto& tracker = ith ? *mTrackerPool[ith - 1] : *mTracker;
+      auto& event = events[iev];
+      tracker.setROFrame(eventROFs[iev]);
+      tracker.clustersToTracks(event);
+      if (mUseMC) {
+        tracker.computeTracksMClabels(event.getTracksLTF());
+        tracker.computeTracksMClabels(event.getTracksCA());
+        eventTrackLabels[iev].swap(tracker.getTrackLabels());
+      }
+    }
+    for (int iev = 0; iev < nEvents; iev++) {
+      auto& event = events[iev];
+      auto& tracksLTF = event.getTracksLTF();
+      auto& tracksCA = event.getTracksCA();
+      nTracksLTF += tracksLTF.size();
+      nTracksCA += tracksCA.size();
+      if (mUseMC) {
+        std::copy(eventTrackLabels[iev].begin(), eventTrackLabels[iev].end(), std::back_inserter(allTrackLabels));
+        eventTrackLabels[iev].clear();
+      }
+
+      LOG(INFO) << "ROframe: " << eventROFs[iev] << ", found tracks LTF: " << tracksLTF.size() << ", CA: " << tracksCA.size();
+      auto& rof = rofs[eventROFs[iev]];
+      int first = allTracksMFT.size();
+      int number = tracksLTF.size() + tracksCA.size();
+      rof.setFirstEntry(first);
+      rof.setNEntries(number);
+      copyTracks(tracksLTF, allTracksMFT, allClusIdx);
+      copyTracks(tracksCA, allTracksMFT, allClusIdx);
+    }
+    nEvents = 0;
+  };
+
   gsl::span<const unsigned char>::iterator pattIt = patterns.begin();
   if (continuous) {
     for (auto& rof : rofs) {
+      auto& event = events[nEvents];
       int nclUsed = ioutils::loadROFrameData(rof, event, compClusters, pattIt, mDict, labels, mTracker.get());
       if (nclUsed) {
         event.setROFrameId(roFrame);
         event.initialize();
         LOG(INFO) << "ROframe: " << roFrame << ", clusters loaded : " << nclUsed;
-        mTracker->setROFrame(roFrame);
-        mTracker->clustersToTracks(event);
-        tracksLTF.swap(event.getTracksLTF());
-        tracksCA.swap(event.getTracksCA());
-        nTracksLTF += tracksLTF.size();
-        nTracksCA += tracksCA.size();
-
-        if (mUseMC) {
-          mTracker->computeTracksMClabels(tracksLTF);
-          mTracker->computeTracksMClabels(tracksCA);
-          trackLabels.swap(mTracker->getTrackLabels());
-          std::copy(trackLabels.begin(), trackLabels.end(), std::back_inserter(allTrackLabels));
-          trackLabels.clear();
+        eventROFs[nEvents++] = roFrame;
+        if (nEvents == batchSize) {
+          processBatch();
         }
-
-        LOG(INFO) << "Found tracks LTF: " << tracksLTF.size();
-        LOG(INFO) << "Found tracks CA: " << tracksCA.size();
-        int first = allTracksMFT.size();
-        int number = tracksLTF.size() + tracksCA.size();
-        rof.setFirstEntry(first);
-        rof.setNEntries(number);
-        copyTracks(tracksLTF, allTracksMFT, allClusIdx);
-        copyTracks(tracksCA, allTracksMFT, allClusIdx);
       }
       roFrame++;
     }
+    processBatch();
   }
 
   LOG(INFO) << "MFTTracker found " << nTracksLTF << " tracks LTF";
@@ -214,7 +270,8 @@ DataProcessorSpec getTrackerSpec(bool useMC)
     AlgorithmSpec{adaptFromTask<TrackerDPL>(useMC)},
     Options{
       {"grp-file", VariantType::String, "o2sim_grp.root", {"Name of the output file"}},
-      {"mft-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}}}};
+      {"mft-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}},
+      {"nthreads", VariantType::Int, 1, {"Number of threads tracking RO frames and fitting tracks in parallel"}}}};
 }
 
 } // namespace mft
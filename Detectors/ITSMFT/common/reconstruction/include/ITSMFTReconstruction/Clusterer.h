@@ -82,6 +82,14 @@ class Clusterer
     ThreadStat() = default;
   };
 
+  /// block of chips clustered by a thread and the offsets of its slice in the final output
+  struct MergeBlock {
+    const ThreadStat* stat = nullptr;
+    int thread = 0;
+    size_t destClus = 0;
+    size_t destPatt = 0;
+  };
+
   struct ClustererThread {
 
     Clusterer* parent = nullptr; // parent clusterer
@@ -220,6 +228,7 @@ class Clusterer
   std::vector<ChipPixelData> mChips;                      // currently processed ROF's chips data
   std::vector<ChipPixelData> mChipsOld;                   // previously processed ROF's chips data (for masking)
   std::vector<ChipPixelData*> mFiredChipsPtr;             // pointers on the fired chips data in the decoder cache
+  std::vector<MergeBlock> mMergeBlocks;                   // thread output blocks in chips order, used at merging
 
   LookUp mPattIdConverter; //! Convert the cluster topology to the corresponding entry in the dictionary.
 
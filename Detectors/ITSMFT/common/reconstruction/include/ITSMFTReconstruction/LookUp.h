@@ -23,6 +23,8 @@
 #ifndef ALICEO2_ITSMFT_LOOKUP_H
 #define ALICEO2_ITSMFT_LOOKUP_H
 #include <array>
+#include <utility>
+#include <vector>
 #include "DataFormatsITSMFT/ClusterTopology.h"
 #include "DataFormatsITSMFT/TopologyDictionary.h"
 
@@ -36,16 +38,34 @@ class LookUp
   LookUp();
   LookUp(std::string fileName);
   static int groupFinder(int nRow, int nCol);
-  int findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]);
+  int findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]) const;
+  /// find the ID of a topology whose bounding box has at most 8 pixels, i.e. its pattern is a single byte
+  int findSmallGroupID(int nRow, int nCol, unsigned char pattByte) const
+  {
+    int id = mDictionary.mSmallTopologiesLUT[(nCol - 1) * 255 + (int)pattByte];
+    return id >= 0 ? id : mGroupIDs[groupFinder(nRow, nCol)];
+  }
+  /// ID of the single pixel topology
+  int getSinglePixelID() const { return mSinglePixelID; }
   int getTopologiesOverThreshold() { return mTopologiesOverThreshold; }
   void loadDictionary(std::string fileName);
-  bool isGroup(int id) const;
+  bool isGroup(int id) const { return mIsGroup[id]; }
   int size() const { return mDictionary.getSize(); }
 
  private:
+  void buildCommonTable();
+  int findCommonID(unsigned long hash) const;
+
   TopologyDictionary mDictionary;
   int mTopologiesOverThreshold;
 
+  // flat copies of the dictionary maps, built at loading
+  int mSinglePixelID = -1;                                           //! ID of the single pixel topology
+  std::array<int, TopologyDictionary::NumberOfRareGroups> mGroupIDs; //! ID of the groups of rare topologies
+  std::vector<bool> mIsGroup;                                        //! flag for groups of rare topologies per ID
+  std::vector<std::pair<unsigned long, int>> mCommonTable;           //! open addressing table <hash, ID> of common topologies
+  unsigned long mCommonTableMask = 0;                                //! size of mCommonTable - 1
+
   ClassDefNV(LookUp, 3);
 };
 } // namespace itsmft
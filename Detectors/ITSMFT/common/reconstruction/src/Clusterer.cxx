@@ -97,42 +97,47 @@ void Clusterer::process(int nThreads, PixelReader& reader, CompClusCont* compClu
 #else
     mThreads[0]->process(0, nFired, compClus, patterns, labelsCl ? reader.getDigitsMCTruth() : nullptr, labelsCl, rof);
 #endif
-    // copy data of all threads but the 1st one to final destination
+    // copy data of all threads to the final destination: the output is resized once and every block of chips
+    // processed by a thread is copied to its own slice, with offsets given by the prefix sum of the block sizes
     if (nThreads > 1) {
 #ifdef _PERFORM_TIMING_
       mTimerMerge.Start(false);
 #endif
-      size_t nClTot = 0, nPattTot = 0;
-      int chid = 0, thrStatIdx[nThreads];
+      mMergeBlocks.clear();
       for (int ith = 0; ith < nThreads; ith++) {
-        thrStatIdx[ith] = 0;
-        nClTot += mThreads[ith]->compClusters.size();
-        nPattTot += mThreads[ith]->patterns.size();
+        for (const auto& stat : mThreads[ith]->stats) {
+          mMergeBlocks.push_back(MergeBlock{&stat, ith, 0, 0});
+        }
+      }
+      std::sort(mMergeBlocks.begin(), mMergeBlocks.end(), [](const MergeBlock& a, const MergeBlock& b) { return a.stat->firstChip < b.stat->firstChip; });
+      size_t nClTot = compClus->size(), nPattTot = patterns ? patterns->size() : 0;
+      for (auto& block : mMergeBlocks) {
+        block.destClus = nClTot;
+        block.destPatt = nPattTot;
+        nClTot += block.stat->nClus;
+        nPattTot += block.stat->nPatt;
       }
-      compClus->reserve(nClTot);
+      compClus->resize(nClTot);
       if (patterns) {
-        patterns->reserve(nPattTot);
+        patterns->resize(nPattTot);
       }
-      while (chid < nFired) {
-        for (int ith = 0; ith < nThreads; ith++) {
-          if (thrStatIdx[ith] >= mThreads[ith]->stats.size()) {
-            continue;
-          }
-          const auto& stat = mThreads[ith]->stats[thrStatIdx[ith]];
-          if (stat.firstChip == chid) {
-            thrStatIdx[ith]++;
-            chid += stat.nChips; // next chip to look
-            const auto clbeg = mThreads[ith]->compClusters.begin() + stat.firstClus;
-            auto szold = compClus->size();
-            compClus->insert(compClus->end(), clbeg, clbeg + stat.nClus);
-            if (patterns) {
-              const auto ptbeg = mThreads[ith]->patterns.begin() + stat.firstPatt;
-              patterns->insert(patterns->end(), ptbeg, ptbeg + stat.nPatt);
-            }
-            if (labelsCl) {
-              labelsCl->mergeAtBack(mThreads[ith]->labels, stat.firstClus, stat.nClus);
-            }
-          }
+      int nBlocks = mMergeBlocks.size();
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int ib = 0; ib < nBlocks; ib++) {
+        const auto& block = mMergeBlocks[ib];
+        const auto& thr = *mThreads[block.thread];
+        const auto clbeg = thr.compClusters.begin() + block.stat->firstClus;
+        std::copy(clbeg, clbeg + block.stat->nClus, compClus->begin() + block.destClus);
+        if (patterns) {
+          const auto ptbeg = thr.patterns.begin() + block.stat->firstPatt;
+          std::copy(ptbeg, ptbeg + block.stat->nPatt, patterns->begin() + block.destPatt);
+        }
+      }
+      if (labelsCl) {
+        for (const auto& block : mMergeBlocks) {
+          labelsCl->mergeAtBack(mThreads[block.thread]->labels, block.stat->firstClus, block.stat->nClus);
         }
       }
       for (int ith = 0; ith < nThreads; ith++) {
@@ -302,14 +307,36 @@ void Clusterer::ClustererThread::streamCluster(const std::vector<PixelData>& pix
   }
 
   // add to compact clusters, which must be always filled
-  unsigned char patt[ClusterPattern::MaxPatternBytes] = {0}; // RSTODO FIX pattern filling
-  for (const auto& pix : pixbuf) {
-    unsigned short ir = pix.getRowDirect() - rowMin, ic = pix.getCol() - colMin;
-    int nbits = ir * colSpanW + ic;
-    patt[nbits >> 3] |= (0x1 << (7 - (nbits % 8)));
+  const auto& pattIdConverter = parent->mPattIdConverter;
+  bool useDict = !isHuge && pattIdConverter.size() != 0;
+  int nBits = rowSpanW * colSpanW;
+  int nBytes = nBits / 8;
+  if ((nBits % 8) != 0) {
+    nBytes++;
   }
-  uint16_t pattID = (isHuge || parent->mPattIdConverter.size() == 0) ? CompCluster::InvalidPatternID : parent->mPattIdConverter.findGroupID(rowSpanW, colSpanW, patt);
-  if (pattID == CompCluster::InvalidPatternID || parent->mPattIdConverter.isGroup(pattID)) {
+  unsigned char patt[ClusterPattern::MaxPatternBytes]; // only the first nBytes are filled
+  uint16_t pattID = CompCluster::InvalidPatternID;
+  if (nBits <= 8) { // small topology: the pattern is a single byte, resolved by the LUT
+    unsigned char pattByte = 0;
+    for (const auto& pix : pixbuf) {
+      pattByte |= 0x1 << (7 - ((pix.getRowDirect() - rowMin) * colSpanW + pix.getCol() - colMin));
+    }
+    patt[0] = pattByte;
+    if (useDict) {
+      pattID = pattIdConverter.findSmallGroupID(rowSpanW, colSpanW, pattByte);
+    }
+  } else {
+    std::memset(patt, 0, nBytes);
+    for (const auto& pix : pixbuf) {
+      unsigned short ir = pix.getRowDirect() - rowMin, ic = pix.getCol() - colMin;
+      int nbits = ir * colSpanW + ic;
+      patt[nbits >> 3] |= (0x1 << (7 - (nbits % 8)));
+    }
+    if (useDict) {
+      pattID = pattIdConverter.findGroupID(rowSpanW, colSpanW, patt);
+    }
+  }
+  if (pattID == CompCluster::InvalidPatternID || pattIdConverter.isGroup(pattID)) {
     if (pattID != CompCluster::InvalidPatternID) {
       //For groupped topologies, the reference pixel is the COG pixel
       float xCOG = 0., zCOG = 0.;
@@ -320,10 +347,6 @@ void Clusterer::ClustererThread::streamCluster(const std::vector<PixelData>& pix
     if (patternsPtr) {
       patternsPtr->emplace_back((unsigned char)rowSpanW);
       patternsPtr->emplace_back((unsigned char)colSpanW);
-      int nBytes = rowSpanW * colSpanW / 8;
-      if (((rowSpanW * colSpanW) % 8) != 0) {
-        nBytes++;
-      }
       patternsPtr->insert(patternsPtr->end(), std::begin(patt), std::begin(patt) + nBytes);
     }
   }
@@ -347,13 +370,12 @@ void Clusterer::ClustererThread::finishChipSingleHitFast(uint32_t hit, ChipPixel
     }
   }
 
-  // add to compact clusters, which must be always filled
-  unsigned char patt[ClusterPattern::MaxPatternBytes]{0x1 << (7 - (0 % 8))}; // unrolled 1 hit version of full loop in finishChip
-  uint16_t pattID = (parent->mPattIdConverter.size() == 0) ? CompCluster::InvalidPatternID : parent->mPattIdConverter.findGroupID(1, 1, patt);
+  // add to compact clusters, which must be always filled, the single pixel topology ID is cached by the LookUp
+  uint16_t pattID = (parent->mPattIdConverter.size() == 0) ? CompCluster::InvalidPatternID : parent->mPattIdConverter.getSinglePixelID();
   if ((pattID == CompCluster::InvalidPatternID || parent->mPattIdConverter.isGroup(pattID)) && patternsPtr) {
-    patternsPtr->emplace_back(1); // rowspan
-    patternsPtr->emplace_back(1); // colspan
-    patternsPtr->insert(patternsPtr->end(), std::begin(patt), std::begin(patt) + 1);
+    patternsPtr->emplace_back(1);        // rowspan
+    patternsPtr->emplace_back(1);        // colspan
+    patternsPtr->emplace_back(0x1 << 7); // pattern
   }
   compClusPtr->emplace_back(row, col, pattID, curChipData->getChipID());
 }
@@ -25,9 +25,13 @@ namespace o2
 namespace itsmft
 {
 
-LookUp::LookUp() : mDictionary{}, mTopologiesOverThreshold{0} {}
+LookUp::LookUp() : mDictionary{}, mTopologiesOverThreshold{0}
+{
+  mGroupIDs.fill(CompCluster::InvalidPatternID);
+  buildCommonTable();
+}
 
-LookUp::LookUp(std::string fileName)
+LookUp::LookUp(std::string fileName) : LookUp()
 {
   loadDictionary(fileName);
 }
@@ -36,6 +40,49 @@ void LookUp::loadDictionary(std::string fileName)
 {
   mDictionary.readBinaryFile(fileName);
   mTopologiesOverThreshold = mDictionary.mCommonMap.size();
+  // replace the maps of the dictionary by flat tables for the clusterization
+  mGroupIDs.fill(CompCluster::InvalidPatternID);
+  for (const auto& [group, id] : mDictionary.mGroupMap) {
+    if (group >= 0 && group < TopologyDictionary::NumberOfRareGroups) {
+      mGroupIDs[group] = id;
+    }
+  }
+  mIsGroup.resize(mDictionary.getSize());
+  for (int id = 0; id < mDictionary.getSize(); id++) {
+    mIsGroup[id] = mDictionary.isGroup(id);
+  }
+  buildCommonTable();
+  mSinglePixelID = mDictionary.getSize() ? findSmallGroupID(1, 1, 0x1 << 7) : -1;
+}
+
+void LookUp::buildCommonTable()
+{
+  // power of 2 size with at most 50% occupancy, so that probing sequences stay short
+  size_t tableSize = 2;
+  while (tableSize < 2 * mDictionary.mCommonMap.size()) {
+    tableSize <<= 1;
+  }
+  mCommonTable.assign(tableSize, {0, -1});
+  mCommonTableMask = tableSize - 1;
+  for (const auto& [hash, id] : mDictionary.mCommonMap) {
+    auto slot = (hash >> 32) & mCommonTableMask; // upper half of the hash is the MurMur2 hash of the pattern
+    while (mCommonTable[slot].second >= 0) {
+      slot = (slot + 1) & mCommonTableMask;
+    }
+    mCommonTable[slot] = {hash, id};
+  }
+}
+
+int LookUp::findCommonID(unsigned long hash) const
+{
+  auto slot = (hash >> 32) & mCommonTableMask;
+  while (mCommonTable[slot].second >= 0) {
+    if (mCommonTable[slot].first == hash) {
+      return mCommonTable[slot].second;
+    }
+    slot = (slot + 1) & mCommonTableMask;
+  }
+  return -1;
 }
 
 int LookUp::groupFinder(int nRow, int nCol)
@@ -57,34 +104,21 @@ int LookUp::groupFinder(int nRow, int nCol)
   return grNum;
 }
 
-int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes])
+int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]) const
 {
   int nBits = nRow * nCol;
   // Small topology
   if (nBits < 9) {
-    int ID = mDictionary.mSmallTopologiesLUT[(nCol - 1) * 255 + (int)patt[0]];
-    if (ID >= 0) {
-      return ID;
-    } else { //small rare topology (inside groups)
-      int index = groupFinder(nRow, nCol);
-      return mDictionary.mGroupMap[index];
-    }
+    return findSmallGroupID(nRow, nCol, patt[0]);
   }
   // Big topology
-  unsigned long hash = ClusterTopology::getCompleteHash(nRow, nCol, patt);
-  auto ret = mDictionary.mCommonMap.find(hash);
-  if (ret != mDictionary.mCommonMap.end()) {
-    return ret->second;
+  int id = findCommonID(ClusterTopology::getCompleteHash(nRow, nCol, patt));
+  if (id >= 0) {
+    return id;
   } else { // Big rare topology (inside groups)
-    int index = groupFinder(nRow, nCol);
-    return mDictionary.mGroupMap[index];
+    return mGroupIDs[groupFinder(nRow, nCol)];
   }
 }
 
-bool LookUp::isGroup(int id) const
-{
-  return mDictionary.isGroup(id);
-}
-
 } // namespace itsmft
 } // namespace o2
@@ -327,7 +327,7 @@ template <>
 ChipPixelData* RawPixelDecoder<ChipMappingMFT>::getNextChipData(std::vector<ChipPixelData>& chipDataVec)
 {
   if (!mOrderedChipsPtr.empty()) {
-    auto chipData = *mOrderedChipsPtr.back();
+    auto& chipData = *mOrderedChipsPtr.back();
     assert(mLastReadChipID < chipData.getChipID());
     mLastReadChipID = chipData.getChipID();
     chipDataVec[mLastReadChipID].swap(chipData);
@@ -346,7 +346,7 @@ template <>
 bool RawPixelDecoder<ChipMappingMFT>::getNextChipData(ChipPixelData& chipData)
 {
   if (!mOrderedChipsPtr.empty()) {
-    auto ruChip = *mOrderedChipsPtr.back();
+    auto& ruChip = *mOrderedChipsPtr.back();
     assert(mLastReadChipID < ruChip.getChipID());
     mLastReadChipID = ruChip.getChipID();
     ruChip.swap(chipData);
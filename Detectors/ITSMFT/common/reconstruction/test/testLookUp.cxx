@@ -0,0 +1,130 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test LookUp
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "ITSMFTReconstruction/BuildTopologyDictionary.h"
+#include "ITSMFTReconstruction/LookUp.h"
+#include "DataFormatsITSMFT/CompCluster.h"
+#include "DataFormatsITSMFT/TopologyDictionary.h"
+
+using namespace o2::itsmft;
+
+namespace
+{
+struct Topology {
+  int nRow = 0;
+  int nCol = 0;
+  std::array<unsigned char, ClusterPattern::MaxPatternBytes> patt{};
+};
+
+// random pattern filling its bounding box: the first and the last pixels are always fired
+Topology generateTopology(std::mt19937& gen, bool small)
+{
+  Topology t;
+  if (small) {
+    do {
+      t.nRow = 1 + gen() % 8;
+      t.nCol = 1 + gen() % 8;
+    } while (t.nRow * t.nCol > 8);
+  } else {
+    do {
+      t.nRow = 1 + gen() % 12;
+      t.nCol = 1 + gen() % 12;
+    } while (t.nRow * t.nCol < 9);
+  }
+  int nBits = t.nRow * t.nCol;
+  for (int i = 0; i < nBits; i++) {
+    if (i == 0 || i == nBits - 1 || gen() % 2) {
+      t.patt[i / 8] |= 0x1 << (7 - i % 8);
+    }
+  }
+  return t;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LookUpVsDictionaryMaps)
+{
+  // the dictionary is built from 3000 random topologies with decreasing frequencies, so that the most frequent
+  // ones, starting from the single pixel, are common and the others are grouped
+  constexpr int NTopologies = 3000;
+  std::mt19937 gen(12345);
+  std::vector<Topology> topologies;
+  BuildTopologyDictionary builder;
+  for (int i = 0; i < NTopologies; i++) {
+    const auto& t = topologies.emplace_back(i ? generateTopology(gen, i % 3 == 0) : Topology{1, 1, {0x1 << 7}});
+    ClusterTopology topology(t.nRow, t.nCol, t.patt.data());
+    for (int n = 1 + 2000 / (i + 1); n--;) {
+      builder.accountTopology(topology);
+    }
+  }
+  builder.setThreshold(0.0005);
+  builder.groupRareTopologies();
+  builder.printDictionaryBinary("testLookUp.bin");
+
+  LookUp lookUp("testLookUp.bin");
+  TopologyDictionary dict("testLookUp.bin");
+  BOOST_REQUIRE_GT(dict.getSize(), TopologyDictionary::NumberOfRareGroups);
+
+  // maps of the dictionary, built as in TopologyDictionary::readBinaryFile
+  std::unordered_map<unsigned long, int> commonMap;
+  std::unordered_map<int, int> groupMap;
+  for (int id = 0; id < dict.getSize(); id++) {
+    if (dict.isGroup(id)) {
+      groupMap.emplace(int(dict.getHash(id) >> 32), id);
+    } else {
+      commonMap.emplace(dict.getHash(id), id);
+    }
+  }
+  BOOST_CHECK_EQUAL(lookUp.size(), dict.getSize());
+
+  // topologies never accounted are always grouped
+  for (int i = 0; i < NTopologies; i++) {
+    topologies.emplace_back(generateTopology(gen, i % 3 == 0));
+  }
+
+  int nSmall = 0, nCommon = 0, nGrouped = 0;
+  for (const auto& t : topologies) {
+    int expected = CompCluster::InvalidPatternID;
+    auto common = commonMap.find(ClusterTopology::getCompleteHash(t.nRow, t.nCol, t.patt.data()));
+    if (common != commonMap.end()) {
+      expected = common->second;
+      nCommon++;
+    } else {
+      auto group = groupMap.find(LookUp::groupFinder(t.nRow, t.nCol));
+      if (group != groupMap.end()) {
+        expected = group->second;
+      }
+      nGrouped++;
+    }
+    auto id = lookUp.findGroupID(t.nRow, t.nCol, t.patt.data());
+    BOOST_CHECK_EQUAL(id, expected);
+    if (t.nRow * t.nCol < 9) {
+      BOOST_CHECK_EQUAL(lookUp.findSmallGroupID(t.nRow, t.nCol, t.patt[0]), expected);
+      nSmall++;
+    }
+    if (id >= 0) {
+      BOOST_CHECK_EQUAL(lookUp.isGroup(id), dict.isGroup(id));
+    }
+  }
+  BOOST_CHECK_GT(nSmall, 0);
+  BOOST_CHECK_GT(nCommon, 0);
+  BOOST_CHECK_GT(nGrouped, 0);
+
+  const auto& singlePixel = topologies.front();
+  BOOST_CHECK_EQUAL(lookUp.getSinglePixelID(), commonMap.at(ClusterTopology::getCompleteHash(1, 1, singlePixel.patt.data())));
+}
@@ -22,6 +22,7 @@
 #include "Framework/RawDeviceService.h"
 #include "Framework/DataSpecUtils.h"
 #include "Framework/DataInputDirector.h"
+#include "Framework/Expressions.h"
 #include "Framework/SourceInfoHeader.h"
 #include "Framework/ChannelInfo.h"
 #include "Framework/Logger.h"
@@ -39,7 +40,10 @@
 #include <arrow/table.h>
 #include <arrow/util/key_value_metadata.h>
 
+#include <algorithm>
+#include <sstream>
 #include <thread>
+#include <unordered_map>
 
 using namespace o2;
 using namespace o2::aod;
@@ -87,19 +91,42 @@ struct RuntimeWatchdog {
   }
 };
 
-template <typename... C>
-static constexpr auto columnNamesTrait(framework::pack<C...>)
+// The columns of table @a dh used by the workflow, all of them if empty
+std::vector<std::string> getColumnNames(header::DataHeader dh, std::unordered_map<std::string, std::vector<std::string>> const& columns)
 {
-  return std::vector<std::string>{C::columnLabel()...};
+  auto table = dh.dataOrigin.as<std::string>() + "/" + dh.dataDescription.as<std::string>();
+  auto tableColumns = columns.find(table);
+  if (tableColumns == columns.end()) {
+    return {};
+  }
+  return tableColumns->second;
 }
 
-std::vector<std::string> getColumnNames(header::DataHeader dh)
-{
-  auto description = std::string(dh.dataDescription.str);
-  auto origin = std::string(dh.dataOrigin.str);
+struct TableFilter {
+  header::DataHeader dh;
+  std::shared_ptr<framework::expressions::Node> predicate;
+};
 
-  // default: column names = {}
-  return std::vector<std::string>({});
+// Whether some row of the filtered tables of time frame @a ntf of file
+// @a fcnt may pass their filters, according to the ranges of the values
+// of the columns recorded by the writer. Tables without ranges may pass.
+bool timeFrameMayPass(framework::DataInputDirector& didir, std::vector<TableFilter> const& filters, int fcnt, int ntf)
+{
+  for (auto& filter : filters) {
+    auto parameters = didir.getTreeParameters(filter.dh, fcnt, ntf);
+    auto ranges = [&parameters](std::string const& column) -> std::optional<framework::expressions::ColumnRange> {
+      auto min = parameters.find("min:" + column);
+      auto max = parameters.find("max:" + column);
+      if (min == parameters.end() || max == parameters.end()) {
+        return std::nullopt;
+      }
+      return framework::expressions::ColumnRange{min->second, max->second};
+    };
+    if (!framework::expressions::mayPass(*filter.predicate, ranges)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 using o2::monitoring::Metric;
@@ -194,12 +221,72 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
       }
     }
 
+    // columns actually used by the workflow and range predicates of the
+    // filters applied to them, for each table, and schema hashes of the
+    // stored index tables
+    std::unordered_map<std::string, std::vector<std::string>> columns;
+    std::unordered_map<std::string, std::string> predicates;
+    std::unordered_map<std::string, uint32_t> indices;
+    for (auto& route : spec.inputs) {
+      for (auto& metadata : route.matcher.metadata) {
+        if (metadata.name.rfind("columns:", 0) == 0) {
+          std::stringstream labels(metadata.defaultValue.get<std::string>());
+          for (std::string label; std::getline(labels, label, ',');) {
+            columns[metadata.name.substr(8)].push_back(label);
+          }
+        } else if (metadata.name.rfind("filter:", 0) == 0) {
+          predicates[metadata.name.substr(7)] = metadata.defaultValue.get<std::string>();
+        } else if (metadata.name.rfind("index:", 0) == 0) {
+          indices[metadata.name.substr(6)] = static_cast<uint32_t>(metadata.defaultValue.get<int64_t>());
+        }
+      }
+    }
+
+    // the stored indices are optional, they are read after the tables which
+    // decide when to move to the next file
+    auto tableName = [](OutputRoute const& route) {
+      auto concrete = DataSpecUtils::asConcreteDataMatcher(route.matcher);
+      return concrete.origin.as<std::string>() + "/" + concrete.description.as<std::string>();
+    };
+    std::stable_partition(requestedTables.begin(), requestedTables.end(), [&](OutputRoute const& route) { return indices.count(tableName(route)) == 0; });
+
+    // the time frames in which no row of a filtered table can pass are skipped
+    std::vector<TableFilter> filters;
+    if (options.get<bool>("aod-skip-filtered-dfs")) {
+      for (auto& route : requestedTables) {
+        auto concrete = DataSpecUtils::asConcreteDataMatcher(route.matcher);
+        auto dh = header::DataHeader(concrete.description, concrete.origin, concrete.subSpec);
+        auto predicate = predicates.find(concrete.origin.as<std::string>() + "/" + concrete.description.as<std::string>());
+        if (predicate != predicates.end()) {
+          LOGP(INFO, "Skipping the time frames in which no row of {} passes {}", concrete.description.as<std::string>(), predicate->second);
+          filters.push_back(TableFilter{dh, std::make_shared<expressions::Node>(expressions::parseRangePredicate(predicate->second))});
+        }
+      }
+    }
+
+    // open the next file and preload its first time frames on a background
+    // thread, while the current one is read
+    auto prefetchFolders = options.get<int>("aod-prefetch-folders");
+    if (prefetchFolders > 0) {
+      for (auto& route : requestedTables) {
+        auto concrete = DataSpecUtils::asConcreteDataMatcher(route.matcher);
+        auto dh = header::DataHeader(concrete.description, concrete.origin, concrete.subSpec);
+        didir->addPrefetchedTable(dh, getColumnNames(dh, columns));
+      }
+      didir->setPrefetching(prefetchFolders, options.get<int64_t>("aod-prefetch-memory") * 1024 * 1024, spec.maxInputTimeslices);
+    }
+
     auto fileCounter = std::make_shared<int>(0);
     auto numTF = std::make_shared<int>(-1);
+    auto dfsSkipped = std::make_shared<uint64_t>(0);
     return adaptStateless([TFNumberHeader,
                            requestedTables,
+                           columns,
+                           indices,
+                           filters,
                            fileCounter,
                            numTF,
+                           dfsSkipped,
                            watchdog,
                            didir](Monitoring& monitoring, DataAllocator& outputs, ControlService& control, DeviceSpec const& device) {
       // Each parallel reader device.inputTimesliceId reads the files fileCounter*device.maxInputTimeslices+device.inputTimesliceId
@@ -238,42 +325,70 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
 
       auto ioStart = uv_hrtime();
 
+      // skip the time frames of file fcnt, starting from ntf, in which no
+      // row can pass the filters. At the end of the file ntf is left past
+      // its last time frame.
+      auto skipFilteredTimeFrames = [&]() {
+        if (filters.empty()) {
+          return;
+        }
+        auto skipped = *dfsSkipped;
+        while (!timeFrameMayPass(*didir, filters, fcnt, ntf)) {
+          ++ntf;
+          ++(*dfsSkipped);
+        }
+        if (*dfsSkipped != skipped) {
+          monitoring.send(Metric{*dfsSkipped, "aod-dfs-skipped"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
+        }
+      };
+      skipFilteredTimeFrames();
+
       for (auto route : requestedTables) {
 
         // create header
         auto concrete = DataSpecUtils::asConcreteDataMatcher(route.matcher);
         auto dh = header::DataHeader(concrete.description, concrete.origin, concrete.subSpec);
 
+        // a stored index is only sent if it was saved with the expected
+        // schema, otherwise the index builder gets an empty table
+        auto index = indices.find(concrete.origin.as<std::string>() + "/" + concrete.description.as<std::string>());
+        if (!first && index != indices.end()) {
+          auto parameters = didir->getTreeParameters(dh, fcnt, ntf);
+          auto hash = parameters.find("schema-hash");
+          if (hash == parameters.end() || static_cast<uint32_t>(hash->second) != index->second) {
+            outputs.adopt(Output(dh), arrow::Table::Make(arrow::schema({}), std::vector<std::shared_ptr<arrow::ChunkedArray>>{}, 0));
+            continue;
+          }
+        }
+
         // create a TreeToTable object
         TTree* tr = didir->getDataTree(dh, fcnt, ntf);
-        if (!tr) {
-          if (first) {
-            // dump metrics of file which is done for reading
-            dumpFileMetrics(monitoring, currentFile, currentFileStartedAt, currentFileIOTime, tfCurrentFile, ntf);
-            currentFile = nullptr;
-            currentFileStartedAt = uv_hrtime();
-            currentFileIOTime = 0;
-
-            // check if there is a next file to read
-            fcnt += device.maxInputTimeslices;
-            if (didir->atEnd(fcnt)) {
-              LOGP(INFO, "No input files left to read for reader {}!", device.inputTimesliceId);
-              didir->closeInputFiles();
-              control.endOfStream();
-              control.readyToQuit(QuitRequest::Me);
-              return;
-            }
-            // get first folder of next file
-            ntf = 0;
-            tr = didir->getDataTree(dh, fcnt, ntf);
-            if (!tr) {
-              LOGP(FATAL, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", concrete.origin, fcnt, ntf);
-              throw std::runtime_error("Processing is stopped!");
-            }
-          } else {
-            LOGP(FATAL, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", concrete.origin, fcnt, ntf);
-            throw std::runtime_error("Processing is stopped!");
+        if (!tr && !first) {
+          LOGP(FATAL, "Can not retrieve tree for table {}: fileCounter {}, timeFrame {}", concrete.origin, fcnt, ntf);
+          throw std::runtime_error("Processing is stopped!");
+        }
+        // move on to the next file, and past it if none of its time
+        // frames can pass the filters
+        while (!tr) {
+          // dump metrics of file which is done for reading
+          dumpFileMetrics(monitoring, currentFile, currentFileStartedAt, currentFileIOTime, tfCurrentFile, ntf);
+          currentFile = nullptr;
+          currentFileStartedAt = uv_hrtime();
+          currentFileIOTime = 0;
+
+          // check if there is a next file to read
+          fcnt += device.maxInputTimeslices;
+          if (didir->atEnd(fcnt)) {
+            LOGP(INFO, "No input files left to read for reader {}!", device.inputTimesliceId);
+            didir->closeInputFiles();
+            control.endOfStream();
+            control.readyToQuit(QuitRequest::Me);
+            return;
           }
+          // get first folder of next file which may pass the filters
+          ntf = 0;
+          skipFilteredTimeFrames();
+          tr = didir->getDataTree(dh, fcnt, ntf);
         }
 
         if (first) {
@@ -288,7 +403,7 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
 
         // add branches to read
         // fill the table
-        auto colnames = getColumnNames(dh);
+        auto colnames = getColumnNames(dh, columns);
         t2t.setLabel(tr->GetName());
         if (colnames.size() == 0) {
           totalSizeCompressed += tr->GetZipBytes();
@@ -297,6 +412,11 @@ AlgorithmSpec AODJAlienReaderHelpers::rootFileReaderCallback()
         } else {
           for (auto& colname : colnames) {
             TBranch* branch = tr->GetBranch(colname.c_str());
+            if (branch == nullptr) {
+              // not all the versions of the data model have all the columns
+              LOGP(DEBUG, "Column {} not found in tree {}", colname, tr->GetName());
+              continue;
+            }
             totalSizeCompressed += branch->GetZipBytes("*");
             totalSizeUncompressed += branch->GetTotBytes("*");
             t2t.addColumn(colname.c_str());
@@ -15,6 +15,7 @@
 #include "Framework/TableBuilder.h"
 #include "Framework/AlgorithmSpec.h"
 #include "Framework/Logger.h"
+#include "Headers/DataHeader.h"
 #include <uv.h>
 
 namespace o2::framework::readers
@@ -25,6 +26,9 @@ struct AODReaderHelpers {
   static AlgorithmSpec rootFileReaderCallback();
   static AlgorithmSpec aodSpawnerCallback(std::vector<InputSpec> requested);
   static AlgorithmSpec indexBuilderCallback(std::vector<InputSpec> requested);
+  /// @return the hash of the schema of the index table with @a description,
+  /// which must match the one stored with a saved index for it to be reused
+  static uint32_t indexSchemaHash(header::DataDescription description);
 };
 
 } // namespace o2::framework::readers
@@ -39,6 +39,15 @@ auto createSchemaFromColumns(framework::pack<C...>)
 }
 using SelectionVector = std::vector<int64_t>;
 
+/// Union and intersection of sorted selections. Contiguous selections are
+/// handled as row ranges and dense ones as bitmaps, the others with the
+/// set algorithms.
+SelectionVector selectionUnion(SelectionVector const& a, SelectionVector const& b);
+SelectionVector selectionIntersection(SelectionVector const& a, SelectionVector const& b);
+
+/// Rows selected by a gandiva selection vector, copied in bulk.
+SelectionVector selectedRows(gandiva::SelectionVector const& selection);
+
 template <typename, typename = void>
 constexpr bool is_index_column_v = false;
 
@@ -69,6 +78,12 @@ constexpr bool is_type_with_binding_v = false;
 template <typename T>
 constexpr bool is_type_with_binding_v<T, std::void_t<decltype(sizeof(typename T::binding_t))>> = true;
 
+template <typename, typename = void>
+constexpr bool is_type_with_base_table_v = false;
+
+template <typename T>
+constexpr bool is_type_with_base_table_v<T, std::void_t<decltype(sizeof(typename T::base_table_t))>> = true;
+
 template <typename, typename = void>
 constexpr bool is_type_spawnable_v = false;
 
@@ -139,6 +154,10 @@ struct Flat {
   constexpr static bool chunked = false;
 };
 
+/// Error raised when accessing a column which is not in the table, e.g.
+/// because it was not read from the input, as the workflow does not need it.
+void missingColumn();
+
 /// Iterator on a single column.
 /// FIXME: the ChunkingPolicy for now is fixed to Flat and is a mere boolean
 /// which is used to switch off slow "chunking aware" parts. This is ok for
@@ -159,6 +178,13 @@ class ColumnIterator : ChunkingPolicy
       mFirstIndex{0},
       mCurrentChunk{0}
   {
+    // A column missing from the table stays unbound: accessing it moves to
+    // the next chunk, which fails.
+    if (O2_BUILTIN_UNLIKELY(column == nullptr)) {
+      mCurrent = nullptr;
+      mLast = nullptr;
+      return;
+    }
     auto array = getCurrentArray();
     mCurrent = reinterpret_cast<T const*>(array->values()->data()) + array->offset();
     mLast = mCurrent + array->length();
@@ -174,6 +200,9 @@ class ColumnIterator : ChunkingPolicy
   /// Move the iterator to the next chunk.
   void nextChunk() const
   {
+    if (O2_BUILTIN_UNLIKELY(mColumn == nullptr)) {
+      missingColumn();
+    }
     auto previousArray = getCurrentArray();
     mFirstIndex += previousArray->length();
 
@@ -185,6 +214,9 @@ class ColumnIterator : ChunkingPolicy
 
   void prevChunk() const
   {
+    if (O2_BUILTIN_UNLIKELY(mColumn == nullptr)) {
+      missingColumn();
+    }
     auto previousArray = getCurrentArray();
     mFirstIndex -= previousArray->length();
 
@@ -210,6 +242,9 @@ class ColumnIterator : ChunkingPolicy
   /// Move the iterator to the end of the column.
   void moveToEnd()
   {
+    if (mColumn == nullptr) {
+      return;
+    }
     mCurrentChunk = mColumn->num_chunks() - 1;
     auto array = getCurrentArray();
     mFirstIndex = mColumn->length() - array->length();
@@ -521,10 +556,13 @@ struct FilteredIndexPolicy : IndexPolicyBase {
   // which happens below which will properly setup the first index
   // by remapping the filtered index 0 to whatever unfiltered index
   // it belongs to.
-  FilteredIndexPolicy(SelectionVector selection, uint64_t offset = 0)
+  // The selection is not copied, it is shared with the Filtered table
+  // the iterator belongs to and kept alive by the iterator.
+  FilteredIndexPolicy(std::shared_ptr<SelectionVector const> selection, uint64_t offset = 0)
     : IndexPolicyBase{-1, offset},
-      mSelectedRows(selection),
-      mMaxSelection(selection.size())
+      mSelection(std::move(selection)),
+      mSelectedRows(mSelection->data()),
+      mMaxSelection(mSelection->size())
   {
     this->setCursor(0);
   }
@@ -615,7 +653,8 @@ struct FilteredIndexPolicy : IndexPolicyBase {
     //  (mSelectionRow < mMaxSelection ? mSelectedRows[mSelectionRow] : -1)
     //  : mSelectionRow;
   }
-  SelectionVector mSelectedRows;
+  std::shared_ptr<SelectionVector const> mSelection;
+  int64_t const* mSelectedRows = nullptr;
   int64_t mSelectionRow = 0;
   int64_t mMaxSelection = 0;
 };
@@ -888,6 +927,7 @@ auto sliceBy(T const& t, framework::expressions::BindingNode const& node, int va
   O2_BUILTIN_UNREACHABLE();
 }
 
+/// The column @a label of @a table, nullptr if there is none.
 arrow::ChunkedArray* getIndexFromLabel(arrow::Table* table, const char* label);
 
 /// A Table class which observes an arrow::Table and provides
@@ -1036,13 +1076,11 @@ class Table
     return RowViewSentinel{mEnd};
   }
 
-  filtered_iterator filtered_begin(SelectionVector selection)
+  filtered_iterator filtered_begin(std::shared_ptr<SelectionVector const> selection)
   {
-    // Note that the FilteredIndexPolicy will never outlive the selection which
-    // is held by the table, so we are safe passing the bare pointer. If it does it
-    // means that the iterator on a table is outliving the table itself, which is
-    // a bad idea.
-    return filtered_iterator(mColumnChunks, {selection, mOffset});
+    // The FilteredIndexPolicy shares the ownership of the selection, so that iterators
+    // stay valid when they outlive a temporary filtered table, e.g. in combinations.
+    return filtered_iterator(mColumnChunks, {std::move(selection), mOffset});
   }
 
   iterator iteratorAt(uint64_t i) const
@@ -1838,23 +1876,23 @@ class FilteredPolicy : public T
 
   FilteredPolicy(std::vector<std::shared_ptr<arrow::Table>>&& tables, SelectionVector&& selection, uint64_t offset = 0)
     : T{std::move(tables), offset},
-      mSelectedRows{std::forward<SelectionVector>(selection)}
+      mSelectedRows{std::make_shared<SelectionVector const>(std::forward<SelectionVector>(selection))}
   {
     resetRanges();
   }
 
   FilteredPolicy(std::vector<std::shared_ptr<arrow::Table>>&& tables, framework::expressions::Selection selection, uint64_t offset = 0)
     : T{std::move(tables), offset},
-      mSelectedRows{copySelection(selection)}
+      mSelectedRows{std::make_shared<SelectionVector const>(copySelection(selection))}
   {
     resetRanges();
   }
 
   FilteredPolicy(std::vector<std::shared_ptr<arrow::Table>>&& tables, gandiva::NodePtr const& tree, uint64_t offset = 0)
     : T{std::move(tables), offset},
-      mSelectedRows{copySelection(framework::expressions::createSelection(this->asArrowTable(),
-                                                                          framework::expressions::createFilter(this->asArrowTable()->schema(),
-                                                                                                               framework::expressions::makeCondition(tree))))}
+      mSelectedRows{std::make_shared<SelectionVector const>(copySelection(framework::expressions::createSelection(this->asArrowTable(),
+                                                                                                                 framework::expressions::createFilter(this->asArrowTable()->schema(),
+                                                                                                                                                      framework::expressions::makeCondition(tree)))))}
   {
     resetRanges();
   }
@@ -1886,7 +1924,7 @@ class FilteredPolicy : public T
 
   int64_t size() const
   {
-    return mSelectedRows.size();
+    return mSelectedRows->size();
   }
 
   int64_t tableSize() const
@@ -1896,16 +1934,12 @@ class FilteredPolicy : public T
 
   SelectionVector const& getSelectedRows() const
   {
-    return mSelectedRows;
+    return *mSelectedRows;
   }
 
   static inline SelectionVector copySelection(framework::expressions::Selection const& sel)
   {
-    SelectionVector rows;
-    for (auto i = 0; i < sel->GetNumSlots(); ++i) {
-      rows.push_back(sel->GetIndex(i));
-    }
-    return rows;
+    return selectedRows(*sel);
   }
 
   /// Bind the columns which refer to other tables
@@ -1936,8 +1970,8 @@ class FilteredPolicy : public T
 
   auto slice(uint64_t start, uint64_t end)
   {
-    auto start_iterator = std::lower_bound(mSelectedRows.begin(), mSelectedRows.end(), start);
-    auto stop_iterator = std::lower_bound(start_iterator, mSelectedRows.end(), end);
+    auto start_iterator = std::lower_bound(mSelectedRows->begin(), mSelectedRows->end(), start);
+    auto stop_iterator = std::lower_bound(start_iterator, mSelectedRows->end(), end);
     SelectionVector slicedSelection{start_iterator, stop_iterator};
     std::transform(slicedSelection.begin(), slicedSelection.end(), slicedSelection.begin(),
                    [&](int64_t idx) {
@@ -1949,24 +1983,20 @@ class FilteredPolicy : public T
  protected:
   void sumWithSelection(SelectionVector const& selection)
   {
-    SelectionVector rowsUnion;
-    std::set_union(mSelectedRows.begin(), mSelectedRows.end(), selection.begin(), selection.end(), std::back_inserter(rowsUnion));
-    mSelectedRows = rowsUnion;
+    mSelectedRows = std::make_shared<SelectionVector const>(selectionUnion(*mSelectedRows, selection));
     resetRanges();
   }
 
   void intersectWithSelection(SelectionVector const& selection)
   {
-    SelectionVector intersection;
-    std::set_intersection(mSelectedRows.begin(), mSelectedRows.end(), selection.begin(), selection.end(), std::back_inserter(intersection));
-    mSelectedRows = intersection;
+    mSelectedRows = std::make_shared<SelectionVector const>(selectionIntersection(*mSelectedRows, selection));
     resetRanges();
   }
 
  private:
   void resetRanges()
   {
-    mFilteredEnd.reset(new RowViewSentinel{mSelectedRows.size()});
+    mFilteredEnd.reset(new RowViewSentinel{mSelectedRows->size()});
     if (tableSize() == 0) {
       mFilteredBegin = *mFilteredEnd;
     } else {
@@ -1974,7 +2004,7 @@ class FilteredPolicy : public T
     }
   }
 
-  SelectionVector mSelectedRows;
+  std::shared_ptr<SelectionVector const> mSelectedRows; // shared with the iterators, never modified in place
   iterator mFilteredBegin;
   std::shared_ptr<RowViewSentinel> mFilteredEnd;
 };
@@ -20,6 +20,10 @@
 #include "Framework/OutputObjHeader.h"
 #include "Framework/StringHelpers.h"
 #include "Framework/Output.h"
+#include "Framework/ProcessingPool.h"
+#include "Framework/RuntimeError.h"
+#include <functional>
+#include <set>
 #include <string>
 #include "Framework/Logger.h"
 
@@ -43,6 +47,10 @@ struct WritingCursor<soa::Table<PC...>> {
   void operator()(T... args)
   {
     static_assert(sizeof...(PC) == sizeof...(T), "Argument number mismatch");
+    if (O2_BUILTIN_UNLIKELY(!mChunks.empty())) {
+      mChunks[ProcessingSlot::current().chunk].emplace_back(buffer<typename PC::type>(extract(args))...);
+      return;
+    }
     ++mCount;
     cursor(0, extract(args)...);
   }
@@ -50,9 +58,32 @@ struct WritingCursor<soa::Table<PC...>> {
   /// Last index inserted in the table
   int64_t lastIndex()
   {
+    if (O2_BUILTIN_UNLIKELY(!mChunks.empty())) {
+      throw runtime_error("The index of the last row is not known while processing in parallel");
+    }
     return mCount;
   }
 
+  /// Keep the rows written during a parallel processing of @a nChunks
+  /// chunks aside, one buffer per chunk, rather than in the table.
+  void beginParallel(int nChunks)
+  {
+    mChunks.resize(nChunks);
+  }
+
+  /// Write the rows kept aside to the table, in the order of the chunks.
+  void endParallel()
+  {
+    auto chunks = std::move(mChunks);
+    mChunks.clear();
+    for (auto& rows : chunks) {
+      for (auto& row : rows) {
+        ++mCount;
+        std::apply([this](auto&... values) { cursor(0, unbuffer(values)...); }, row);
+      }
+    }
+  }
+
   bool resetCursor(TableBuilder& builder)
   {
     mBuilder = &builder;
@@ -87,11 +118,41 @@ struct WritingCursor<soa::Table<PC...>> {
     }
   }
 
+  /// Arrays are copied, as the arguments might not outlive the parallel processing.
+  template <typename T>
+  using buffered_t = std::conditional_t<std::is_array_v<T>, std::array<std::remove_extent_t<T>, std::extent_v<T>>, T>;
+
+  template <typename T, typename A>
+  static buffered_t<T> buffer(A const& arg)
+  {
+    if constexpr (std::is_array_v<T>) {
+      buffered_t<T> values;
+      std::copy(arg, arg + std::extent_v<T>, values.begin());
+      return values;
+    } else {
+      return arg;
+    }
+  }
+
+  template <typename T, size_t N>
+  static T* unbuffer(std::array<T, N>& values)
+  {
+    return values.data();
+  }
+
+  template <typename T>
+  static T& unbuffer(T& value)
+  {
+    return value;
+  }
+
   /// The table builder which actually performs the
   /// construction of the table. We keep it around to be
   /// able to do all-columns methods like reserve.
   TableBuilder* mBuilder = nullptr;
   int64_t mCount = -1;
+  /// Rows written by each chunk of a parallel processing
+  std::vector<std::vector<std::tuple<buffered_t<typename PC::type>...>>> mChunks;
 };
 
 template <typename T>
@@ -120,6 +181,68 @@ struct Produces<soa::Table<C...>> : WritingCursor<typename soa::PackToTable<type
   }
 };
 
+template <typename... C>
+std::string columnLabels(framework::pack<C...>)
+{
+  std::string labels;
+  ((labels += (labels.empty() ? "" : ",") + std::string{C::columnLabel()}), ...);
+  return labels;
+}
+
+/// Input metadata with the columns of the base table used by the expression
+/// columns @a C, i.e. the ones needed to spawn them.
+template <typename... C>
+ConfigParamSpec aodExpressionColumnsSpec(framework::pack<C...>)
+{
+  std::set<std::string> labels;
+  (labels.merge(expressions::getColumnLabels(C::Projector())), ...);
+  std::string joined;
+  for (auto& label : labels) {
+    joined += (joined.empty() ? "" : ",") + label;
+  }
+  return ConfigParamSpec{"aod-columns", VariantType::String, joined, {"\"\""}};
+}
+
+/// Input metadata with the columns the reader has to provide for table T.
+/// Extension tables only need the columns used by their expressions.
+template <typename T>
+ConfigParamSpec aodColumnsSpec()
+{
+  using metadata = typename aod::MetadataTrait<T>::metadata;
+  if constexpr (soa::is_type_with_base_table_v<metadata>) {
+    return aodExpressionColumnsSpec(typename metadata::expression_pack_t{});
+  } else {
+    return ConfigParamSpec{"aod-columns", VariantType::String, columnLabels(typename T::persistent_columns_t{}), {"\"\""}};
+  }
+}
+
+/// Input metadata with the columns the index builder needs from the source T
+/// of an index on Key: the index to Key, or, for Key itself, a single column
+/// giving its number of rows.
+template <typename Key, typename T>
+ConfigParamSpec aodIndexColumnsSpec()
+{
+  using metadata = typename aod::MetadataTrait<T>::metadata;
+  using bindings_t = decltype(soa::extractBindings(typename T::external_index_columns_t{}));
+  if constexpr (soa::is_type_with_base_table_v<metadata>) {
+    return aodColumnsSpec<T>();
+  } else if constexpr (framework::has_type_v<T, soa::originals_pack_t<Key>>) {
+    using first_t = framework::pack_head_t<typename T::persistent_columns_t>;
+    return ConfigParamSpec{"aod-columns", VariantType::String, std::string{first_t::columnLabel()}, {"\"\""}};
+  } else if constexpr (framework::has_type_v<Key, bindings_t>) {
+    using index_t = framework::pack_element_t<framework::has_type_at_v<Key>(bindings_t{}), typename T::external_index_columns_t>;
+    return ConfigParamSpec{"aod-columns", VariantType::String, std::string{index_t::columnLabel()}, {"\"\""}};
+  } else {
+    return aodColumnsSpec<T>();
+  }
+}
+
+/// Replace the "aod-filter" metadata of the inputs of the filtered arguments,
+/// which refers to the argument, with the range predicate of its filters.
+/// Inputs which are also used unfiltered, or whose filters cannot be
+/// expressed as ranges, are left without predicate.
+void setFilterPredicates(std::vector<InputSpec>& inputs, std::vector<std::string> const& predicates);
+
 /// Helper template for table transformations
 template <typename METADATA>
 struct TableTransform {
@@ -140,13 +263,15 @@ struct TableTransform {
   }
 
   template <typename Oi>
-  constexpr auto base_spec() const
+  constexpr auto base_spec(ConfigParamSpec columns = aodColumnsSpec<Oi>()) const
   {
     using o_metadata = typename aod::MetadataTrait<Oi>::metadata;
     return InputSpec{
       o_metadata::tableLabel(),
       header::DataOrigin{o_metadata::origin()},
-      header::DataDescription{o_metadata::description()}};
+      header::DataDescription{o_metadata::description()},
+      Lifetime::Timeframe,
+      {columns}};
   }
 
   template <typename... Os>
@@ -189,6 +314,18 @@ struct Spawns : TableTransform<typename aod::MetadataTrait<framework::pack_head_
     return expression_pack_t{};
   }
 
+  /// The base table is read only for the columns used by the expressions.
+  template <typename... Os>
+  std::vector<InputSpec> base_specs_impl(framework::pack<Os...>) const
+  {
+    return {this->template base_spec<Os>(aodExpressionColumnsSpec(expression_pack_t{}))...};
+  }
+
+  std::vector<InputSpec> base_specs() const
+  {
+    return base_specs_impl(this->sources_pack());
+  }
+
   T* operator->()
   {
     return table.get();
@@ -206,67 +343,86 @@ struct Spawns : TableTransform<typename aod::MetadataTrait<framework::pack_head_
   std::shared_ptr<extension_t> extension = nullptr;
 };
 
+/// Keys of the rows of a table, i.e. their index to Key, the rows of Key
+/// itself being their own keys, and the global indices of the rows.
+template <typename Key, typename T>
+void getIndexKeys(T& table, std::vector<int32_t>& keys, std::vector<int32_t>& rows)
+{
+  keys.reserve(table.size());
+  rows.reserve(table.size());
+  for (auto& row : table) {
+    rows.push_back(row.globalIndex());
+    if constexpr (std::is_same_v<std::decay_t<T>, Key>) {
+      keys.push_back(row.globalIndex());
+    } else {
+      keys.push_back(row.template getId<Key>());
+    }
+  }
+}
+
+/// For each of @a keys, the global index of the row of another table with the
+/// same key, or -1. The n-th occurrence of a key is matched to the n-th row
+/// with this key, negative keys are never matched.
+void matchIndexKeys(std::vector<int32_t> const& keys, std::vector<int32_t> const& sourceKeys, std::vector<int32_t> const& sourceRows, std::vector<int32_t>& matches);
+
+/// The rows of the first table and, for each of the other tables, the rows
+/// matched to them. Each table is read, and then matched, by a separate job,
+/// which are run by the threads of the pool if one is given.
+template <typename Key, typename... T>
+auto matchIndexTables(std::tuple<T...>& tables, ProcessingPool* pool)
+{
+  constexpr size_t nSources = sizeof...(T) - 1;
+  std::vector<int32_t> firstKeys;
+  std::vector<int32_t> firstRows;
+  std::array<std::vector<int32_t>, nSources> keys;
+  std::array<std::vector<int32_t>, nSources> rows;
+  std::array<std::vector<int32_t>, nSources> matches;
+
+  auto run = [pool](std::vector<std::function<void()>> const& jobs) {
+    if (pool != nullptr) {
+      pool->run(jobs.size(), [&jobs](int job) { jobs[job](); });
+    } else {
+      for (auto& job : jobs) {
+        job();
+      }
+    }
+  };
+
+  std::vector<std::function<void()>> readers;
+  std::apply(
+    [&](auto& first, auto&... sources) {
+      readers.emplace_back([&]() { getIndexKeys<Key>(first, firstKeys, firstRows); });
+      size_t source = 0;
+      ((readers.emplace_back([&keys, &rows, &sources, source]() { getIndexKeys<Key>(sources, keys[source], rows[source]); }), ++source), ...);
+    },
+    tables);
+  run(readers);
+
+  std::vector<std::function<void()>> matchers;
+  for (size_t source = 0; source < nSources; ++source) {
+    matchers.emplace_back([&, source]() { matchIndexKeys(firstKeys, keys[source], rows[source], matches[source]); });
+  }
+  run(matchers);
+
+  return std::make_pair(std::move(firstRows), std::move(matches));
+}
+
 /// Policy to control index building
 /// Exclusive index: each entry in a row has a valid index
 struct IndexExclusive {
   /// Generic builder for in index table
   template <typename... Cs, typename Key, typename T1, typename... T>
-  static auto indexBuilder(const char* label, framework::pack<Cs...>, Key const&, std::tuple<T1, T...> tables)
+  static auto indexBuilder(const char* label, framework::pack<Cs...>, Key const&, std::tuple<T1, T...> tables, ProcessingPool* pool = nullptr)
   {
     static_assert(sizeof...(Cs) == sizeof...(T) + 1, "Number of columns does not coincide with number of supplied tables");
     using tables_t = framework::pack<T...>;
-    using first_t = T1;
-    auto tail = tuple_tail(tables);
     TableBuilder builder;
     auto cursor = framework::FFL(builder.cursor<o2::soa::Table<Cs...>>());
 
-    std::array<int32_t, sizeof...(T)> values;
-    iterator_tuple_t<std::decay_t<T>...> iterators = std::apply(
-      [](auto&&... x) {
-        return std::make_tuple(x.begin()...);
-      },
-      tail);
-
-    using rest_it_t = decltype(pack_from_tuple(iterators));
-
-    int32_t idx = -1;
-    auto setValue = [&](auto& x) -> bool {
-      using type = std::decay_t<decltype(x)>;
-      constexpr auto position = framework::has_type_at_v<type>(rest_it_t{});
-
-      lowerBound<Key>(idx, x);
-      if (x == soa::RowViewSentinel{static_cast<uint64_t>(x.mMaxRow)}) {
-        return false;
-      } else if (x.template getId<Key>() != idx) {
-        return false;
-      } else {
-        values[position] = x.globalIndex();
-        ++x;
-        return true;
-      }
-    };
-
-    auto first = std::get<first_t>(tables);
-    for (auto& row : first) {
-      idx = row.template getId<Key>();
-
-      if (std::apply(
-            [](auto&... x) {
-              return ((x == soa::RowViewSentinel{static_cast<uint64_t>(x.mMaxRow)}) && ...);
-            },
-            iterators)) {
-        break;
-      }
-
-      auto result = std::apply(
-        [&](auto&... x) {
-          std::array<bool, sizeof...(T)> results{setValue(x)...};
-          return (results[framework::has_type_at_v<std::decay_t<decltype(x)>>(rest_it_t{})] && ...);
-        },
-        iterators);
-
-      if (result) {
-        cursor(0, row.globalIndex(), values[framework::has_type_at_v<T>(tables_t{})]...);
+    auto [rows, values] = matchIndexTables<Key>(tables, pool);
+    for (auto i = 0u; i < rows.size(); ++i) {
+      if (((values[framework::has_type_at_v<T>(tables_t{})][i] >= 0) && ...)) {
+        cursor(0, rows[i], values[framework::has_type_at_v<T>(tables_t{})][i]...);
       }
     }
     builder.setLabel(label);
@@ -277,63 +433,16 @@ struct IndexExclusive {
 /// to T1
 struct IndexSparse {
   template <typename... Cs, typename Key, typename T1, typename... T>
-  static auto indexBuilder(const char* label, framework::pack<Cs...>, Key const&, std::tuple<T1, T...> tables)
+  static auto indexBuilder(const char* label, framework::pack<Cs...>, Key const&, std::tuple<T1, T...> tables, ProcessingPool* pool = nullptr)
   {
     static_assert(sizeof...(Cs) == sizeof...(T) + 1, "Number of columns does not coincide with number of supplied tables");
     using tables_t = framework::pack<T...>;
-    using first_t = T1;
-    auto tail = tuple_tail(tables);
     TableBuilder builder;
     auto cursor = framework::FFL(builder.cursor<o2::soa::Table<Cs...>>());
 
-    std::array<int32_t, sizeof...(T)> values;
-
-    iterator_tuple_t<std::decay_t<T>...> iterators = std::apply(
-      [](auto&&... x) {
-        return std::make_tuple(x.begin()...);
-      },
-      tail);
-
-    using rest_it_t = decltype(pack_from_tuple(iterators));
-
-    auto setValue = [&](auto& x, int idx) -> bool {
-      using type = std::decay_t<decltype(x)>;
-      constexpr auto position = framework::has_type_at_v<type>(rest_it_t{});
-
-      if constexpr (std::is_same_v<framework::pack_element_t<position, framework::pack<std::decay_t<T>...>>, Key>) {
-        values[position] = idx;
-        return true;
-      } else {
-        lowerBound<Key>(idx, x);
-        if (x == soa::RowViewSentinel{static_cast<uint64_t>(x.mMaxRow)}) {
-          values[position] = -1;
-          return false;
-        } else if (x.template getId<Key>() != idx) {
-          values[position] = -1;
-          return false;
-        } else {
-          values[position] = x.globalIndex();
-          ++x;
-          return true;
-        }
-      }
-    };
-
-    auto first = std::get<first_t>(tables);
-    for (auto& row : first) {
-      auto idx = -1;
-      if constexpr (std::is_same_v<first_t, Key>) {
-        idx = row.globalIndex();
-      } else {
-        idx = row.template getId<Key>();
-      }
-      std::apply(
-        [&](auto&... x) {
-          (setValue(x, idx), ...);
-        },
-        iterators);
-
-      cursor(0, row.globalIndex(), values[framework::has_type_at_v<T>(tables_t{})]...);
+    auto [rows, values] = matchIndexTables<Key>(tables, pool);
+    for (auto i = 0u; i < rows.size(); ++i) {
+      cursor(0, rows[i], values[framework::has_type_at_v<T>(tables_t{})][i]...);
     }
     builder.setLabel(label);
     return builder.finalize();
@@ -368,6 +477,18 @@ struct Builds : TableTransform<typename aod::MetadataTrait<T>::metadata> {
     return index_pack_t{};
   }
 
+  /// The sources are read only for their index to Key.
+  template <typename... Os>
+  std::vector<InputSpec> base_specs_impl(framework::pack<Os...>) const
+  {
+    return {this->template base_spec<Os>(aodIndexColumnsSpec<Key, Os>())...};
+  }
+
+  std::vector<InputSpec> base_specs() const
+  {
+    return base_specs_impl(this->sources_pack());
+  }
+
   template <typename... Cs, typename Key, typename T1, typename... Ts>
   auto build(framework::pack<Cs...>, Key const& key, std::tuple<T1, Ts...> tables)
   {
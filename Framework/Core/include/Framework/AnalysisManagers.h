@@ -94,6 +94,11 @@ struct FilterManager {
   {
     return false;
   }
+
+  static bool addRangePredicates(ANY&, std::vector<ExpressionInfo> const&, std::vector<std::string>&)
+  {
+    return false;
+  }
 };
 
 template <>
@@ -104,6 +109,21 @@ struct FilterManager<expressions::Filter> {
     return true;
   }
 
+  /// Combine the range predicate of @a filter with the ones of the
+  /// filtered arguments it applies to
+  static bool addRangePredicates(expressions::Filter const& filter, std::vector<ExpressionInfo> const& expressionInfos, std::vector<std::string>& predicates)
+  {
+    auto ops = expressions::createOperations(filter);
+    auto predicate = expressions::rangePredicate(*filter.node);
+    for (auto i = 0u; i < expressionInfos.size(); ++i) {
+      if (predicate == "true" || !expressions::isTableCompatible(expressionInfos[i].hashes, ops)) {
+        continue;
+      }
+      predicates[i] = predicates[i].empty() ? predicate : "and " + predicates[i] + " " + predicate;
+    }
+    return true;
+  }
+
   static bool updatePlaceholders(expressions::Filter& filter, InitContext& ctx)
   {
     expressions::updatePlaceholders(filter, ctx);
@@ -425,6 +445,60 @@ struct IndexManager<Builds<IDX, P>> {
     return true;
   }
 };
+
+/// Manager template for the members of a reentrant task, around the
+/// parallel invocation of its grouped process functions
+template <typename T>
+struct ParallelManager {
+  /// whether the member can be used by concurrent process functions
+  static constexpr bool reentrant = true;
+  static bool begin(T&, int, int) { return false; }
+  static bool end(T&) { return false; }
+};
+
+template <typename T>
+struct ParallelManager<Partition<T>> {
+  static constexpr bool reentrant = false;
+  static bool begin(Partition<T>&, int, int) { return false; }
+  static bool end(Partition<T>&) { return false; }
+};
+
+template <typename T>
+struct ParallelManager<OutputObj<T>> {
+  static constexpr bool reentrant = false;
+  static bool begin(OutputObj<T>&, int, int) { return false; }
+  static bool end(OutputObj<T>&) { return false; }
+};
+
+template <>
+struct ParallelManager<HistogramRegistry> {
+  static constexpr bool reentrant = true;
+  static bool begin(HistogramRegistry& registry, int nSlots, int)
+  {
+    registry.beginParallel(nSlots);
+    return true;
+  }
+  static bool end(HistogramRegistry& registry)
+  {
+    registry.endParallel();
+    return true;
+  }
+};
+
+template <typename TABLE>
+struct ParallelManager<Produces<TABLE>> {
+  static constexpr bool reentrant = true;
+  static bool begin(Produces<TABLE>& produces, int, int nChunks)
+  {
+    produces.beginParallel(nChunks);
+    return true;
+  }
+  static bool end(Produces<TABLE>& produces)
+  {
+    produces.endParallel();
+    return true;
+  }
+};
 } // namespace o2::framework
 
 #endif // ANALYSISMANAGERS_H
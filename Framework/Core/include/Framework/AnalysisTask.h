@@ -14,6 +14,7 @@
 
 #include "Framework/AnalysisManagers.h"
 #include "Framework/AlgorithmSpec.h"
+#include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/CallbackService.h"
 #include "Framework/ConfigContext.h"
 #include "Framework/ControlService.h"
@@ -22,6 +23,7 @@
 #include "Framework/ExpressionHelpers.h"
 #include "Framework/EndOfStreamContext.h"
 #include "Framework/Logger.h"
+#include "Framework/ProcessingPool.h"
 #include "Framework/StructToTuple.h"
 #include "Framework/FunctionalHelpers.h"
 #include "Framework/Traits.h"
@@ -53,6 +55,25 @@ namespace o2::framework
 struct AnalysisTask {
 };
 
+/// A task declaring
+///
+///   static constexpr bool reentrant = true;
+///
+/// allows its grouped process functions to be invoked concurrently on
+/// different groups, when started with --process-threads N. Such a task
+/// can only fill HistogramRegistries and write Produces tables, which
+/// are given a copy per thread, and must not hold Partitions or OutputObjs.
+template <typename T, typename = void>
+struct is_reentrant_task : std::false_type {
+};
+
+template <typename T>
+struct is_reentrant_task<T, std::enable_if_t<T::reentrant>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool is_reentrant_task_v = is_reentrant_task<T>::value;
+
 // Helper struct which builds a DataProcessorSpec from
 // the contents of an AnalysisTask...
 
@@ -94,7 +115,7 @@ struct AnalysisDataProcessorBuilder {
       inputSources.erase(last, inputSources.end());
       inputs.push_back(InputSpec{metadata::tableLabel(), metadata::origin(), metadata::description(), Lifetime::Timeframe, inputSources});
     } else {
-      inputs.push_back({metadata::tableLabel(), metadata::origin(), metadata::description()});
+      inputs.push_back({metadata::tableLabel(), metadata::origin(), metadata::description(), Lifetime::Timeframe, {aodColumnsSpec<std::decay_t<Arg>>()}});
     }
   }
 
@@ -108,6 +129,7 @@ struct AnalysisDataProcessorBuilder {
   static void appendSomethingWithMetadata(std::vector<InputSpec>& inputs, std::vector<ExpressionInfo>& eInfos)
   {
     using dT = std::decay_t<T>;
+    auto nInfos = eInfos.size();
     if constexpr (framework::is_specialization<dT, soa::Filtered>::value) {
       eInfos.push_back({AI, PI, dT::hashes(), o2::soa::createSchemaFromColumns(typename dT::table_t::persistent_columns_t{}), nullptr});
     } else if constexpr (soa::is_soa_iterator_t<dT>::value) {
@@ -115,7 +137,15 @@ struct AnalysisDataProcessorBuilder {
         eInfos.push_back({AI, PI, dT::parent_t::hashes(), o2::soa::createSchemaFromColumns(typename dT::table_t::persistent_columns_t{}), nullptr});
       }
     }
+    auto first = inputs.size();
     doAppendInputWithMetadata(soa::make_originals_from_type<dT>(), inputs);
+    // the inputs of a filtered argument refer to its expression info, until
+    // the range predicate of the filters is known
+    if (eInfos.size() != nInfos) {
+      for (auto ii = first; ii < inputs.size(); ++ii) {
+        inputs[ii].metadata.push_back(ConfigParamSpec{"aod-filter", VariantType::Int, static_cast<int>(nInfos), {"\"\""}});
+      }
+    }
   }
 
   template <typename... T>
@@ -222,9 +252,9 @@ struct AnalysisDataProcessorBuilder {
   template <typename G, typename... A>
   struct GroupSlicer {
     using grouping_t = std::decay_t<G>;
-    GroupSlicer(G& gt, std::tuple<A...>& at)
+    GroupSlicer(G& gt, std::tuple<A...>& at, ArrowTableSlicingCache* cache = nullptr)
       : max{gt.size()},
-        mBegin{GroupSlicerIterator(gt, at)}
+        mBegin{GroupSlicerIterator(gt, at, cache)}
     {
     }
 
@@ -263,7 +293,7 @@ struct AnalysisDataProcessorBuilder {
         }
       }
 
-      GroupSlicerIterator(G& gt, std::tuple<A...>& at)
+      GroupSlicerIterator(G& gt, std::tuple<A...>& at, ArrowTableSlicingCache* cache)
         : mAt{&at},
           mGroupingElement{gt.begin()},
           position{0}
@@ -272,24 +302,22 @@ struct AnalysisDataProcessorBuilder {
           groupSelection = &gt.getSelectedRows();
         }
         auto indexColumnName = getLabelFromType();
-        /// prepare slices and offsets for all associated tables that have index
-        /// to grouping table
+        /// prepare the groupings of all associated tables that have index
+        /// to grouping table, reusing the ones already computed for this
+        /// timeframe, if any
         ///
         auto splitter = [&](auto&& x) {
           using xt = std::decay_t<decltype(x)>;
           constexpr auto index = framework::has_type_at_v<std::decay_t<decltype(x)>>(associated_pack_t{});
           if (x.size() != 0 && hasIndexTo<std::decay_t<G>>(typename xt::persistent_columns_t{})) {
-            auto result = o2::framework::sliceByColumn(indexColumnName.c_str(),
-                                                       x.asArrowTable(),
-                                                       static_cast<int32_t>(gt.tableSize()),
-                                                       &groups[index],
-                                                       &offsets[index],
-                                                       &sizes[index]);
-            if (result.ok() == false) {
-              throw runtime_error("Cannot split collection");
+            auto groupingSize = static_cast<int32_t>(gt.tableSize());
+            if (cache != nullptr) {
+              slices[index] = cache->getSlices(x.asArrowTable(), indexColumnName, groupingSize);
+            } else {
+              slices[index] = ArrowTableSlicingCache::computeSlices(*x.asArrowTable()->GetColumnByName(indexColumnName), groupingSize);
             }
-            if (groups[index].size() > gt.tableSize()) {
-              throw runtime_error_f("Splitting collection resulted in a larger group number (%d) than there is rows in the grouping table (%d).", groups[index].size(), gt.tableSize());
+            if (slices[index]->offsets.size() > gt.tableSize()) {
+              throw runtime_error_f("Splitting collection resulted in a larger group number (%d) than there is rows in the grouping table (%d).", slices[index]->offsets.size(), gt.tableSize());
             };
           }
         };
@@ -306,7 +334,6 @@ struct AnalysisDataProcessorBuilder {
             constexpr auto index = framework::has_type_at_v<std::decay_t<decltype(x)>>(associated_pack_t{});
             selections[index] = &x.getSelectedRows();
             starts[index] = selections[index]->begin();
-            offsets[index].push_back(std::get<xt>(at).tableSize());
           }
         };
         std::apply(
@@ -355,6 +382,13 @@ struct AnalysisDataProcessorBuilder {
         return *this;
       }
 
+      /// Move @a n grouping rows ahead
+      void advance(int64_t n)
+      {
+        position += n;
+        mGroupingElement.moveByIndex(n);
+      }
+
       bool operator==(GroupSlicerSentinel const& other)
       {
         return O2_BUILTIN_UNLIKELY(position == other.position);
@@ -391,24 +425,24 @@ struct AnalysisDataProcessorBuilder {
           } else {
             pos = position;
           }
+          auto offset = slices[index]->offsets[pos];
+          auto size = slices[index]->sizes[pos];
+          auto groupedElementsTable = std::get<A1>(*mAt).asArrowTable()->Slice(offset, size);
           if constexpr (soa::is_soa_filtered_t<std::decay_t<A1>>::value) {
-            auto groupedElementsTable = arrow::util::get<std::shared_ptr<arrow::Table>>(((groups[index])[pos]).value);
-
             // for each grouping element we need to slice the selection vector
-            auto start_iterator = std::lower_bound(starts[index], selections[index]->end(), (offsets[index])[pos]);
-            auto stop_iterator = std::lower_bound(start_iterator, selections[index]->end(), (offsets[index])[pos] + (sizes[index])[pos]);
+            auto start_iterator = std::lower_bound(starts[index], selections[index]->end(), offset);
+            auto stop_iterator = std::lower_bound(start_iterator, selections[index]->end(), offset + size);
             starts[index] = stop_iterator;
             soa::SelectionVector slicedSelection{start_iterator, stop_iterator};
             std::transform(slicedSelection.begin(), slicedSelection.end(), slicedSelection.begin(),
                            [&](int64_t idx) {
-                             return idx - static_cast<int64_t>((offsets[index])[pos]);
+                             return idx - static_cast<int64_t>(offset);
                            });
 
-            std::decay_t<A1> typedTable{{groupedElementsTable}, std::move(slicedSelection), (offsets[index])[pos]};
+            std::decay_t<A1> typedTable{{groupedElementsTable}, std::move(slicedSelection), offset};
             return typedTable;
           } else {
-            auto groupedElementsTable = arrow::util::get<std::shared_ptr<arrow::Table>>(((groups[index])[pos]).value);
-            std::decay_t<A1> typedTable{{groupedElementsTable}, (offsets[index])[pos]};
+            std::decay_t<A1> typedTable{{groupedElementsTable}, offset};
             return typedTable;
           }
         } else {
@@ -421,9 +455,7 @@ struct AnalysisDataProcessorBuilder {
       typename grouping_t::iterator mGroupingElement;
       uint64_t position = 0;
       soa::SelectionVector const* groupSelection = nullptr;
-      std::array<std::vector<arrow::Datum>, sizeof...(A)> groups;
-      std::array<std::vector<uint64_t>, sizeof...(A)> offsets;
-      std::array<std::vector<int>, sizeof...(A)> sizes;
+      std::array<std::shared_ptr<SliceInfo const>, sizeof...(A)> slices;
       std::array<soa::SelectionVector const*, sizeof...(A)> selections;
       std::array<soa::SelectionVector::const_iterator, sizeof...(A)> starts;
     };
@@ -442,13 +474,13 @@ struct AnalysisDataProcessorBuilder {
   };
 
   template <typename Task, typename... T>
-  static void invokeProcessTuple(Task& task, InputRecord& inputs, std::tuple<T...> const& processTuple, std::vector<ExpressionInfo> const& infos)
+  static void invokeProcessTuple(Task& task, InputRecord& inputs, std::tuple<T...> const& processTuple, std::vector<ExpressionInfo> const& infos, ArrowTableSlicingCache& cache, ProcessingPool* pool = nullptr)
   {
-    (invokeProcess<o2::framework::has_type_at_v<T>(pack<T...>{})>(task, inputs, std::get<T>(processTuple), infos), ...);
+    (invokeProcess<o2::framework::has_type_at_v<T>(pack<T...>{})>(task, inputs, std::get<T>(processTuple), infos, cache, pool), ...);
   }
 
   template <int PI, typename Task, typename R, typename C, typename Grouping, typename... Associated>
-  static void invokeProcess(Task& task, InputRecord& inputs, R (C::*processingFunction)(Grouping, Associated...), std::vector<ExpressionInfo> const& infos)
+  static void invokeProcess(Task& task, InputRecord& inputs, R (C::*processingFunction)(Grouping, Associated...), std::vector<ExpressionInfo> const& infos, ArrowTableSlicingCache& cache, ProcessingPool* pool = nullptr)
   {
     using G = std::decay_t<Grouping>;
     auto groupingTable = AnalysisDataProcessorBuilder::bindGroupingTable<PI>(inputs, processingFunction, infos);
@@ -503,7 +535,13 @@ struct AnalysisDataProcessorBuilder {
 
       if constexpr (soa::is_soa_iterator_t<std::decay_t<G>>::value) {
         // grouping case
-        auto slicer = GroupSlicer(groupingTable, associatedTables);
+        auto slicer = GroupSlicer(groupingTable, associatedTables, &cache);
+        if constexpr (is_reentrant_task_v<Task>) {
+          if (pool != nullptr && slicer.max > 1) {
+            invokeProcessParallel(task, processingFunction, groupingTable, associatedTables, slicer, *pool);
+            return;
+          }
+        }
         for (auto& slice : slicer) {
           auto associatedSlices = slice.associatedTables();
 
@@ -539,6 +577,42 @@ struct AnalysisDataProcessorBuilder {
     }
   }
 
+  /// Invoke the grouped @a processingFunction of a reentrant @a task for all
+  /// the groups of @a slicer on the threads of @a pool.
+  template <typename Task, typename R, typename C, typename Grouping, typename... Associated, typename G, typename A, typename S>
+  static void invokeProcessParallel(Task& task, R (C::*processingFunction)(Grouping, Associated...), G& groupingTable, A& associatedTables, S& slicer, ProcessingPool& pool)
+  {
+    // consecutive grouping rows are processed in chunks, taken by
+    // the threads of the pool as they become free
+    auto nGroups = slicer.max;
+    auto nChunks = static_cast<int>(std::min<int64_t>(nGroups, ProcessingPool::ChunksPerSlot * pool.size()));
+    homogeneous_apply_refs([&pool, nChunks](auto& x) { return ParallelManager<std::decay_t<decltype(x)>>::begin(x, pool.size(), nChunks); }, task);
+    std::exception_ptr error;
+    try {
+      pool.run(nChunks, [&](int chunk) {
+        auto first = nGroups * chunk / nChunks;
+        auto last = nGroups * (chunk + 1) / nChunks;
+        auto slice = slicer.begin();
+        slice.advance(first);
+        for (auto position = first; position < last; ++position, ++slice) {
+          auto associatedSlices = slice.associatedTables();
+          std::apply(
+            [&](auto&&... x) {
+              (x.bindExternalIndices(&groupingTable, &std::get<std::decay_t<Associated>>(associatedTables)...), ...);
+            },
+            associatedSlices);
+          invokeProcessWithArgsGeneric(task, processingFunction, slice.groupingElement(), associatedSlices);
+        }
+      });
+    } catch (...) {
+      error = std::current_exception();
+    }
+    homogeneous_apply_refs([](auto& x) { return ParallelManager<std::decay_t<decltype(x)>>::end(x); }, task);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
   template <typename C, typename T, typename G, typename... A>
   static void invokeProcessWithArgsGeneric(C& task, T processingFunction, G g, std::tuple<A...>& at)
   {
@@ -690,11 +764,20 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
 
   /// make sure options and configurables are set before expression infos are created
   homogeneous_apply_refs([&options, &hash](auto& x) { return OptionManager<std::decay_t<decltype(x)>>::appendOption(options, x); }, *task.get());
+  if constexpr (is_reentrant_task_v<T>) {
+    options.push_back(ConfigParamSpec{"process-threads", VariantType::Int, 1, {"Number of threads invoking the grouped process functions"}});
+  }
 
   if constexpr ((std::tuple_size_v<std::decay_t<decltype(processTuple)>>) > 0) {
     // this pushes (argumentIndex,processIndex,schemaPtr,nullptr) into expressionInfos for arguments that are Filtered/filtered_iterators
     AnalysisDataProcessorBuilder::inputsFromArgsTuple(processTuple, inputs, expressionInfos);
   }
+  // range predicates of the filters of each filtered argument, which the
+  // reader can use to skip the time frames in which no row passes
+  std::vector<std::string> rangePredicates(expressionInfos.size());
+  homogeneous_apply_refs([&expressionInfos, &rangePredicates](auto& x) { return FilterManager<std::decay_t<decltype(x)>>::addRangePredicates(x, expressionInfos, rangePredicates); }, *task.get());
+  setFilterPredicates(inputs, rangePredicates);
+
   // avoid self-forwarding if process methods subscribe to same tables
   std::sort(inputs.begin(), inputs.end(), [](InputSpec const& a, InputSpec const& b) { return a.binding < b.binding; });
   auto last = std::unique(inputs.begin(), inputs.end(), [](InputSpec const& a, InputSpec const& b) { return a.binding == b.binding; });
@@ -714,7 +797,7 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
 
   homogeneous_apply_refs([&outputs, &hash](auto& x) { return OutputManager<std::decay_t<decltype(x)>>::appendOutput(outputs, x, hash); }, *task.get());
 
-  auto algo = AlgorithmSpec::InitCallback{[task = task, processTuple = processTuple, expressionInfos](InitContext& ic) mutable {
+  auto algo = AlgorithmSpec::InitCallback{[task = task, processTuple = processTuple, expressionInfos, taskName = name_str](InitContext& ic) mutable {
     homogeneous_apply_refs([&ic](auto&& x) { return OptionManager<std::decay_t<decltype(x)>>::prepare(ic, x); }, *task.get());
     homogeneous_apply_refs([&ic](auto&& x) { return ServiceManager<std::decay_t<decltype(x)>>::prepare(ic, x); }, *task.get());
 
@@ -745,13 +828,26 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
       task->init(ic);
     }
 
-    return [task, processTuple, expressionInfos](ProcessingContext& pc) {
+    std::shared_ptr<ProcessingPool> pool;
+    if constexpr (is_reentrant_task_v<T>) {
+      auto nThreads = ic.options().get<int>("process-threads");
+      if (nThreads > 1) {
+        bool reentrant = true;
+        homogeneous_apply_refs([&reentrant](auto& x) { reentrant = reentrant && ParallelManager<std::decay_t<decltype(x)>>::reentrant; return true; }, *task.get());
+        if (!reentrant) {
+          throw runtime_error_f("Task %s holds Partitions or OutputObjs, its process functions cannot run on several threads", taskName.c_str());
+        }
+        pool = std::make_shared<ProcessingPool>(nThreads);
+      }
+    }
+
+    return [task, processTuple, expressionInfos, pool](ProcessingContext& pc) {
       homogeneous_apply_refs([&pc](auto&& x) { return OutputManager<std::decay_t<decltype(x)>>::prepare(pc, x); }, *task.get());
       if constexpr (has_run_v<T>) {
         task->run(pc);
       }
       if constexpr ((std::tuple_size_v<std::decay_t<decltype(processTuple)>>) > 0) {
-        AnalysisDataProcessorBuilder::invokeProcessTuple(*(task.get()), pc.inputs(), processTuple, expressionInfos);
+        AnalysisDataProcessorBuilder::invokeProcessTuple(*(task.get()), pc.inputs(), processTuple, expressionInfos, pc.services().get<ArrowTableSlicingCache>(), pool.get());
       }
       homogeneous_apply_refs([&pc](auto&& x) { return OutputManager<std::decay_t<decltype(x)>>::finalize(pc, x); }, *task.get());
     };
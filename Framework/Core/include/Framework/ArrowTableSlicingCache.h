@@ -0,0 +1,94 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_ARROWTABLESLICINGCACHE_H_
+#define O2_FRAMEWORK_ARROWTABLESLICINGCACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace arrow
+{
+class Buffer;
+class ChunkedArray;
+class Table;
+} // namespace arrow
+
+namespace o2::framework
+{
+
+/// Grouping of the rows of a table by one of its index columns:
+/// the rows pointing to the grouping row i are [offsets[i], offsets[i] + sizes[i]).
+struct SliceInfo {
+  std::vector<uint64_t> offsets;
+  std::vector<int> sizes;
+};
+
+/// Cache of the groupings of the tables of the current timeframe.
+/// The grouping only depends on the content of the index column, so
+/// it is computed once per timeframe and shared by all the process
+/// functions of all the tasks which slice a table by the same index,
+/// regardless of the arrow::Table (e.g. a soa::Join) they hold.
+/// The cache is cleared after each processing.
+class ArrowTableSlicingCache
+{
+ public:
+  /// The grouping of @a table by the index @a column, for a grouping
+  /// table of @a groupingSize rows.
+  std::shared_ptr<SliceInfo const> getSlices(std::shared_ptr<arrow::Table> const& table, std::string const& column, int32_t groupingSize);
+  void clear();
+
+  /// Compute the grouping of the sorted index column @a column. Rows with
+  /// a negative index do not belong to any group.
+  /// Throws if the column is not sorted.
+  static std::shared_ptr<SliceInfo const> computeSlices(arrow::ChunkedArray const& column, int32_t groupingSize);
+
+ private:
+  /// The values of one chunk of the index column
+  struct ChunkKey {
+    std::shared_ptr<arrow::Buffer> values;
+    int64_t offset;
+    int64_t length;
+    bool operator==(ChunkKey const& other) const
+    {
+      return values == other.values && offset == other.offset && length == other.length;
+    }
+  };
+  /// The index column is identified by the buffers holding its values,
+  /// which the key keeps alive: their memory cannot be reused by another
+  /// column while the grouping is cached.
+  struct Key {
+    std::vector<ChunkKey> chunks;
+    std::string column;
+    int32_t groupingSize;
+    bool operator==(Key const& other) const
+    {
+      return chunks == other.chunks && groupingSize == other.groupingSize && column == other.column;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(Key const& key) const
+    {
+      size_t hash = std::hash<std::string>{}(key.column) ^ ((size_t)key.groupingSize << 32);
+      for (auto const& chunk : key.chunks) {
+        hash ^= std::hash<void const*>{}(chunk.values.get()) ^ (size_t)chunk.offset ^ ((size_t)chunk.length << 16);
+      }
+      return hash;
+    }
+  };
+  std::unordered_map<Key, std::shared_ptr<SliceInfo const>, KeyHash> mCache;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_ARROWTABLESLICINGCACHE_H_
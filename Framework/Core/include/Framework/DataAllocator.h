@@ -270,6 +270,7 @@ class DataAllocator
   /// Note: for many use cases, especially for the messageable types, the `make` interface
   /// might be better suited as the objects are allocated directly in the underlying
   /// memory resource and the copy can be avoided.
+  /// Vectors which are not needed after the call can be moved in, see below.
   ///
   /// Note: messageable objects with ROOT dictionary are preferably sent unserialized.
   /// Use @a ROOTSerialized type wrapper to force ROOT serialization. Same applies to
@@ -277,12 +278,14 @@ class DataAllocator
   template <typename T>
   void snapshot(const Output& spec, T const& object)
   {
-    auto proxy = mRegistry->get<MessageContext>().proxy();
+    auto& context = mRegistry->get<MessageContext>();
+    auto proxy = context.proxy();
     FairMQMessagePtr payloadMessage;
     auto serializationType = o2::header::gSerializationMethodNone;
     if constexpr (is_messageable<T>::value == true) {
       // Serialize a snapshot of a trivially copyable, non-polymorphic object,
-      payloadMessage = proxy.createMessage(sizeof(T));
+      // the message is created for the actual channel, so that it can come from the pool
+      payloadMessage = context.createMessage(matchDataHeader(spec, mTimingInfo->timeslice), 0, sizeof(T));
       memcpy(payloadMessage->GetData(), &object, sizeof(T));
 
       serializationType = o2::header::gSerializationMethodNone;
@@ -295,7 +298,7 @@ class DataAllocator
         // reference object
         constexpr auto elementSizeInBytes = sizeof(ElementType);
         auto sizeInBytes = elementSizeInBytes * object.size();
-        payloadMessage = proxy.createMessage(sizeInBytes);
+        payloadMessage = context.createMessage(matchDataHeader(spec, mTimingInfo->timeslice), 0, sizeInBytes);
 
         if constexpr (std::is_pointer<typename T::value_type>::value == false) {
           // vector of elements
@@ -370,6 +373,25 @@ class DataAllocator
     addPartToContext(std::move(payloadMessage), spec, serializationType);
   }
 
+  /// Take a snapshot of a std::vector the caller does not need anymore.
+  /// If the elements are messageable and the vector has been allocated with the memory
+  /// resource of the output (see makeVector and getMemoryResource), its buffer is sent
+  /// as it is, without any copy. Otherwise the content is copied as in the snapshot of
+  /// a const vector, and the vector is released right after.
+  template <typename T, typename Allocator>
+  void snapshot(const Output& spec, std::vector<T, Allocator>&& object)
+  {
+    if constexpr (is_messageable<T>::value == true && std::is_same<Allocator, o2::pmr::polymorphic_allocator<T>>::value == true) {
+      // an empty vector has no buffer to adopt
+      if (object.empty() == false) {
+        adoptContainer(spec, std::move(object));
+        return;
+      }
+    }
+    std::vector<T, Allocator> released{std::move(object)};
+    snapshot(spec, static_cast<std::vector<T, Allocator> const&>(released));
+  }
+
   /// Take a snapshot of a raw data array which can be either POD or may contain a serialized
   /// object (in such case the serialization method should be specified accordingly). Changes
   /// to the data after the call will not be sent.
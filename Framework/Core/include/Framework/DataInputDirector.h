@@ -16,7 +16,10 @@
 
 #include "Framework/DataDescriptorMatcher.h"
 
+#include <future>
+#include <map>
 #include <regex>
+#include <unordered_map>
 #include "rapidjson/fwd.h"
 
 namespace o2::framework
@@ -35,6 +38,21 @@ struct FileAndFolder {
   std::string folderName = "";
 };
 
+struct PrefetchedTree {
+  std::string treename;
+  std::vector<std::string> columns; /// all the branches if empty
+};
+
+/// A file opened, and the trees of its first folders preloaded,
+/// on a background thread
+struct PrefetchedFile {
+  int counter = -1;
+  TFile* file = nullptr;
+  std::vector<uint64_t> listOfTimeFrameNumbers;
+  std::map<std::string, TTree*> trees; /// by folder/treename
+  size_t bytes = 0;                    /// size of the preloaded baskets
+};
+
 struct DataInputDescriptor {
   /// Holds information concerning the reading of an aod table.
   /// The information includes the table specification, treename,
@@ -75,6 +93,23 @@ struct DataInputDescriptor {
   void closeInputFile();
   bool isAlienSupportOn() { return mAlienSupport; }
 
+  // prefetching
+  void setPrefetching(int nFolders, size_t memoryBudget, int fileStride);
+  void addPrefetchedTree(std::string const& treename, std::vector<std::string> const& columns);
+  bool hasPrefetchedTrees() { return !mprefetchTrees.empty(); }
+  /// The tree @a treename (folder/treename) of file @a counter, if it was
+  /// prefetched. The ownership goes to the caller.
+  TTree* getPrefetchedTree(int counter, std::string const& treename);
+  TTree* findPrefetchedTree(int counter, std::string const& treename);
+
+  /// Keep the tree @a treename (folder/treename), read for its user info, so
+  /// that it is not read again when its table is requested. Only the trees
+  /// of the last folder are kept.
+  void keepParameterTree(std::string const& treename, TTree* tree);
+  TTree* findParameterTree(std::string const& treename);
+  /// The ownership goes to the caller.
+  TTree* takeParameterTree(std::string const& treename);
+
  private:
   std::string minputfilesFile = "";
   std::string* minputfilesFilePtr = nullptr;
@@ -86,6 +121,20 @@ struct DataInputDescriptor {
   bool mAlienSupport = false;
 
   int mtotalNumberTimeFrames = 0;
+
+  int mprefetchFolders = 0;
+  size_t mprefetchMemory = 0;
+  int mprefetchStride = 1;
+  std::vector<PrefetchedTree> mprefetchTrees;
+  std::future<std::unique_ptr<PrefetchedFile>> mprefetching;
+  std::unique_ptr<PrefetchedFile> mprefetched;
+
+  std::string mparameterFolder = "";
+  std::map<std::string, TTree*> mparameterTrees; /// by folder/treename
+
+  void startPrefetching(int counter);
+  void dropParameterTrees();
+  std::unique_ptr<PrefetchedFile> takePrefetched(int counter);
 };
 
 struct DataInputDirector {
@@ -107,6 +156,13 @@ struct DataInputDirector {
   void setFilenamesRegex(std::string dfn) { mFilenameRegex = dfn; }
   bool readJson(std::string const& fnjson);
   void closeInputFiles();
+  /// Only the @a columns of table @a dh are preloaded, all of them if empty.
+  void addPrefetchedTable(header::DataHeader dh, std::vector<std::string> const& columns);
+  /// While a file is read, open the next one (@a fileStride files further)
+  /// on a background thread and preload the trees of the tables added with
+  /// addPrefetchedTable for its first @a nFolders folders, as long as they
+  /// fit in @a memoryBudget bytes.
+  void setPrefetching(int nFolders, size_t memoryBudget, int fileStride);
 
   // getters
   DataInputDescriptor* getDataInputDescriptor(header::DataHeader dh);
@@ -114,6 +170,10 @@ struct DataInputDirector {
 
   std::unique_ptr<TTreeReader> getTreeReader(header::DataHeader dh, int counter, int numTF, std::string treeName);
   TTree* getDataTree(header::DataHeader dh, int counter, int numTF);
+  /// The numeric parameters stored by the writer in the user info of the
+  /// tree of table @a dh, e.g. the ranges of the values of its columns.
+  /// The tree is read once, a following getDataTree reuses it.
+  std::unordered_map<std::string, double> getTreeParameters(header::DataHeader dh, int counter, int numTF);
   uint64_t getTimeFrameNumber(header::DataHeader dh, int counter, int numTF);
   FileAndFolder getFileFolder(header::DataHeader dh, int counter, int numTF);
   int getTimeFramesInFile(header::DataHeader dh, int counter);
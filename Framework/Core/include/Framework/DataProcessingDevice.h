@@ -30,8 +30,11 @@
 #include <fairmq/FairMQDevice.h>
 #include <fairmq/FairMQParts.h>
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
 #include <uv.h>
 
 namespace o2::framework
@@ -40,6 +43,7 @@ namespace o2::framework
 struct InputChannelInfo;
 struct DeviceState;
 struct ComputingQuotaEvaluator;
+struct WorkerPool;
 
 /// Context associated to a given DataProcessor.
 /// For the time being everything points to
@@ -86,6 +90,9 @@ struct DataProcessorContext {
   AlgorithmSpec::ErrorCallback* error = nullptr;
 
   std::function<void(o2::framework::RuntimeErrorRef e, InputRecord& record)>* errorHandling = nullptr;
+  /// The threads processing timeslices concurrently, nullptr if
+  /// everything is processed by the calling thread.
+  WorkerPool* workers = nullptr;
 };
 
 struct TaskStreamRef {
@@ -103,6 +110,53 @@ struct TaskStreamInfo {
   bool running = false;
 };
 
+/// A timeslice being processed by one of the worker threads. It holds
+/// everything which is specific to the processing of a given timeslice,
+/// so that several of them can be processed at the same time.
+/// Outputs end up in the stream's own instances of the ServiceKind::Stream
+/// services (i.e. the message backends) and are sent by the main thread once
+/// the processing is done, since the channels cannot be used concurrently.
+struct WorkerStream {
+  /// The id of this stream
+  TaskStreamRef id;
+  /// The services as seen by the processing of this stream, on the worker
+  /// and on the main thread, i.e. with its own instances of the Stream ones
+  ServiceRegistry registry;
+  /// Timing information and allocator of the timeslice being processed
+  TimingInfo timingInfo;
+  std::unique_ptr<DataAllocator> allocator;
+  /// The action being processed and its inputs
+  DataRelayer::RecordAction action;
+  std::vector<MessageSet> inputs;
+  uint64_t tStart = 0;
+  /// Error raised while processing, handled on the main thread
+  std::optional<RuntimeErrorRef> error;
+  /// Instances of the Stream services owned by this stream
+  std::vector<ServiceHandle> services;
+  std::vector<ServiceProcessingHandle> preProcessingHandles;
+  std::vector<ServiceProcessingHandle> postProcessingHandles;
+  /// Whether the stream was given something to process
+  bool scheduled = false;
+};
+
+/// Threads processing independent timeslices concurrently. Each thread
+/// serves a single WorkerStream, so that the Stream services it registers
+/// for itself are the ones of its stream.
+struct WorkerPool {
+  std::vector<std::unique_ptr<WorkerStream>> streams;
+  std::vector<std::thread> threads;
+  /// Streams waiting for a timeslice
+  std::vector<WorkerStream*> idle;
+  /// Streams done with processing, to be finalised by the main thread
+  std::vector<WorkerStream*> done;
+  std::mutex mutex;
+  std::condition_variable scheduledCondition;
+  std::condition_variable doneCondition;
+  /// No new timeslice is scheduled, the ones in flight are finalised
+  bool draining = false;
+  bool stop = false;
+};
+
 /// A device actually carrying out all the DPL
 /// Data Processing needs.
 class DataProcessingDevice : public FairMQDevice
@@ -123,11 +177,21 @@ class DataProcessingDevice : public FairMQDevice
   static void doPrepare(DataProcessorContext& context);
   static void handleData(DataProcessorContext& context, InputChannelInfo&);
   static bool tryDispatchComputation(DataProcessorContext& context, std::vector<DataRelayer::RecordAction>& completed);
+  /// Body of the worker threads: process the timeslices scheduled on @a stream until asked to stop
+  static void runWorker(DataProcessorContext& context, WorkerPool& workers, WorkerStream& stream);
+  /// Whether the timeslices of @a spec can be processed by worker threads, i.e.
+  /// if it is labelled as independent-timeslices and does not dispatch its
+  /// outputs when ready
+  static bool allowsWorkers(DeviceSpec const& spec);
   std::vector<DataProcessorContext> mDataProcessorContexes;
 
  protected:
   void error(const char* msg);
   void fillContext(DataProcessorContext& context, DeviceContext& deviceContext);
+  /// Start @a nThreads workers, if the DataProcessor allows for it
+  void startWorkers(int nThreads);
+  /// Stop the workers, once the timeslices they are processing are done and their outputs sent
+  void stopWorkers();
 
  private:
   DeviceContext mDeviceContext;
@@ -161,6 +225,7 @@ class DataProcessingDevice : public FairMQDevice
   bool mWasActive = false;                                       /// Whether or not the device was active at last iteration.
   std::vector<uv_work_t> mHandles;                               /// Handles to use to schedule work.
   std::vector<TaskStreamInfo> mStreams;                          /// Information about the task running in the associated mHandle.
+  std::unique_ptr<WorkerPool> mWorkers;                          /// Threads processing independent timeslices, if any.
   ComputingQuotaEvaluator& mQuotaEvaluator;                      /// The component which evaluates if the offer can be used to run a task
 };
 
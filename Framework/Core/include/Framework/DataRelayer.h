@@ -20,8 +20,11 @@
 #include "Framework/TimesliceIndex.h"
 #include "Framework/Tracing.h"
 
+#include <atomic>
 #include <cstddef>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 class FairMQMessage;
@@ -36,10 +39,10 @@ namespace o2::framework
 
 /// Helper struct to hold statistics about the relaying process.
 struct DataRelayerStats {
-  uint64_t malformedInputs = 0;         /// Malformed inputs which the user attempted to process
-  uint64_t droppedComputations = 0;     /// How many computations have been dropped because one of the inputs was late
-  uint64_t droppedIncomingMessages = 0; /// How many messages have been dropped (not relayed) because they were late
-  uint64_t relayedMessages = 0;         /// How many messages have been successfully relayed
+  std::atomic<uint64_t> malformedInputs = 0;         /// Malformed inputs which the user attempted to process
+  std::atomic<uint64_t> droppedComputations = 0;     /// How many computations have been dropped because one of the inputs was late
+  std::atomic<uint64_t> droppedIncomingMessages = 0; /// How many messages have been dropped (not relayed) because they were late
+  std::atomic<uint64_t> relayedMessages = 0;         /// How many messages have been successfully relayed
 };
 
 enum struct CacheEntryStatus : int {
@@ -54,7 +57,11 @@ class DataRelayer
  public:
   /// DataRelayer is thread safe because we have a lock around
   /// each method and there is no particular order in which
-  /// methods need to be called.
+  /// methods need to be called. Methods which (re)associate slots
+  /// and timeslices take the relayer lock exclusively, while relaying
+  /// to an already associated slot and checking the completion only
+  /// take it shared, plus the lock of the slot they work on, so that
+  /// several threads can relay at the same time.
   constexpr static ServiceKind service_kind = ServiceKind::Global;
   enum RelayChoice {
     WillRelay,     /// Ownership of the data has been taken
@@ -140,6 +147,12 @@ class DataRelayer
   void clear();
 
  private:
+  /// @return true if the cache entry of @a input in @a slot holds some data
+  bool hasData(TimesliceSlot slot, size_t input) const;
+  /// Resize the per-slot state to the size of the index. Must be called
+  /// with mMutex held exclusively.
+  void resizeSlots();
+
   monitoring::Monitoring& mMetrics;
 
   /// This is the actual cache of all the parts in flight.
@@ -157,13 +170,17 @@ class DataRelayer
   std::vector<data_matcher::DataDescriptorMatcher> mInputMatchers;
   std::vector<data_matcher::VariableContext> mVariableContextes;
   std::vector<CacheEntryStatus> mCachedStateMetrics;
+  /// One lock per slot, protecting its cache line and per-slot state in the index.
+  std::unique_ptr<std::mutex[]> mSlotMutexes;
+  /// Per slot bitmap of the inputs which hold data (only for the first 64 inputs)
+  std::vector<uint64_t> mFilledInputs;
 
   static std::vector<std::string> sMetricsNames;
   static std::vector<std::string> sVariablesMetricsNames;
   static std::vector<std::string> sQueriesMetricsNames;
 
   DataRelayerStats mStats;
-  TracyLockableN(std::recursive_mutex, mMutex, "data relayer mutex");
+  TracySharedLockableN(std::shared_mutex, mMutex, "data relayer mutex");
 };
 
 } // namespace o2::framework
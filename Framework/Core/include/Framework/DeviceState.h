@@ -14,6 +14,7 @@
 #include "Framework/ChannelInfo.h"
 #include "Framework/ComputingQuotaOffer.h"
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <map>
@@ -60,7 +61,8 @@ struct DeviceState {
 
   std::vector<InputChannelInfo> inputChannelInfos;
   StreamingState streaming = StreamingState::Streaming;
-  bool quitRequested = false;
+  /// Also read by the worker threads
+  std::atomic<bool> quitRequested = false;
 
   /// ComputingQuotaOffers which have not yet been
   /// evaluated by the ComputingQuotaEvaluator
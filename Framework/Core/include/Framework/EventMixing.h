@@ -0,0 +1,161 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_EVENTMIXING_H_
+#define O2_FRAMEWORK_EVENTMIXING_H_
+
+#include "Framework/ProcessingPool.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Pool of past events for event mixing, kept across timeframes.
+///
+/// Events are grouped in bins, e.g. of vertex position and multiplicity,
+/// and at most depth events are kept per bin, the oldest being dropped
+/// first. Since the tables of a timeframe are gone when the next one is
+/// processed, @a Event is a copy of what is needed from an event, e.g. the
+/// kinematics of its selected tracks.
+template <typename Event>
+class MixingPool
+{
+ public:
+  explicit MixingPool(int depth) : mDepth(depth) {}
+
+  /// Combine each of @a events with K - 1 distinct events of the same bin
+  /// which precede it, among the ones kept from previous timeframes and the
+  /// ones before it in @a events, the most recent depth ones being used.
+  /// The events are then added to the pool. Events with a negative bin are
+  /// not mixed.
+  ///
+  /// @a f is called as f(event, partner...) once per combination. When a
+  /// @a pool is given, the combinations are split in chunks processed by
+  /// its threads, so that @a f must only modify state private to the
+  /// calling slot, see ProcessingSlot::current().
+  template <int K = 2, typename F>
+  void mix(std::vector<std::pair<int, Event>> events, F&& f, ProcessingPool* pool = nullptr)
+  {
+    static_assert(K >= 2, "At least two events are needed for a combination.");
+    using Combination = std::array<Event const*, K>;
+
+    // the combinations are listed first, so that they do not depend on the order of processing
+    std::vector<Combination> combinations;
+    std::unordered_map<int, std::vector<Event const*>> partners;
+    for (auto& [bin, event] : events) {
+      if (bin < 0) {
+        continue;
+      }
+      auto [binPartners, inserted] = partners.try_emplace(bin);
+      if (inserted) {
+        if (auto past = mEvents.find(bin); past != mEvents.end()) {
+          for (auto& pastEvent : past->second) {
+            binPartners->second.push_back(&pastEvent);
+          }
+        }
+      }
+      auto& candidates = binPartners->second;
+      auto first = candidates.size() > (size_t)mDepth ? candidates.end() - mDepth : candidates.begin();
+      addCombinations<K>(&event, first, candidates.end(), combinations);
+      candidates.push_back(&event);
+    }
+
+    auto process = [&combinations, &f](size_t begin, size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        std::apply([&f](auto const*... members) { f(*members...); }, combinations[i]);
+      }
+    };
+    if (pool != nullptr && pool->size() > 1 && combinations.size() > 1) {
+      const size_t nChunks = std::min(combinations.size(), (size_t)pool->size() * ProcessingPool::ChunksPerSlot);
+      pool->run(nChunks, [&](int chunk) {
+        process(combinations.size() * chunk / nChunks, combinations.size() * (chunk + 1) / nChunks);
+      });
+    } else {
+      process(0, combinations.size());
+    }
+
+    for (auto& [bin, event] : events) {
+      if (bin >= 0) {
+        push(bin, std::move(event));
+      }
+    }
+  }
+
+  /// Add an event to the pool, dropping the oldest one of its bin if it is full.
+  void push(int bin, Event event)
+  {
+    auto& binEvents = mEvents[bin];
+    binEvents.push_back(std::move(event));
+    while (binEvents.size() > (size_t)mDepth) {
+      binEvents.pop_front();
+    }
+  }
+
+  /// Number of events kept for a bin.
+  size_t size(int bin) const
+  {
+    auto past = mEvents.find(bin);
+    return past == mEvents.end() ? 0 : past->second.size();
+  }
+
+  void clear()
+  {
+    mEvents.clear();
+  }
+
+ private:
+  /// Append the combinations of @a event with K - 1 distinct candidates in [first, last).
+  template <int K, typename Iterator, typename Combination>
+  static void addCombinations(Event const* event, Iterator first, Iterator last, std::vector<Combination>& combinations)
+  {
+    constexpr int nPartners = K - 1;
+    const int nCandidates = last - first;
+    if (nCandidates < nPartners) {
+      return;
+    }
+    std::array<int, nPartners> indices;
+    for (int i = 0; i < nPartners; ++i) {
+      indices[i] = i;
+    }
+    while (true) {
+      Combination combination;
+      combination[0] = event;
+      for (int i = 0; i < nPartners; ++i) {
+        combination[i + 1] = first[indices[i]];
+      }
+      combinations.push_back(combination);
+      int i = nPartners - 1;
+      while (i >= 0 && indices[i] == nCandidates - nPartners + i) {
+        --i;
+      }
+      if (i < 0) {
+        break;
+      }
+      ++indices[i];
+      for (int j = i + 1; j < nPartners; ++j) {
+        indices[j] = indices[j - 1] + 1;
+      }
+    }
+  }
+
+  int mDepth;
+  std::unordered_map<int, std::deque<Event>> mEvents;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_EVENTMIXING_H_
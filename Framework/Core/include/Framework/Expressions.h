@@ -43,6 +43,8 @@ class Filter;
 #include <memory>
 #include <typeinfo>
 #include <set>
+#include <functional>
+#include <optional>
 
 using atype = arrow::Type;
 struct ExpressionInfo {
@@ -340,6 +342,12 @@ using Operations = std::vector<ColumnOperationSpec>;
 /// Function to create an internal operation sequence from a filter tree
 Operations createOperations(Filter const& expression);
 
+/// Labels of the columns used by @a expression
+std::set<std::string> getColumnLabels(Filter const& expression);
+
+/// Function to check compatibility of a table with given column hashes with operation sequence
+bool isTableCompatible(std::set<size_t> const& hashes, Operations const& specs);
+
 /// Function to check compatibility of a given arrow schema with operation sequence
 bool isSchemaCompatible(gandiva::SchemaPtr const& Schema, Operations const& opSpecs);
 /// Function to create gandiva expression tree from operation sequence
@@ -359,6 +367,20 @@ std::shared_ptr<gandiva::Projector> createProjector(gandiva::SchemaPtr const& Sc
 std::shared_ptr<gandiva::Projector> createProjector(gandiva::SchemaPtr const& Schema,
                                                     Projector&& p,
                                                     gandiva::FieldPtr result);
+/// Function to create gandiva projector from gandiva expressions
+std::shared_ptr<gandiva::Projector> createProjector(gandiva::SchemaPtr const& Schema,
+                                                    gandiva::ExpressionVector const& expressions);
+
+/// Gandiva filters and projectors are compiled once per process for a given
+/// schema and expression, and then reused by all the tables / tasks needing them.
+/// Statistics of this cache.
+struct CompilationCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  /// Total time spent compiling, in microseconds
+  uint64_t compileTime = 0;
+};
+CompilationCacheStats compilationCacheStats();
 /// Function for attaching gandiva filters to to compatible task inputs
 void updateExpressionInfos(expressions::Filter const& filter, std::vector<ExpressionInfo>& eInfos);
 /// Function to create gandiva condition expression from generic gandiva expression tree
@@ -368,23 +390,35 @@ gandiva::ExpressionPtr makeExpression(gandiva::NodePtr node, gandiva::FieldPtr r
 /// Update placeholder nodes from context
 void updatePlaceholders(Filter& filter, InitContext& context);
 
+/// Range of the values of a column in a block of rows
+struct ColumnRange {
+  double min;
+  double max;
+};
+using ColumnRanges = std::function<std::optional<ColumnRange>(std::string const&)>;
+
+/// Serialized range predicate of an expression tree: the comparisons of
+/// columns with literals, combined with && and ||. Any other subexpression,
+/// including those depending on configurables, is replaced by a term which
+/// is always true, so that the predicate holds for all the rows which pass
+/// the expression.
+std::string rangePredicate(Node const& node);
+/// Expression tree of a serialized range predicate
+Node parseRangePredicate(std::string const& predicate);
+/// Whether some row with the values of its columns within @a ranges may
+/// satisfy the range predicate @a node. Columns without a range may have
+/// any value.
+bool mayPass(Node const& node, ColumnRanges const& ranges);
+
 template <typename... C>
 std::shared_ptr<gandiva::Projector> createProjectors(framework::pack<C...>, gandiva::SchemaPtr schema)
 {
-  std::shared_ptr<gandiva::Projector> projector;
-  auto s = gandiva::Projector::Make(
-    schema,
-    {makeExpression(
-      framework::expressions::createExpressionTree(
-        framework::expressions::createOperations(C::Projector()),
-        schema),
-      C::asArrowField())...},
-    &projector);
-  if (s.ok()) {
-    return projector;
-  } else {
-    throw o2::framework::runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
-  }
+  return createProjector(schema,
+                         {makeExpression(
+                           framework::expressions::createExpressionTree(
+                             framework::expressions::createOperations(C::Projector()),
+                             schema),
+                           C::asArrowField())...});
 }
 } // namespace o2::framework::expressions
 
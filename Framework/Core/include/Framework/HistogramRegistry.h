@@ -22,11 +22,14 @@
 #include "Framework/SerializationMethods.h"
 #include "Framework/TableBuilder.h"
 #include "Framework/RuntimeError.h"
+#include "Framework/ProcessingPool.h"
 
 #include <TDataMember.h>
 #include <TDataType.h>
 
+#include <algorithm>
 #include <deque>
+#include <limits>
 
 class TList;
 
@@ -52,6 +55,10 @@ struct HistFiller {
   template <typename T>
   static double getSize(std::shared_ptr<T>& hist, double fillFraction = 1.);
 
+  // copy the values of column C of an arrow table, restricted to the selected rows if a selection is given
+  template <typename C>
+  static void getColumnValues(arrow::Table* table, o2::soa::SelectionVector const* selection, std::vector<double>& values);
+
  private:
   // helper function to determine base element size of histograms (in bytes)
   template <typename T>
@@ -71,14 +78,13 @@ struct HistFiller {
 //**************************************************************************************************
 class HistogramRegistry
 {
-  // HistogramName class providing the associated hash and a first guess for the index in the registry
+  // HistogramName class providing the associated hash, which also determines the first guess for the index in the registry
   struct HistName {
     // ctor for histogram names that are already hashed at compile time via HIST("myHistName")
     template <char... chars>
     constexpr HistName(const ConstStr<chars...>& hashedHistName);
     char const* const str{};
     const uint32_t hash{};
-    const uint32_t idx{};
 
    protected:
     friend class HistogramRegistry;
@@ -98,7 +104,7 @@ class HistogramRegistry
   // function to query if name is already in use
   bool contains(const HistName& histName);
 
-  // get the underlying histogram pointer
+  // get the underlying histogram pointer, which stays valid when more histograms are added
   template <typename T>
   std::shared_ptr<T>& get(const HistName& histName);
 
@@ -123,6 +129,13 @@ class HistogramRegistry
   template <typename... Cs, typename T>
   void fill(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter);
 
+  // fill hist with whole columns of a (filtered) table at once, without iterating over the rows
+  template <typename... Cs, typename T>
+  void fillColumns(const HistName& histName, const T& table);
+
+  template <typename... Cs, typename T>
+  void fillColumns(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter);
+
   // get rough estimate for size of histogram stored in registry
   double getSize(const HistName& histName, double fillFraction = 1.);
 
@@ -132,6 +145,18 @@ class HistogramRegistry
   // print summary of the histograms stored in registry
   void print(bool showAxisDetails = false);
 
+  // give each of the nSlots - 1 additional threads of a parallel processing its own copy of the histograms to fill
+  void beginParallel(int nSlots);
+
+  // add the copies filled by the additional threads to the histograms
+  void endParallel();
+
+  // buffer the fills of TH1, TH2 and TH3 histograms and apply them in batches of bufferSize entries (0 fills the histograms directly)
+  void setFillBufferSize(uint32_t bufferSize);
+
+  // apply the buffered fills to the histograms
+  void flush();
+
   // lookup distance counter for benchmarking
   mutable uint32_t lookup = 0;
 
@@ -146,13 +171,25 @@ class HistogramRegistry
   // helper function that checks if histogram name can be used in registry
   void validateHistName(const char* name, const uint32_t hash);
 
+  // store a new histogram, with a copy for each additional thread of a parallel processing
+  void insertHist(uint32_t hash, HistPtr hist);
+
   // helper function to find the histogram position in the registry
   template <typename T>
   uint32_t getHistIndex(const T& histName);
 
-  constexpr uint32_t imask(uint32_t i) const
+  // helper function to find a free position in the lookup for a new histogram, growing the lookup when it is half full
+  uint32_t getFreeIndex(uint32_t hash);
+
+  // double the size of the lookup, moving the histograms to their new positions
+  void grow();
+
+  // clone the histogram at the given index for the additional threads of a parallel processing which do not have it yet
+  void cloneToSlots(uint32_t idx);
+
+  uint32_t imask(uint32_t i) const
   {
-    return i & REGISTRY_BITMASK;
+    return i & mRegistryMask;
   }
 
   // helper function to create resp. find the subList defined by path
@@ -171,12 +208,77 @@ class HistogramRegistry
   uint32_t mTaskHash{};
   std::vector<std::string> mRegisteredNames{};
 
-  // the maximum number of histograms in buffer is currently set to 512
-  // which seems to be both reasonably large and allowing for very fast lookup
-  static constexpr uint32_t REGISTRY_BITMASK{0x1FF};
-  static constexpr uint32_t MAX_REGISTRY_SIZE{REGISTRY_BITMASK + 1};
-  std::array<uint32_t, MAX_REGISTRY_SIZE> mRegistryKey{};
-  std::array<HistPtr, MAX_REGISTRY_SIZE> mRegistryValue{};
+  // fills of a histogram which are not yet applied, with the coordinates and weights in separate arrays
+  struct FillBuffer {
+    int nDimensions{}; // 0 if the fills of the histogram are not buffered
+    std::vector<double> x{};
+    std::vector<double> y{};
+    std::vector<double> z{};
+    std::vector<double> w{};
+  };
+
+  // fill the histogram with the values of the columns Cs in the selected rows of the table
+  template <typename... Cs>
+  void fillColumns(const HistName& histName, arrow::Table* table, o2::soa::SelectionVector const* selection);
+
+  // add the fill to the buffer, if the fills of the histogram are buffered
+  template <typename... Ts>
+  static bool bufferFill(FillBuffer& buffer, Ts... positionAndWeight);
+
+  // prepare the buffers of the histogram at the given index, in all the slots
+  void setupFillBuffers(uint32_t idx);
+
+  // apply the buffered fills of the histogram at the given index in the given slot
+  void flush(int slot, uint32_t idx);
+
+  // apply the buffered fills to a histogram, with the same result as filling them one by one
+  static void applyFills(TH1* hist, FillBuffer& buffer);
+
+  // the lookup initially holds up to 512 histograms, which seems to be both
+  // reasonably large and allowing for very fast lookup, and doubles its size
+  // whenever it becomes half full, so that the probe sequences stay short
+  static constexpr uint32_t INITIAL_REGISTRY_SIZE{512};
+  static constexpr uint32_t FREE_INDEX{std::numeric_limits<uint32_t>::max()};
+  uint32_t mRegistryMask{INITIAL_REGISTRY_SIZE - 1};
+  // hash and index in mRegistryValue of the histogram at each position of the lookup
+  std::vector<uint32_t> mRegistryKey{};
+  std::vector<uint32_t> mRegistryIndex{};
+
+  // the histograms in insertion order, which never move so that the
+  // references returned by get() stay valid when the lookup grows
+  std::deque<HistPtr> mRegistryValue{};
+
+  // copies of the histograms for the additional threads of a parallel processing,
+  // which are kept for the next one but only used between beginParallel() and endParallel()
+  std::vector<std::deque<HistPtr>> mSlotRegistryValue{};
+  bool mParallel{};
+
+  // buffered fills, empty if the histograms are filled directly
+  uint32_t mFillBufferSize{};
+  std::vector<FillBuffer> mFillBuffers{};
+  std::vector<std::vector<FillBuffer>> mSlotFillBuffers{};
+
+  // the copies of the histograms used by the current thread, 0 for the histograms themselves
+  int currentSlot() const
+  {
+    if (O2_BUILTIN_UNLIKELY(mParallel)) {
+      auto slot = ProcessingSlot::current().slot;
+      if (slot > 0) {
+        return slot;
+      }
+    }
+    return 0;
+  }
+
+  std::deque<HistPtr>& values(int slot)
+  {
+    return slot == 0 ? mRegistryValue : mSlotRegistryValue[slot - 1];
+  }
+
+  std::vector<FillBuffer>& fillBuffers(int slot)
+  {
+    return slot == 0 ? mFillBuffers : mSlotFillBuffers[slot - 1];
+  }
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -234,6 +336,37 @@ void HistFiller::fillHistAny(std::shared_ptr<R>& hist, const T& table, const o2:
   }
 }
 
+template <typename C>
+void HistFiller::getColumnValues(arrow::Table* table, o2::soa::SelectionVector const* selection, std::vector<double>& values)
+{
+  using T = typename C::type;
+  static_assert(C::persistent::value && std::is_arithmetic_v<T>, "Only persistent columns of arithmetic type can be used to fill histograms.");
+  auto column = table->GetColumnByName(C::columnLabel());
+  if (!column) {
+    LOGF(FATAL, R"(Column "%s" is not part of the table.)", C::columnLabel());
+  }
+  values.clear();
+  values.reserve(selection ? selection->size() : column->length());
+  auto selected = selection ? selection->begin() : o2::soa::SelectionVector::const_iterator{};
+  int64_t offset = 0;
+  for (auto& chunk : column->chunks()) {
+    auto array = std::static_pointer_cast<o2::soa::arrow_array_for_t<T>>(chunk);
+    const int64_t length = array->length();
+    if (selection) {
+      for (; selected != selection->end() && *selected < offset + length; ++selected) {
+        values.push_back(array->Value(*selected - offset));
+      }
+    } else if constexpr (std::is_same_v<T, bool>) {
+      for (int64_t i = 0; i < length; ++i) {
+        values.push_back(array->Value(i));
+      }
+    } else {
+      values.insert(values.end(), array->raw_values(), array->raw_values() + length);
+    }
+    offset += length;
+  }
+}
+
 template <typename T>
 double HistFiller::getSize(std::shared_ptr<T>& hist, double fillFraction)
 {
@@ -323,15 +456,20 @@ int HistFiller::getBaseElementSize(T* ptr)
 template <char... chars>
 constexpr HistogramRegistry::HistName::HistName(const ConstStr<chars...>& hashedHistName)
   : str(hashedHistName.str),
-    hash(hashedHistName.hash),
-    idx(hash & REGISTRY_BITMASK)
+    hash(hashedHistName.hash)
 {
 }
 
 template <typename T>
 std::shared_ptr<T>& HistogramRegistry::get(const HistName& histName)
 {
-  if (auto histPtr = std::get_if<std::shared_ptr<T>>(&mRegistryValue[getHistIndex(histName)])) {
+  auto slot = currentSlot();
+  auto idx = getHistIndex(histName);
+  // the histogram is up to date for the caller
+  if (O2_BUILTIN_UNLIKELY(mFillBufferSize != 0)) {
+    flush(slot, idx);
+  }
+  if (auto histPtr = std::get_if<std::shared_ptr<T>>(&values(slot)[idx])) {
     return *histPtr;
   } else {
     throw runtime_error_f(R"(Histogram type specified in get<>(HIST("%s")) does not match the actual type of the histogram!)", histName.str);
@@ -348,44 +486,152 @@ template <typename T>
 void HistogramRegistry::insertClone(const HistName& histName, const std::shared_ptr<T>& originalHist)
 {
   validateHistName(histName.str, histName.hash);
-  for (auto i = 0u; i < MAX_REGISTRY_SIZE; ++i) {
-    TObject* rawPtr = nullptr;
-    std::visit([&](const auto& sharedPtr) { rawPtr = sharedPtr.get(); }, mRegistryValue[imask(histName.idx + i)]);
-    if (!rawPtr) {
-      registerName(histName.str);
-      mRegistryKey[imask(histName.idx + i)] = histName.hash;
-      mRegistryValue[imask(histName.idx + i)] = std::shared_ptr<T>(static_cast<T*>(originalHist->Clone(histName.str)));
-      lookup += i;
-      return;
-    }
-  }
-  LOGF(FATAL, R"(Internal array of HistogramRegistry "%s" is full.)", mName);
+  registerName(histName.str);
+  insertHist(histName.hash, std::shared_ptr<T>(static_cast<T*>(originalHist->Clone(histName.str))));
 }
 
 template <typename T>
 uint32_t HistogramRegistry::getHistIndex(const T& histName)
 {
-  if (O2_BUILTIN_LIKELY(histName.hash == mRegistryKey[histName.idx])) {
-    return histName.idx;
+  const uint32_t idx = imask(histName.hash);
+  if (O2_BUILTIN_LIKELY(histName.hash == mRegistryKey[idx])) {
+    return mRegistryIndex[idx];
   }
-  for (auto i = 1u; i < MAX_REGISTRY_SIZE; ++i) {
-    if (histName.hash == mRegistryKey[imask(histName.idx + i)]) {
-      return imask(histName.idx + i);
+  for (auto i = 1u; i < mRegistryKey.size(); ++i) {
+    if (histName.hash == mRegistryKey[imask(idx + i)]) {
+      return mRegistryIndex[imask(idx + i)];
     }
   }
   throw runtime_error_f(R"(Could not find histogram "%s" in HistogramRegistry "%s"!)", histName.str, mName.data());
 }
 
+template <typename... Cs, typename T>
+void HistogramRegistry::fillColumns(const HistName& histName, const T& table)
+{
+  if constexpr (o2::soa::is_soa_filtered_t<T>::value) {
+    fillColumns<Cs...>(histName, table.asArrowTable().get(), &table.getSelectedRows());
+  } else {
+    fillColumns<Cs...>(histName, table.asArrowTable().get(), nullptr);
+  }
+}
+
+template <typename... Cs, typename T>
+void HistogramRegistry::fillColumns(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter)
+{
+  auto selection = o2::soa::Filtered<T>::copySelection(o2::framework::expressions::createSelection(table.asArrowTable(), filter));
+  if constexpr (o2::soa::is_soa_filtered_t<T>::value) {
+    o2::soa::SelectionVector intersection;
+    std::set_intersection(selection.begin(), selection.end(), table.getSelectedRows().begin(), table.getSelectedRows().end(), std::back_inserter(intersection));
+    selection = std::move(intersection);
+  }
+  fillColumns<Cs...>(histName, table.asArrowTable().get(), &selection);
+}
+
+template <typename... Cs>
+void HistogramRegistry::fillColumns(const HistName& histName, arrow::Table* table, o2::soa::SelectionVector const* selection)
+{
+  constexpr int nColumns = sizeof...(Cs);
+  static_assert(nColumns > 0, "At least one column is needed to fill a histogram.");
+  auto slot = currentSlot();
+  auto idx = getHistIndex(histName);
+  if (O2_BUILTIN_UNLIKELY(mFillBufferSize != 0)) {
+    flush(slot, idx);
+  }
+  std::array<std::vector<double>, nColumns> columns;
+  int column = 0;
+  (HistFiller::getColumnValues<Cs>(table, selection, columns[column++]), ...);
+
+  std::visit([&columns](auto&& hist) {
+    using H = typename std::decay_t<decltype(hist)>::element_type;
+    if constexpr (std::is_same_v<TH1, H> || std::is_same_v<TH2, H> || std::is_same_v<TH3, H>) {
+      // histograms with fixed dimension are binned column by column
+      const int nDimensions = hist->GetDimension();
+      if (nColumns == nDimensions || nColumns == nDimensions + 1) {
+        FillBuffer buffer{nDimensions};
+        buffer.x = std::move(columns[0]);
+        if constexpr (nColumns > 1) {
+          if (nDimensions > 1) {
+            buffer.y = std::move(columns[1]);
+          }
+        }
+        if constexpr (nColumns > 2) {
+          if (nDimensions > 2) {
+            buffer.z = std::move(columns[2]);
+          }
+        }
+        if (nColumns > nDimensions) {
+          buffer.w = std::move(columns[nColumns - 1]);
+        } else {
+          buffer.w.assign(buffer.x.size(), 1.);
+        }
+        applyFills(hist.get(), buffer);
+        return;
+      }
+    }
+    if constexpr (std::is_same_v<StepTHn, H>) {
+      LOGF(FATAL, "Table filling is not (yet?) supported for StepTHn.");
+    } else {
+      for (size_t row = 0; row < columns[0].size(); ++row) {
+        std::apply([&hist, row](auto&... values) { HistFiller::fillHistAny(hist, values[row]...); }, columns);
+      }
+    }
+  },
+             values(slot)[idx]);
+}
+
+template <typename... Ts>
+bool HistogramRegistry::bufferFill(FillBuffer& buffer, Ts... positionAndWeight)
+{
+  constexpr int nArgs = sizeof...(Ts);
+  if (buffer.nDimensions == 0 || (nArgs != buffer.nDimensions && nArgs != buffer.nDimensions + 1)) {
+    return false;
+  }
+  const double args[] = {static_cast<double>(positionAndWeight)...};
+  buffer.x.push_back(args[0]);
+  if constexpr (nArgs > 1) {
+    if (buffer.nDimensions > 1) {
+      buffer.y.push_back(args[1]);
+    }
+  }
+  if constexpr (nArgs > 2) {
+    if (buffer.nDimensions > 2) {
+      buffer.z.push_back(args[2]);
+    }
+  }
+  buffer.w.push_back(nArgs > buffer.nDimensions ? args[nArgs - 1] : 1.);
+  return true;
+}
+
 template <typename... Ts>
 void HistogramRegistry::fill(const HistName& histName, Ts&&... positionAndWeight)
 {
-  std::visit([&positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, std::forward<Ts>(positionAndWeight)...); }, mRegistryValue[getHistIndex(histName)]);
+  auto slot = currentSlot();
+  auto idx = getHistIndex(histName);
+  if (O2_BUILTIN_UNLIKELY(mFillBufferSize != 0)) {
+    if constexpr (sizeof...(Ts) >= 1 && sizeof...(Ts) <= 4 && (std::is_arithmetic_v<std::decay_t<Ts>> && ...)) {
+      auto& buffer = fillBuffers(slot)[idx];
+      if (bufferFill(buffer, positionAndWeight...)) {
+        if (buffer.w.size() >= mFillBufferSize) {
+          flush(slot, idx);
+        }
+        return;
+      }
+    }
+    // keep the order of the fills
+    flush(slot, idx);
+  }
+  std::visit([&positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, std::forward<Ts>(positionAndWeight)...); }, values(slot)[idx]);
 }
 
 template <typename... Cs, typename T>
 void HistogramRegistry::fill(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter)
 {
-  std::visit([&table, &filter](auto&& hist) { HistFiller::fillHistAny<Cs...>(hist, table, filter); }, mRegistryValue[getHistIndex(histName)]);
+  auto slot = currentSlot();
+  auto idx = getHistIndex(histName);
+  if (O2_BUILTIN_UNLIKELY(mFillBufferSize != 0)) {
+    flush(slot, idx);
+  }
+  std::visit([&table, &filter](auto&& hist) { HistFiller::fillHistAny<Cs...>(hist, table, filter); }, values(slot)[idx]);
 }
 
 } // namespace o2::framework
@@ -25,6 +25,7 @@
 
 #include <cassert>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -37,6 +38,7 @@ namespace o2
 namespace framework
 {
 class Output;
+class MessagePool;
 
 class MessageContext
 {
@@ -540,6 +542,24 @@ class MessageContext
   FairMQMessagePtr createMessage(const std::string& channel, int index, size_t size);
   FairMQMessagePtr createMessage(const std::string& channel, int index, void* data, size_t size, fairmq_free_fn* ffn, void* hint);
 
+  /// Serve the small messages created via createMessage(channel, index, size)
+  /// out of @a pool, recycling their memory once released downstream.
+  void setPool(std::shared_ptr<MessagePool> pool)
+  {
+    mPool = std::move(pool);
+  }
+
+  MessagePool* pool()
+  {
+    return mPool.get();
+  }
+
+  /// The pool, to be shared with the contexts of the other streams.
+  std::shared_ptr<MessagePool> sharedPool()
+  {
+    return mPool;
+  }
+
   /// return the header of the 1st (from the end) matching message checking first in
   /// mMessages then in mScheduledMessages
   o2::header::DataHeader* findMessageHeader(const Output& spec);
@@ -550,6 +570,7 @@ class MessageContext
   Messages mScheduledMessages;
   DispatchControl mDispatchControl;
   std::unordered_map<std::string, std::unique_ptr<std::string>> mChannelRefs;
+  std::shared_ptr<MessagePool> mPool;
 };
 } // namespace framework
 } // namespace o2
@@ -0,0 +1,101 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_MESSAGEPOOL_H_
+#define O2_FRAMEWORK_MESSAGEPOOL_H_
+
+#include <fairmq/FairMQMessage.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FairMQDevice;
+class FairMQUnmanagedRegion;
+
+namespace o2::framework
+{
+
+/// Pool of small messages, carved out of one FairMQ unmanaged region per
+/// channel. Blocks are handed out in power of two size classes and, once
+/// the consumers of a message release it, the region callback puts its
+/// block back in the free list of its class, so that the shared memory
+/// is recycled rather than allocated again for every output.
+/// Requests which cannot be served (too large, region exhausted, transport
+/// without region support) are left to the caller.
+class MessagePool
+{
+ public:
+  /// Smallest block, which is also the alignment of all the blocks.
+  static constexpr size_t MinBlockSize = 64;
+  static constexpr int NSizeClasses = 11;
+  /// Largest message served by the pool.
+  static constexpr size_t MaxBlockSize = MinBlockSize << (NSizeClasses - 1);
+
+  /// @a regionSize is the size of the region created for each channel.
+  /// A pool can be shared by several threads.
+  MessagePool(FairMQDevice* device, size_t regionSize);
+  ~MessagePool();
+  MessagePool(MessagePool const&) = delete;
+  MessagePool& operator=(MessagePool const&) = delete;
+
+  /// Create a message of @a size bytes for @a channel out of the pool.
+  /// Returns nullptr if the pool cannot serve it.
+  FairMQMessagePtr create(std::string const& channel, size_t size);
+
+  /// Number of messages served with a recycled block
+  uint64_t hits() const { return mHits.load(std::memory_order_relaxed); }
+  /// Number of messages which needed a new block or could not be served
+  uint64_t misses() const { return mMisses.load(std::memory_order_relaxed); }
+
+  /// Time (in ms) of the last report of the pool metrics.
+  uint64_t lastReportTimestamp = 0;
+
+  /// Size class of a message of @a size bytes, -1 if too large for the pool.
+  static int sizeClass(size_t size)
+  {
+    size_t blockSize = MinBlockSize;
+    for (int sc = 0; sc < NSizeClasses; ++sc, blockSize <<= 1) {
+      if (size <= blockSize) {
+        return sc;
+      }
+    }
+    return -1;
+  }
+
+ private:
+  struct ChannelPool {
+    char* next = nullptr; /// first byte of the region never handed out
+    char* end = nullptr;
+    std::mutex mutex; /// the region callback comes from a FairMQ thread
+    std::array<std::vector<void*>, NSizeClasses> free;
+    /// Declared last so that it is destroyed first: the release callbacks
+    /// which may still be invoked by its destruction use the members above.
+    std::unique_ptr<FairMQUnmanagedRegion> region;
+  };
+
+  ChannelPool* getChannelPool(std::string const& channel);
+
+  FairMQDevice* mDevice = nullptr;
+  size_t mRegionSize = 0;
+  std::mutex mPoolsMutex; /// the pools are shared by the worker streams
+  std::unordered_map<std::string, std::unique_ptr<ChannelPool>> mPools;
+  std::atomic<uint64_t> mHits = 0;
+  std::atomic<uint64_t> mMisses = 0;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_MESSAGEPOOL_H_
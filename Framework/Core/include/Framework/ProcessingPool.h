@@ -0,0 +1,83 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_PROCESSINGPOOL_H_
+#define O2_FRAMEWORK_PROCESSINGPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Position of the current thread in a parallel invocation of a
+/// process function. Both are -1 outside of it.
+struct ProcessingSlot {
+  /// Worker running on the thread, 0 being the thread which started the
+  /// invocation.
+  int slot = -1;
+  /// Chunk of grouping rows being processed by the thread.
+  int chunk = -1;
+
+  static ProcessingSlot& current();
+};
+
+/// Threads running the chunks of grouping rows of the process functions
+/// of a reentrant analysis task. Each free thread picks the next chunk
+/// still to be processed, so that a few large groups do not stall the
+/// others. The thread calling run() takes part in the processing as
+/// slot 0.
+class ProcessingPool
+{
+ public:
+  /// Number of chunks per slot in which the grouping rows are split, to
+  /// balance the load of the threads.
+  static constexpr int ChunksPerSlot = 8;
+
+  /// @a nSlots is the total number of threads processing the chunks,
+  /// including the calling one.
+  explicit ProcessingPool(int nSlots);
+  ~ProcessingPool();
+  ProcessingPool(ProcessingPool const&) = delete;
+  ProcessingPool& operator=(ProcessingPool const&) = delete;
+
+  int size() const { return static_cast<int>(mThreads.size()) + 1; }
+
+  /// Invoke @a job for each chunk in [0, @a nChunks) and wait for all of
+  /// them to be done. The first exception thrown by a job is rethrown
+  /// once the others are done, the chunks not yet started are dropped.
+  void run(int nChunks, std::function<void(int)> const& job);
+
+ private:
+  void loop(int slot);
+  void work(int slot);
+
+  std::vector<std::thread> mThreads;
+  std::mutex mMutex;
+  std::condition_variable mStartCondition;
+  std::condition_variable mDoneCondition;
+  uint64_t mGeneration = 0;
+  bool mStop = false;
+  int mRunning = 0;
+  std::function<void(int)> const* mJob = nullptr;
+  int mNChunks = 0;
+  std::atomic<int> mNextChunk = 0;
+  std::exception_ptr mError;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_PROCESSINGPOOL_H_
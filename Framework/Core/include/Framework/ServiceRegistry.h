@@ -109,7 +109,7 @@ struct ServiceRegistry {
 
   ServiceRegistry(ServiceRegistry const& other)
   {
-    for (size_t i = 0; i < MAX_SERVICES; ++i) {
+    for (size_t i = 0; i < mServicesKey.size(); ++i) {
       mServicesKey[i].store(other.mServicesKey[i].load());
     }
     mServicesValue = other.mServicesValue;
@@ -121,7 +121,7 @@ struct ServiceRegistry {
 
   ServiceRegistry& operator=(ServiceRegistry const& other)
   {
-    for (size_t i = 0; i < MAX_SERVICES; ++i) {
+    for (size_t i = 0; i < mServicesKey.size(); ++i) {
       mServicesKey[i].store(other.mServicesKey[i].load());
     }
     mServicesValue = other.mServicesValue;
@@ -138,6 +138,13 @@ struct ServiceRegistry {
   void preProcessingCallbacks(ProcessingContext&);
   /// Invoke callbacks to be executed after every process method invokation
   void postProcessingCallbacks(ProcessingContext&);
+  /// Invoke callbacks to be executed before every process method invokation
+  /// on a worker stream. The services of kind "Stream" are skipped, the
+  /// stream has its own instances of them, with their own callbacks.
+  void preWorkerProcessingCallbacks(ProcessingContext&);
+  /// Invoke callbacks to be executed after every process method invokation
+  /// on a worker stream, skipping the services of kind "Stream".
+  void postWorkerProcessingCallbacks(ProcessingContext&);
   /// Invoke callbacks to be executed before every dangling check
   void preDanglingCallbacks(DanglingContext&);
   /// Invoke callbacks to be executed after every dangling check
@@ -152,17 +159,34 @@ struct ServiceRegistry {
   /// Invoke callbacks on exit.
   void preExitCallbacks();
 
-  /// Declare a service by its ServiceSpec. If of type Global
-  /// / Serial it will be immediately registered for tid 0,
-  /// so that subsequent gets will ultimately use it.
-  /// If it is of kind "Stream" we will create the Service only
-  /// when requested by a given thread. This function is not
-  /// thread safe.
+  /// Declare a service by its ServiceSpec. An instance is
+  /// immediately registered for tid 0, so that subsequent gets
+  /// will ultimately use it. If it is of kind "Stream", the
+  /// instance of tid 0 is used only by the threads which did
+  /// not register their own one. Registries of other streams
+  /// are created with makeStreamRegistry. Stream services are
+  /// looked up without caching, so declare them as "Stream"
+  /// only when the device has worker streams.
+  /// This function is not thread safe.
   void declareService(ServiceSpec const& spec, DeviceState& state, fair::mq::ProgOptions& options);
 
   /// Bind the callbacks of a service spec to a given service.
   void bindService(ServiceSpec const& spec, void* service);
 
+  /// Create a new instance of all the declared services of kind "Stream",
+  /// to be used by a single worker thread. The processing callbacks of the
+  /// new instances are returned in @a preProcessing and @a postProcessing,
+  /// rather than being bound to the registry.
+  std::vector<ServiceHandle> createStreamServices(DeviceState& state, fair::mq::ProgOptions& options,
+                                                  std::vector<ServiceProcessingHandle>& preProcessing,
+                                                  std::vector<ServiceProcessingHandle>& postProcessing);
+
+  /// @return a copy of the registry in which the services of kind "Stream"
+  /// are the instances in @a handles, created by createStreamServices,
+  /// whatever the thread looking them up. This is the view of the services
+  /// used for everything related to the processing of a given stream.
+  ServiceRegistry makeStreamRegistry(std::vector<ServiceHandle> const& handles) const;
+
   /// Type erased service registration. @a typeHash is the
   /// hash used to identify the service, @a service is
   /// a type erased pointer to the service itself.
@@ -182,6 +206,10 @@ struct ServiceRegistry {
     auto threadHashId = (typeHash ^ threadId) & MAX_SERVICES_MASK;
     for (uint8_t i = 0; i < MAX_DISTANCE; ++i) {
       if (mServicesKey[i + threadHashId].load() == typeHash) {
+        // Stream services have one instance per thread, skip the ones of the other threads.
+        if (mServicesMeta[i + threadHashId].kind == ServiceKind::Stream && mServicesMeta[i + threadHashId].threadId != threadId) {
+          continue;
+        }
         return i + threadHashId;
       }
     }
@@ -218,10 +246,13 @@ struct ServiceRegistry {
     }
     // We are looking up a service which is not of
     // stream kind and was not looked up by this thread
-    // before.
+    // before. Threads which do not have their own instance
+    // of a stream service use the one of the main thread,
+    // without caching it, so that it can still be
+    // overridden later on.
     if (threadId != 0) {
       int pos = getPos(typeHash, 0);
-      if (pos != -1 && kind != ServiceKind::Stream) {
+      if (pos != -1 && kind != ServiceKind::Stream && mServicesMeta[pos].kind != ServiceKind::Stream) {
         mServicesKey[pos].load();
         std::atomic_thread_fence(std::memory_order_acquire);
         registerService(typeHash, mServicesValue[pos], kind, threadId, name);
@@ -155,6 +155,7 @@ struct ServiceConfigureHandle {
 struct ServiceProcessingHandle {
   ServiceProcessingCallback callback;
   void* service;
+  ServiceKind kind = ServiceKind::Serial;
 };
 
 struct ServiceDanglingHandle {
@@ -134,13 +134,28 @@ class TreeToTable
   // add all branches in @a tree as columns
   bool addAllColumns(TTree* tree);
 
-  // do the looping with the TTreeReader
+  // copy the branches to the columns cluster by cluster, reading whole
+  // baskets at once whenever the branch supports bulk reading and entry by
+  // entry otherwise
   void fill(TTree* tree);
 
   // create the table
   std::shared_ptr<arrow::Table> finalize();
 };
 
+// -----------------------------------------------------------------------------
+// hash of the names and types of the fields of @a schema, stored by
+// TableToTree as "schema-hash" parameter of the user info of the tree, so
+// that tables saved by an older version of the data model can be told apart
+uint32_t schemaHash(arrow::Schema const& schema);
+
+// numbers of rows of the tables an index was built from, kept as
+// "source-rows:<i>" schema metadata of the index. TableToTree stores them
+// with the tree and TreeToTable restores them, so that a stored index is
+// only reused with the tables it was built from
+std::shared_ptr<arrow::Table> withSourceRows(std::shared_ptr<arrow::Table> const& table, std::vector<int64_t> const& rows);
+std::vector<int64_t> getSourceRows(arrow::Schema const& schema);
+
 // -----------------------------------------------------------------------------
 } // namespace o2::framework
 
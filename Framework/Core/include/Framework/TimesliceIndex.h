@@ -16,8 +16,11 @@
 #include "Framework/CompilerBuiltins.h"
 #include "Framework/ServiceHandle.h"
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace o2::framework
@@ -48,7 +51,10 @@ class TimesliceIndex
 {
  public:
   /// TimesliceIndex is threadsafe because it's accessed only by the
-  /// DataRelayer.
+  /// DataRelayer. Calls modifying the association between slots and
+  /// timeslices must be exclusive, while the per-slot state (dirty flag,
+  /// variables of an already associated slot) can be updated concurrently
+  /// for different slots.
   constexpr static ServiceKind service_kind = ServiceKind::Global;
 
   /// What to do when there is backpressure
@@ -85,6 +91,16 @@ class TimesliceIndex
   /// could correspond to different slots once we implement wildcards
   /// (e.g. if we ask for InputSpec{"*", "CLUSTERS"}).
   inline TimesliceId getTimesliceForSlot(TimesliceSlot slot) const;
+  /// Given a @a timeslice, @return a valid slot associated to it, if any,
+  /// without evaluating the variables of every slot. In case several slots
+  /// hold the same timeslice, only one of them is found. The variables of the
+  /// slots are not read, so that this can be called while the variables of
+  /// an associated slot are being updated under its lock.
+  inline TimesliceSlot findSlot(TimesliceId timeslice) const;
+  /// Register the timeslice currently held by the variables of @a slot in the
+  /// timeslice to slot lookup. Needed only when the variables were
+  /// filled directly via getVariablesForSlot().
+  inline void indexSlot(TimesliceSlot slot);
   /// Given @a slot, @return the firstTFOrbit (i.e. the variable at positiorn 15)
   /// associated to it.
   inline uint32_t getFirstTFOrbitForSlot(TimesliceSlot slot) const;
@@ -112,6 +128,9 @@ class TimesliceIndex
   /// This is the timeslices for all the in flight parts.
   inline TimesliceSlot findOldestSlot() const;
 
+  /// Remove the lookup entry of the timeslice currently held by @a slot
+  inline void unindexSlot(TimesliceSlot slot);
+
   /// The variables for each cacheline.
   std::vector<data_matcher::VariableContext> mVariables;
 
@@ -119,8 +138,16 @@ class TimesliceIndex
   std::vector<data_matcher::VariableContext> mPublishedVariables;
 
   /// This keeps track whether or not something was relayed
-  /// since last time we called getReadyToProcess()
-  std::vector<bool> mDirty;
+  /// since last time we called getReadyToProcess(). One byte
+  /// per slot, so that different slots can be marked concurrently.
+  std::vector<uint8_t> mDirty;
+
+  /// Lookup of the slot holding a given timeslice
+  std::unordered_map<size_t, size_t> mSlotForTimeslice;
+
+  /// Timeslice registered for each slot in the lookup, used to validate its
+  /// entries without reading the slot variables.
+  std::unique_ptr<std::atomic<size_t>[]> mIndexedTimeslices;
 
   /// What to do in case of backpressure
   BackpressureOp mBackpressurePolicy = BackpressureOp::Wait;
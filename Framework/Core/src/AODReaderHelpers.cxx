@@ -83,10 +83,49 @@ static inline auto extractOriginalsTuple(framework::pack<Os...>, ProcessingConte
   return std::make_tuple(extractTypedOriginal<Os>(pc)...);
 }
 
+template <typename F>
+static inline auto withIndexMetadata(header::DataDescription description, F&& f)
+{
+  if (description == header::DataDescription{"MA_RN2_EX"}) {
+    return f(o2::aod::Run2MatchedExclusiveMetadata{});
+  } else if (description == header::DataDescription{"MA_RN2_SP"}) {
+    return f(o2::aod::Run2MatchedSparseMetadata{});
+  } else if (description == header::DataDescription{"MA_RN3_EX"}) {
+    return f(o2::aod::Run3MatchedExclusiveMetadata{});
+  } else if (description == header::DataDescription{"MA_RN3_SP"}) {
+    return f(o2::aod::Run3MatchedSparseMetadata{});
+  } else if (description == header::DataDescription{"MA_BCCOL_EX"}) {
+    return f(o2::aod::MatchedBCCollisionsExclusiveMetadata{});
+  } else if (description == header::DataDescription{"MA_BCCOL_SP"}) {
+    return f(o2::aod::MatchedBCCollisionsSparseMetadata{});
+  } else if (description == header::DataDescription{"MA_RN3_BC_SP"}) {
+    return f(o2::aod::Run3MatchedToBCSparseMetadata{});
+  } else if (description == header::DataDescription{"MA_RN3_BC_EX"}) {
+    return f(o2::aod::Run3MatchedToBCExclusiveMetadata{});
+  } else if (description == header::DataDescription{"MA_RN2_BC_SP"}) {
+    return f(o2::aod::Run2MatchedToBCSparseMetadata{});
+  }
+  throw std::runtime_error("Not an index table");
+}
+
+uint32_t AODReaderHelpers::indexSchemaHash(header::DataDescription description)
+{
+  return withIndexMetadata(description, [](auto metadata) {
+    using index_pack_t = typename decltype(metadata)::index_pack_t;
+    return schemaHash(*o2::soa::createSchemaFromColumns(index_pack_t{}));
+  });
+}
+
 AlgorithmSpec AODReaderHelpers::indexBuilderCallback(std::vector<InputSpec> requested)
 {
   return AlgorithmSpec::InitCallback{[requested](InitContext& ic) {
-    return [requested](ProcessingContext& pc) {
+    // the tables of an index are read and matched on several threads
+    std::shared_ptr<ProcessingPool> pool;
+    auto nThreads = ic.options().get<int>("index-builder-threads");
+    if (nThreads > 1) {
+      pool = std::make_shared<ProcessingPool>(nThreads);
+    }
+    return [requested, pool](ProcessingContext& pc) {
       auto outputs = pc.outputs();
       // spawn tables
       for (auto& input : requested) {
@@ -102,43 +141,45 @@ AlgorithmSpec AODReaderHelpers::indexBuilderCallback(std::vector<InputSpec> requ
             [](auto&&) { return header::DataOrigin{""}; }},
           input.matcher);
 
-        auto maker = [&](auto metadata) {
+        // with --aod-stored-indices the reader provides the index saved in
+        // the input file, which is empty if there is none or if it was
+        // saved with a different schema
+        std::shared_ptr<arrow::Table> stored;
+        auto storedBinding = "stored-" + input.binding;
+        if (pc.inputs().getPos(storedBinding) >= 0) {
+          stored = pc.inputs().get<TableConsumer>(storedBinding)->asArrowTable();
+        }
+
+        auto maker = [&](auto metadata) -> std::shared_ptr<arrow::Table> {
           using metadata_t = decltype(metadata);
           using Key = typename metadata_t::Key;
           using index_pack_t = typename metadata_t::index_pack_t;
           using sources = typename metadata_t::originals;
+          auto key = extractTypedOriginal<Key>(pc);
+          auto tables = extractOriginalsTuple(sources{}, pc);
+          // the index is kept with the numbers of rows of its sources, a
+          // stored one is reused only for tables of the same sizes
+          auto rows = std::apply([](auto const&... t) { return std::vector<int64_t>{static_cast<int64_t>(t.size())...}; }, tables);
+          if (stored && stored->num_columns() > 0 && getSourceRows(*stored->schema()) == rows &&
+              schemaHash(*stored->schema()) == schemaHash(*o2::soa::createSchemaFromColumns(index_pack_t{}))) {
+            return withSourceRows(stored->ReplaceSchemaMetadata(std::make_shared<arrow::KeyValueMetadata>(std::vector{std::string{"label"}}, std::vector{input.binding})), rows);
+          }
           if constexpr (metadata_t::exclusive == true) {
-            return o2::framework::IndexExclusive::indexBuilder(input.binding.c_str(), index_pack_t{},
-                                                               extractTypedOriginal<Key>(pc),
-                                                               extractOriginalsTuple(sources{}, pc));
+            return withSourceRows(o2::framework::IndexExclusive::indexBuilder(input.binding.c_str(), index_pack_t{},
+                                                                              key,
+                                                                              tables,
+                                                                              pool.get()),
+                                  rows);
           } else {
-            return o2::framework::IndexSparse::indexBuilder(input.binding.c_str(), index_pack_t{},
-                                                            extractTypedOriginal<Key>(pc),
-                                                            extractOriginalsTuple(sources{}, pc));
+            return withSourceRows(o2::framework::IndexSparse::indexBuilder(input.binding.c_str(), index_pack_t{},
+                                                                           key,
+                                                                           tables,
+                                                                           pool.get()),
+                                  rows);
           }
         };
 
-        if (description == header::DataDescription{"MA_RN2_EX"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run2MatchedExclusiveMetadata{}));
-        } else if (description == header::DataDescription{"MA_RN2_SP"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run2MatchedSparseMetadata{}));
-        } else if (description == header::DataDescription{"MA_RN3_EX"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run3MatchedExclusiveMetadata{}));
-        } else if (description == header::DataDescription{"MA_RN3_SP"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run3MatchedSparseMetadata{}));
-        } else if (description == header::DataDescription{"MA_BCCOL_EX"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::MatchedBCCollisionsExclusiveMetadata{}));
-        } else if (description == header::DataDescription{"MA_BCCOL_SP"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::MatchedBCCollisionsSparseMetadata{}));
-        } else if (description == header::DataDescription{"MA_RN3_BC_SP"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run3MatchedToBCSparseMetadata{}));
-        } else if (description == header::DataDescription{"MA_RN3_BC_EX"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run3MatchedToBCExclusiveMetadata{}));
-        } else if (description == header::DataDescription{"MA_RN2_BC_SP"}) {
-          outputs.adopt(Output{origin, description}, maker(o2::aod::Run2MatchedToBCSparseMetadata{}));
-        } else {
-          throw std::runtime_error("Not an index table");
-        }
+        outputs.adopt(Output{origin, description}, withIndexMetadata(description, maker));
       }
     };
   }};
@@ -13,9 +13,150 @@
 #include "ArrowDebugHelpers.h"
 #include "Framework/RuntimeError.h"
 #include <arrow/util/key_value_metadata.h>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
 
 namespace o2::soa
 {
+namespace
+{
+// rows of a selection are combined as bitmaps when at least one in BitmapDensity rows of their range is selected
+constexpr int64_t BitmapDensity = 32;
+
+bool isContiguous(SelectionVector const& selection)
+{
+  return selection.back() - selection.front() + 1 == static_cast<int64_t>(selection.size());
+}
+
+bool isDense(size_t nRows, int64_t first, int64_t last)
+{
+  return static_cast<int64_t>(nRows) * BitmapDensity >= last - first + 1;
+}
+
+// set the bits of the rows of the selection in [first, last]
+void fillBitmap(SelectionVector const& selection, int64_t first, int64_t last, std::vector<uint64_t>& bitmap)
+{
+  bitmap.assign((last - first) / 64 + 1, 0);
+  auto begin = std::lower_bound(selection.begin(), selection.end(), first);
+  auto end = std::upper_bound(begin, selection.end(), last);
+  for (auto row = begin; row != end; ++row) {
+    bitmap[(*row - first) >> 6] |= uint64_t{1} << ((*row - first) & 63);
+  }
+}
+
+SelectionVector rowsFromBitmap(std::vector<uint64_t> const& bitmap, int64_t first)
+{
+  size_t nRows = 0;
+  for (auto word : bitmap) {
+    nRows += __builtin_popcountll(word);
+  }
+  SelectionVector rows;
+  rows.reserve(nRows);
+  for (size_t i = 0; i < bitmap.size(); ++i) {
+    for (auto word = bitmap[i]; word != 0; word &= word - 1) {
+      rows.push_back(first + 64 * static_cast<int64_t>(i) + __builtin_ctzll(word));
+    }
+  }
+  return rows;
+}
+} // namespace
+
+SelectionVector selectionUnion(SelectionVector const& a, SelectionVector const& b)
+{
+  if (a.empty()) {
+    return b;
+  }
+  if (b.empty()) {
+    return a;
+  }
+  const int64_t first = std::min(a.front(), b.front());
+  const int64_t last = std::max(a.back(), b.back());
+  if (isContiguous(a) && isContiguous(b) && a.front() <= b.back() + 1 && b.front() <= a.back() + 1) {
+    SelectionVector rows(last - first + 1);
+    std::iota(rows.begin(), rows.end(), first);
+    return rows;
+  }
+  if (isDense(a.size() + b.size(), first, last)) {
+    std::vector<uint64_t> bitmap;
+    std::vector<uint64_t> other;
+    fillBitmap(a, first, last, bitmap);
+    fillBitmap(b, first, last, other);
+    for (size_t i = 0; i < bitmap.size(); ++i) {
+      bitmap[i] |= other[i];
+    }
+    return rowsFromBitmap(bitmap, first);
+  }
+  SelectionVector rows;
+  rows.reserve(a.size() + b.size());
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(rows));
+  return rows;
+}
+
+SelectionVector selectionIntersection(SelectionVector const& a, SelectionVector const& b)
+{
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+  const int64_t first = std::max(a.front(), b.front());
+  const int64_t last = std::min(a.back(), b.back());
+  if (first > last) {
+    return {};
+  }
+  // a contiguous selection only restricts the range of the other one
+  if (isContiguous(a) || isContiguous(b)) {
+    auto const& other = isContiguous(a) ? b : a;
+    auto begin = std::lower_bound(other.begin(), other.end(), first);
+    return SelectionVector(begin, std::upper_bound(begin, other.end(), last));
+  }
+  if (isDense(std::min(a.size(), b.size()), first, last)) {
+    std::vector<uint64_t> bitmap;
+    std::vector<uint64_t> other;
+    fillBitmap(a, first, last, bitmap);
+    fillBitmap(b, first, last, other);
+    for (size_t i = 0; i < bitmap.size(); ++i) {
+      bitmap[i] &= other[i];
+    }
+    return rowsFromBitmap(bitmap, first);
+  }
+  SelectionVector rows;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(rows));
+  return rows;
+}
+
+namespace
+{
+template <typename ARRAY>
+void copyIndices(arrow::Array const& indices, SelectionVector& rows)
+{
+  auto values = static_cast<ARRAY const&>(indices).raw_values();
+  std::copy(values, values + rows.size(), rows.begin());
+}
+} // namespace
+
+SelectionVector selectedRows(gandiva::SelectionVector const& selection)
+{
+  SelectionVector rows(selection.GetNumSlots());
+  if (rows.empty()) {
+    return rows;
+  }
+  switch (selection.GetMode()) {
+    case gandiva::SelectionVector::MODE_UINT16:
+      copyIndices<arrow::UInt16Array>(*selection.ToArray(), rows);
+      break;
+    case gandiva::SelectionVector::MODE_UINT32:
+      copyIndices<arrow::UInt32Array>(*selection.ToArray(), rows);
+      break;
+    case gandiva::SelectionVector::MODE_UINT64:
+      copyIndices<arrow::UInt64Array>(*selection.ToArray(), rows);
+      break;
+    default:
+      for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = selection.GetIndex(i);
+      }
+  }
+  return rows;
+}
 
 std::shared_ptr<arrow::Table> ArrowHelpers::joinTables(std::vector<std::shared_ptr<arrow::Table>>&& tables)
 {
@@ -90,11 +231,17 @@ std::shared_ptr<arrow::Table> ArrowHelpers::concatTables(std::vector<std::shared
   return result;
 }
 
+void missingColumn()
+{
+  o2::framework::throw_error(o2::framework::runtime_error("Accessing a column which is not in the table. Tables read from file only have the columns requested by the workflow."));
+}
+
 arrow::ChunkedArray* getIndexFromLabel(arrow::Table* table, const char* label)
 {
+  // the columns not needed by the workflow may not have been read
   auto index = table->schema()->GetAllFieldIndices(label);
   if (index.empty() == true) {
-    o2::framework::throw_error(o2::framework::runtime_error_f("Unable to find column with label %s", label));
+    return nullptr;
   }
   return table->column(index[0]).get();
 }
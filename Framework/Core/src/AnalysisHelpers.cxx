@@ -16,8 +16,87 @@
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RArrowDS.hxx>
 
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
 using namespace ROOT::RDF;
 
+namespace o2::framework
+{
+void setFilterPredicates(std::vector<InputSpec>& inputs, std::vector<std::string> const& predicates)
+{
+  auto isFilter = [](ConfigParamSpec const& spec) { return spec.name == "aod-filter"; };
+  auto isColumns = [](ConfigParamSpec const& spec) { return spec.name == "aod-columns"; };
+
+  // an input can be used by several arguments, all of them must be filtered
+  std::map<std::string, std::string> combined;
+  std::set<std::string> unfiltered;
+  for (auto& input : inputs) {
+    std::string predicate = "true";
+    auto filter = std::find_if(input.metadata.begin(), input.metadata.end(), isFilter);
+    if (filter != input.metadata.end() && !predicates[filter->defaultValue.get<int>()].empty()) {
+      predicate = predicates[filter->defaultValue.get<int>()];
+    }
+    if (predicate == "true") {
+      unfiltered.insert(input.binding);
+      continue;
+    }
+    auto& inputPredicate = combined[input.binding];
+    inputPredicate = inputPredicate.empty() ? predicate : "or " + inputPredicate + " " + predicate;
+  }
+
+  for (auto& input : inputs) {
+    input.metadata.erase(std::remove_if(input.metadata.begin(), input.metadata.end(), isFilter), input.metadata.end());
+    // only the tables which can come from the reader
+    if (unfiltered.count(input.binding) != 0 || std::none_of(input.metadata.begin(), input.metadata.end(), isColumns)) {
+      continue;
+    }
+    input.metadata.push_back(ConfigParamSpec{"aod-filter", VariantType::String, combined[input.binding], {"\"\""}});
+  }
+}
+
+void matchIndexKeys(std::vector<int32_t> const& keys, std::vector<int32_t> const& sourceKeys, std::vector<int32_t> const& sourceRows, std::vector<int32_t>& matches)
+{
+  matches.assign(keys.size(), -1);
+  // tables grouped by their key are matched in a single pass
+  if (std::is_sorted(keys.begin(), keys.end()) && std::is_sorted(sourceKeys.begin(), sourceKeys.end())) {
+    size_t next = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (keys[i] < 0) {
+        continue;
+      }
+      while (next < sourceKeys.size() && sourceKeys[next] < keys[i]) {
+        ++next;
+      }
+      if (next < sourceKeys.size() && sourceKeys[next] == keys[i]) {
+        matches[i] = sourceRows[next++];
+      }
+    }
+    return;
+  }
+  // otherwise the rows of the source are sorted by key, keeping their order for each key
+  std::vector<int32_t> order(sourceKeys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&sourceKeys](int32_t a, int32_t b) { return sourceKeys[a] < sourceKeys[b]; });
+  std::unordered_map<int32_t, size_t> nextOfKey;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] < 0) {
+      continue;
+    }
+    auto [next, inserted] = nextOfKey.try_emplace(keys[i], 0);
+    if (inserted) {
+      next->second = std::lower_bound(order.begin(), order.end(), keys[i], [&sourceKeys](int32_t row, int32_t key) { return sourceKeys[row] < key; }) - order.begin();
+    }
+    if (next->second < order.size() && sourceKeys[order[next->second]] == keys[i]) {
+      matches[i] = sourceRows[order[next->second++]];
+    }
+  }
+}
+} // namespace o2::framework
+
 namespace o2
 {
 namespace analysis
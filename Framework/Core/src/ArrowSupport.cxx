@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 #include "ArrowSupport.h"
 #include "Framework/ArrowContext.h"
+#include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/DataProcessor.h"
 #include "Framework/ServiceRegistry.h"
 #include "Framework/DeviceSpec.h"
@@ -19,6 +20,7 @@
 #include "Framework/DeviceMetricsHelper.h"
 #include "Framework/DeviceInfo.h"
 #include "Framework/DevicesManager.h"
+#include "Framework/Expressions.h"
 
 #include "CommonMessageBackendsHelpers.h"
 #include <Monitoring/Monitoring.h>
@@ -335,6 +337,12 @@ o2::framework::ServiceSpec ArrowSupport::arrowBackendSpec()
                        auto& monitoring = ctx.services().get<Monitoring>();
                        monitoring.send(Metric{(uint64_t)arrow->bytesDestroyed(), "arrow-bytes-destroyed"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
                        monitoring.send(Metric{(uint64_t)arrow->messagesDestroyed(), "arrow-messages-destroyed"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
+                       auto gandivaStats = expressions::compilationCacheStats();
+                       if (gandivaStats.hits + gandivaStats.misses != 0) {
+                         monitoring.send(Metric{gandivaStats.hits, "gandiva-cache-hits"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
+                         monitoring.send(Metric{gandivaStats.misses, "gandiva-cache-misses"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
+                         monitoring.send(Metric{gandivaStats.compileTime / 1000, "gandiva-compile-time-ms"}.addTag(Key::Subsystem, monitoring::tags::Value::DPL));
+                       }
                        monitoring.flushBuffer();
                      },
                      nullptr,
@@ -358,4 +366,33 @@ o2::framework::ServiceSpec ArrowSupport::arrowBackendSpec()
                      ServiceKind::Global};
 }
 
+o2::framework::ServiceSpec ArrowSupport::arrowTableSlicingCacheSpec()
+{
+  return ServiceSpec{"arrow-slicing-cache",
+                     [](ServiceRegistry&, DeviceState&, fair::mq::ProgOptions&) -> ServiceHandle {
+                       return ServiceHandle{TypeIdHelpers::uniqueId<ArrowTableSlicingCache>(), new ArrowTableSlicingCache()};
+                     },
+                     CommonServices::noConfiguration(),
+                     nullptr,
+                     [](ProcessingContext&, void* service) {
+                       // The groupings are only valid for the timeframe just processed.
+                       reinterpret_cast<ArrowTableSlicingCache*>(service)->clear();
+                     },
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     ServiceKind::Stream};
+}
+
 } // namespace o2::framework
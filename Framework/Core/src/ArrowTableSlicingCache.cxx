@@ -0,0 +1,89 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/ArrowTableSlicingCache.h"
+#include "Framework/RuntimeError.h"
+
+#include <arrow/array.h>
+#include <arrow/chunked_array.h>
+#include <arrow/table.h>
+
+namespace o2::framework
+{
+
+std::shared_ptr<SliceInfo const> ArrowTableSlicingCache::getSlices(std::shared_ptr<arrow::Table> const& table, std::string const& column, int32_t groupingSize)
+{
+  auto indexColumn = table->GetColumnByName(column);
+  if (indexColumn.get() == nullptr) {
+    throw runtime_error_f("Index column %s not found", column.c_str());
+  }
+  // Different arrow::Tables created for the same message of the timeframe
+  // share the buffers, so the index column is identified by its data.
+  Key key{{}, column, groupingSize};
+  key.chunks.reserve(indexColumn->num_chunks());
+  for (auto const& chunk : indexColumn->chunks()) {
+    auto const& buffers = chunk->data()->buffers;
+    key.chunks.push_back({buffers.size() > 1 ? buffers[1] : nullptr, chunk->offset(), chunk->length()});
+  }
+  auto cached = mCache.find(key);
+  if (cached != mCache.end()) {
+    return cached->second;
+  }
+  auto slices = computeSlices(*indexColumn, groupingSize);
+  mCache.emplace(std::move(key), slices);
+  return slices;
+}
+
+void ArrowTableSlicingCache::clear()
+{
+  mCache.clear();
+}
+
+std::shared_ptr<SliceInfo const> ArrowTableSlicingCache::computeSlices(arrow::ChunkedArray const& column, int32_t groupingSize)
+{
+  if (column.type()->id() != arrow::Type::INT32) {
+    throw runtime_error_f("Cannot group by a column of type %s", column.type()->ToString().c_str());
+  }
+  auto slices = std::make_shared<SliceInfo>();
+  slices->offsets.reserve(groupingSize);
+  slices->sizes.reserve(groupingSize);
+
+  // Single pass over the index, which must be sorted: each group is
+  // contiguous and comes after the previous ones. The rows with a
+  // negative index are skipped.
+  uint64_t row = 0;
+  for (auto const& chunk : column.chunks()) {
+    auto values = std::static_pointer_cast<arrow::Int32Array>(chunk);
+    for (int64_t i = 0; i < values->length(); ++i, ++row) {
+      int32_t value = values->Value(i);
+      if (value < 0) {
+        continue;
+      }
+      auto ngroups = static_cast<int32_t>(slices->offsets.size());
+      if (value < ngroups - 1 || (value == ngroups - 1 && slices->offsets.back() + slices->sizes.back() != row)) {
+        throw runtime_error_f("Cannot group by an unsorted index: row %llu points to %d after %d", (unsigned long long)row, value, ngroups - 1);
+      }
+      for (; ngroups <= value; ++ngroups) {
+        slices->offsets.push_back(row);
+        slices->sizes.push_back(0);
+      }
+      slices->sizes.back() += 1;
+    }
+  }
+  // grouping rows without any associated row at the end
+  while (static_cast<int32_t>(slices->offsets.size()) < groupingSize) {
+    slices->offsets.push_back(row);
+    slices->sizes.push_back(0);
+  }
+  return slices;
+}
+
+} // namespace o2::framework
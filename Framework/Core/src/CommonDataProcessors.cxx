@@ -316,8 +316,9 @@ DataProcessorSpec
           continue;
         }
 
-        // skip non-AOD refs
-        if (!DataSpecUtils::partialMatch(*ref.spec, header::DataOrigin("AOD"))) {
+        // skip non-AOD refs, the built index tables can be saved too
+        if (!DataSpecUtils::partialMatch(*ref.spec, header::DataOrigin("AOD")) &&
+            !DataSpecUtils::partialMatch(*ref.spec, header::DataOrigin("IDX"))) {
           continue;
         }
         startTime = DataRefUtils::getHeader<DataProcessingHeader*>(ref)->startTime;
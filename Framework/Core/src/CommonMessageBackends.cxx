@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 #include "Framework/CommonMessageBackends.h"
 #include "Framework/MessageContext.h"
+#include "Framework/MessagePool.h"
 #include "Framework/ArrowContext.h"
 #include "Framework/StringContext.h"
 #include "Framework/RawBufferContext.h"
@@ -42,7 +43,7 @@ struct ProcessingContext;
 o2::framework::ServiceSpec CommonMessageBackends::fairMQBackendSpec()
 {
   return ServiceSpec{"fairmq-backend",
-                     [](ServiceRegistry& services, DeviceState&, fair::mq::ProgOptions&) -> ServiceHandle {
+                     [](ServiceRegistry& services, DeviceState&, fair::mq::ProgOptions& options) -> ServiceHandle {
                        auto& device = services.get<RawDeviceService>();
                        auto context = new MessageContext(FairMQDeviceProxy{device.device()});
                        auto& spec = services.get<DeviceSpec const>();
@@ -61,11 +62,39 @@ o2::framework::ServiceSpec CommonMessageBackends::fairMQBackendSpec()
                        if (spec.dispatchPolicy.action == DispatchPolicy::DispatchOp::WhenReady) {
                          context->init(DispatchControl{dispatcher, matcher});
                        }
+                       if (options.Count("message-pool-size")) {
+                         size_t poolSize = std::stoull(options.GetPropertyAsString("message-pool-size")) * 1024 * 1024;
+                         // A single pool for the device: the contexts of the
+                         // worker streams share the one of the main thread.
+                         if (poolSize && services.active<MessageContext>()) {
+                           context->setPool(services.get<MessageContext>().sharedPool());
+                         } else if (poolSize) {
+                           context->setPool(std::make_shared<MessagePool>(device.device(), poolSize));
+                         }
+                       }
                        return ServiceHandle{TypeIdHelpers::uniqueId<MessageContext>(), context};
                      },
                      CommonServices::noConfiguration(),
                      CommonMessageBackendsHelpers<MessageContext>::clearContext(),
-                     CommonMessageBackendsHelpers<MessageContext>::sendCallback(),
+                     [send = CommonMessageBackendsHelpers<MessageContext>::sendCallback()](ProcessingContext& ctx, void* service) {
+                       send(ctx, service);
+                       auto* pool = reinterpret_cast<MessageContext*>(service)->pool();
+                       if (pool == nullptr) {
+                         return;
+                       }
+                       // Report the pool usage at most once per second.
+                       uint64_t now = uv_hrtime() / 1000000;
+                       if (now - pool->lastReportTimestamp < 1000) {
+                         return;
+                       }
+                       pool->lastReportTimestamp = now;
+                       using o2::monitoring::Metric;
+                       using o2::monitoring::tags::Key;
+                       using o2::monitoring::tags::Value;
+                       auto& monitoring = ctx.services().get<Monitoring>();
+                       monitoring.send(Metric{pool->hits(), "message-pool-hits"}.addTag(Key::Subsystem, Value::DPL));
+                       monitoring.send(Metric{pool->misses(), "message-pool-misses"}.addTag(Key::Subsystem, Value::DPL));
+                     },
                      nullptr,
                      nullptr,
                      CommonMessageBackendsHelpers<MessageContext>::clearContextEOS(),
@@ -80,7 +109,7 @@ o2::framework::ServiceSpec CommonMessageBackends::fairMQBackendSpec()
                      nullptr,
                      nullptr,
                      nullptr,
-                     ServiceKind::Serial};
+                     ServiceKind::Stream};
 }
 
 o2::framework::ServiceSpec CommonMessageBackends::stringBackendSpec()
@@ -104,7 +133,7 @@ o2::framework::ServiceSpec CommonMessageBackends::stringBackendSpec()
                      nullptr,
                      nullptr,
                      nullptr,
-                     ServiceKind::Serial};
+                     ServiceKind::Stream};
 }
 
 o2::framework::ServiceSpec CommonMessageBackends::rawBufferBackendSpec()
@@ -128,7 +157,7 @@ o2::framework::ServiceSpec CommonMessageBackends::rawBufferBackendSpec()
                      nullptr,
                      nullptr,
                      nullptr,
-                     ServiceKind::Serial};
+                     ServiceKind::Stream};
 }
 
 } // namespace o2::framework
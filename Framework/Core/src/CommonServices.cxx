@@ -725,6 +725,7 @@ std::vector<ServiceSpec> CommonServices::defaultServices(int numThreads)
     dataProcessingStats(),
     CommonMessageBackends::fairMQBackendSpec(),
     ArrowSupport::arrowBackendSpec(),
+    ArrowSupport::arrowTableSlicingCacheSpec(),
     CommonMessageBackends::stringBackendSpec(),
     CommonMessageBackends::rawBufferBackendSpec()};
   if (numThreads) {
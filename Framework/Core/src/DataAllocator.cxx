@@ -106,6 +106,15 @@ FairMQMessagePtr DataAllocator::headerMessageFromOutput(Output const& spec,
   DataProcessingHeader dph{mTimingInfo->timeslice, 1};
   auto& context = mRegistry->get<MessageContext>();
 
+  // Headers are small and created for every output, so take them from the
+  // pool if there is one, at the price of copying the stack.
+  if (context.pool() != nullptr) {
+    o2::header::Stack stack{dh, dph, spec.metaHeader};
+    auto message = context.createMessage(channel, 0, stack.size());
+    memcpy(message->GetData(), stack.data(), stack.size());
+    return message;
+  }
+
   auto channelAlloc = o2::pmr::getTransportAllocator(context.proxy().getTransport(channel, 0));
   return o2::pmr::getMessage(o2::header::Stack{channelAlloc, dh, dph, spec.metaHeader});
 }
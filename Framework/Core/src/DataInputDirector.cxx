@@ -19,6 +19,9 @@
 
 #include "TGrid.h"
 #include "TObjString.h"
+#include "TParameter.h"
+#include "TROOT.h"
+#include "TTree.h"
 
 namespace o2
 {
@@ -26,6 +29,102 @@ namespace framework
 {
 using namespace rapidjson;
 
+namespace
+{
+// sorted numbers of the DF_ folders of a file
+std::vector<uint64_t> listTimeFrameNumbers(TFile* file)
+{
+  std::vector<uint64_t> numbers;
+  std::regex TFRegex = std::regex("DF_[0-9]+");
+  TList* keyList = file->GetListOfKeys();
+
+  // extract TF numbers and sort accordingly
+  for (auto key : *keyList) {
+    if (std::regex_match(((TObjString*)key)->GetString().Data(), TFRegex)) {
+      auto folderNumber = std::stoul(std::string(((TObjString*)key)->GetString().Data()).substr(3));
+      numbers.emplace_back(folderNumber);
+    }
+  }
+  std::sort(numbers.begin(), numbers.end());
+  return numbers;
+}
+
+void discardPrefetched(std::unique_ptr<PrefetchedFile> prefetched)
+{
+  if (prefetched && prefetched->file) {
+    // the trees which were not used are deleted with the file
+    prefetched->file->Close();
+    delete prefetched->file;
+  }
+}
+
+// Runs on the prefetching thread, which is the only user of the file
+// until it is handed over to the reader.
+std::unique_ptr<PrefetchedFile> prefetchFile(std::string filename, int counter, int nFolders, size_t memoryBudget, std::vector<PrefetchedTree> requests)
+{
+  auto prefetched = std::make_unique<PrefetchedFile>();
+  prefetched->counter = counter;
+  prefetched->file = TFile::Open(filename.c_str());
+  if (!prefetched->file) {
+    // the reader reports the error when it gets to the file
+    return prefetched;
+  }
+  prefetched->file->SetReadaheadSize(50 * 1024 * 1024);
+  prefetched->listOfTimeFrameNumbers = listTimeFrameNumbers(prefetched->file);
+
+  auto nfolders = std::min(static_cast<size_t>(nFolders), prefetched->listOfTimeFrameNumbers.size());
+  for (size_t fi = 0; fi < nfolders; ++fi) {
+    for (auto const& request : requests) {
+      auto treename = "DF_" + std::to_string(prefetched->listOfTimeFrameNumbers[fi]) + "/" + request.treename;
+      auto tree = (TTree*)prefetched->file->Get(treename.c_str());
+      if (!tree) {
+        continue;
+      }
+      std::vector<TBranch*> branches;
+      if (request.columns.empty()) {
+        for (auto branch : *tree->GetListOfBranches()) {
+          branches.push_back((TBranch*)branch);
+        }
+      } else {
+        for (auto const& column : request.columns) {
+          if (auto branch = tree->GetBranch(column.c_str())) {
+            branches.push_back(branch);
+          }
+        }
+      }
+      size_t totBytes = 0;
+      size_t zipBytes = 0;
+      for (auto branch : branches) {
+        totBytes += branch->GetTotBytes("*");
+        zipBytes += branch->GetZipBytes("*");
+      }
+      if (prefetched->bytes + totBytes > memoryBudget) {
+        delete tree;
+        LOGP(DEBUG, "Prefetched {} trees ({} bytes) of {}", prefetched->trees.size(), prefetched->bytes, filename);
+        return prefetched;
+      }
+
+      // fetch the requested branches with one vectored read and keep
+      // their baskets in memory
+      tree->SetCacheSize(zipBytes);
+      for (auto branch : branches) {
+        tree->AddBranchToCache(branch, true);
+      }
+      tree->StopCacheLearningPhase();
+      for (auto branch : branches) {
+        branch->LoadBaskets();
+      }
+      tree->SetCacheSize(0);
+
+      prefetched->bytes += totBytes;
+      prefetched->trees.emplace(treename, tree);
+    }
+  }
+  LOGP(DEBUG, "Prefetched {} trees ({} bytes) of {}", prefetched->trees.size(), prefetched->bytes, filename);
+  return prefetched;
+}
+} // namespace
+
 FileNameHolder* makeFileNameHolder(std::string fileName)
 {
   auto fileNameHolder = new FileNameHolder();
@@ -92,11 +191,17 @@ bool DataInputDescriptor::setFile(int counter)
 
   // open file
   auto filename = mfilenames[counter]->fileName;
-  if (mcurrentFile) {
-    if (mcurrentFile->GetName() != filename) {
-      closeInputFile();
-      mcurrentFile = TFile::Open(filename.c_str());
+  if (mcurrentFile && mcurrentFile->GetName() == filename) {
+    return true;
+  }
+  auto prefetched = takePrefetched(counter);
+  closeInputFile();
+  if (prefetched) {
+    mcurrentFile = prefetched->file;
+    if (mfilenames[counter]->numberOfTimeFrames <= 0) {
+      mfilenames[counter]->listOfTimeFrameNumbers = prefetched->listOfTimeFrameNumbers;
     }
+    mprefetched = std::move(prefetched);
   } else {
     mcurrentFile = TFile::Open(filename.c_str());
   }
@@ -107,18 +212,9 @@ bool DataInputDescriptor::setFile(int counter)
 
   // get the directory names
   if (mfilenames[counter]->numberOfTimeFrames <= 0) {
-    std::regex TFRegex = std::regex("DF_[0-9]+");
-    TList* keyList = mcurrentFile->GetListOfKeys();
-
-    // extract TF numbers and sort accordingly
-    for (auto key : *keyList) {
-      if (std::regex_match(((TObjString*)key)->GetString().Data(), TFRegex)) {
-        auto folderNumber = std::stoul(std::string(((TObjString*)key)->GetString().Data()).substr(3));
-        mfilenames[counter]->listOfTimeFrameNumbers.emplace_back(folderNumber);
-      }
+    if (!mprefetched) {
+      mfilenames[counter]->listOfTimeFrameNumbers = listTimeFrameNumbers(mcurrentFile);
     }
-    std::sort(mfilenames[counter]->listOfTimeFrameNumbers.begin(), mfilenames[counter]->listOfTimeFrameNumbers.end());
-
     for (auto folderNumber : mfilenames[counter]->listOfTimeFrameNumbers) {
       auto folderName = "DF_" + std::to_string(folderNumber);
       mfilenames[counter]->listOfTimeFrameKeys.emplace_back(folderName);
@@ -126,6 +222,11 @@ bool DataInputDescriptor::setFile(int counter)
     mfilenames[counter]->numberOfTimeFrames = mfilenames[counter]->listOfTimeFrameKeys.size();
   }
 
+  // overlap the opening of the next file with the reading of this one
+  if (mprefetchFolders > 0 && !mprefetchTrees.empty() && counter + mprefetchStride < getNumberInputfiles()) {
+    startPrefetching(counter + mprefetchStride);
+  }
+
   return true;
 }
 
@@ -170,8 +271,100 @@ int DataInputDescriptor::getTimeFramesInFile(int counter)
   return mfilenames.at(counter)->numberOfTimeFrames;
 }
 
+void DataInputDescriptor::setPrefetching(int nFolders, size_t memoryBudget, int fileStride)
+{
+  if (nFolders > 0) {
+    // the next file is opened on a separate thread
+    ROOT::EnableThreadSafety();
+  }
+  mprefetchFolders = nFolders;
+  mprefetchMemory = memoryBudget;
+  mprefetchStride = std::max(fileStride, 1);
+}
+
+void DataInputDescriptor::addPrefetchedTree(std::string const& treename, std::vector<std::string> const& columns)
+{
+  mprefetchTrees.push_back(PrefetchedTree{treename, columns});
+}
+
+void DataInputDescriptor::startPrefetching(int counter)
+{
+  mprefetching = std::async(std::launch::async, prefetchFile, mfilenames[counter]->fileName, counter, mprefetchFolders, mprefetchMemory, mprefetchTrees);
+}
+
+std::unique_ptr<PrefetchedFile> DataInputDescriptor::takePrefetched(int counter)
+{
+  if (!mprefetching.valid()) {
+    return nullptr;
+  }
+  auto prefetched = mprefetching.get();
+  if (prefetched->counter != counter || !prefetched->file) {
+    discardPrefetched(std::move(prefetched));
+    return nullptr;
+  }
+  return prefetched;
+}
+
+TTree* DataInputDescriptor::findPrefetchedTree(int counter, std::string const& treename)
+{
+  if (!mprefetched || mprefetched->counter != counter) {
+    return nullptr;
+  }
+  auto tree = mprefetched->trees.find(treename);
+  return tree == mprefetched->trees.end() ? nullptr : tree->second;
+}
+
+TTree* DataInputDescriptor::getPrefetchedTree(int counter, std::string const& treename)
+{
+  auto tree = findPrefetchedTree(counter, treename);
+  if (tree) {
+    mprefetched->trees.erase(treename);
+  }
+  return tree;
+}
+
+void DataInputDescriptor::keepParameterTree(std::string const& treename, TTree* tree)
+{
+  // the trees of the folders which were skipped are not needed anymore
+  auto folder = treename.substr(0, treename.find('/'));
+  if (folder != mparameterFolder) {
+    dropParameterTrees();
+    mparameterFolder = folder;
+  }
+  mparameterTrees[treename] = tree;
+}
+
+TTree* DataInputDescriptor::findParameterTree(std::string const& treename)
+{
+  auto tree = mparameterTrees.find(treename);
+  return tree == mparameterTrees.end() ? nullptr : tree->second;
+}
+
+TTree* DataInputDescriptor::takeParameterTree(std::string const& treename)
+{
+  auto tree = findParameterTree(treename);
+  if (tree) {
+    mparameterTrees.erase(treename);
+  }
+  return tree;
+}
+
+void DataInputDescriptor::dropParameterTrees()
+{
+  for (auto& [treename, tree] : mparameterTrees) {
+    delete tree;
+  }
+  mparameterTrees.clear();
+  mparameterFolder = "";
+}
+
 void DataInputDescriptor::closeInputFile()
 {
+  // the trees are deleted before the file which holds them
+  dropParameterTrees();
+  // the prefetched trees not used are deleted with the file
+  discardPrefetched(takePrefetched(-1));
+  mprefetched.reset();
   if (mcurrentFile) {
     mcurrentFile->Close();
     mcurrentFile = nullptr;
@@ -574,7 +767,13 @@ TTree* DataInputDirector::getDataTree(header::DataHeader dh, int counter, int nu
   auto fileAndFolder = didesc->getFileFolder(counter, numTF);
   if (fileAndFolder.file) {
     treename = fileAndFolder.folderName + "/" + treename;
-    tree = (TTree*)fileAndFolder.file->Get(treename.c_str());
+    tree = didesc->getPrefetchedTree(counter, treename);
+    if (!tree) {
+      tree = didesc->takeParameterTree(treename);
+    }
+    if (!tree) {
+      tree = (TTree*)fileAndFolder.file->Get(treename.c_str());
+    }
     if (!tree) {
       throw std::runtime_error(fmt::format(R"(Couldn't get TTree "{}" from "{}")", treename, fileAndFolder.file->GetName()));
     }
@@ -583,6 +782,70 @@ TTree* DataInputDirector::getDataTree(header::DataHeader dh, int counter, int nu
   return tree;
 }
 
+std::unordered_map<std::string, double> DataInputDirector::getTreeParameters(header::DataHeader dh, int counter, int numTF)
+{
+  std::unordered_map<std::string, double> parameters;
+
+  auto didesc = getDataInputDescriptor(dh);
+  std::string treename;
+  if (didesc) {
+    treename = didesc->treename;
+  } else {
+    didesc = mdefaultDataInputDescriptor;
+    treename = aod::datamodel::getTreeName(dh);
+  }
+
+  auto fileAndFolder = didesc->getFileFolder(counter, numTF);
+  if (!fileAndFolder.file) {
+    return parameters;
+  }
+  treename = fileAndFolder.folderName + "/" + treename;
+  // the tree is kept for getDataTree, if the table is needed
+  auto tree = didesc->findPrefetchedTree(counter, treename);
+  if (!tree) {
+    tree = didesc->findParameterTree(treename);
+  }
+  if (!tree) {
+    tree = (TTree*)fileAndFolder.file->Get(treename.c_str());
+    if (!tree) {
+      return parameters;
+    }
+    didesc->keepParameterTree(treename, tree);
+  }
+  for (auto object : *tree->GetUserInfo()) {
+    if (auto parameter = dynamic_cast<TParameter<double>*>(object)) {
+      parameters.emplace(parameter->GetName(), parameter->GetVal());
+    }
+  }
+  return parameters;
+}
+
+void DataInputDirector::addPrefetchedTable(header::DataHeader dh, std::vector<std::string> const& columns)
+{
+  auto didesc = getDataInputDescriptor(dh);
+  if (didesc) {
+    didesc->addPrefetchedTree(didesc->treename, columns);
+  } else {
+    mdefaultDataInputDescriptor->addPrefetchedTree(aod::datamodel::getTreeName(dh), columns);
+  }
+}
+
+void DataInputDirector::setPrefetching(int nFolders, size_t memoryBudget, int fileStride)
+{
+  // the budget is shared by the descriptors which have something to read
+  size_t nDescriptors = mdefaultDataInputDescriptor->hasPrefetchedTrees() ? 1 : 0;
+  for (auto didesc : mdataInputDescriptors) {
+    nDescriptors += didesc->hasPrefetchedTrees() ? 1 : 0;
+  }
+  if (nDescriptors == 0) {
+    return;
+  }
+  mdefaultDataInputDescriptor->setPrefetching(nFolders, memoryBudget / nDescriptors, fileStride);
+  for (auto didesc : mdataInputDescriptors) {
+    didesc->setPrefetching(nFolders, memoryBudget / nDescriptors, fileStride);
+  }
+}
+
 void DataInputDirector::closeInputFiles()
 {
   mdefaultDataInputDescriptor->closeInputFile();
@@ -491,6 +491,79 @@ void DataProcessingDevice::InitTask()
   // do so on a per thread basis, with fine grained locks.
   mDataProcessorContexes.resize(1);
   this->fillContext(mDataProcessorContexes.at(0), mDeviceContext);
+
+  int nWorkers = 1;
+  if (GetConfig()->Count("worker-threads")) {
+    nWorkers = std::stoi(GetConfig()->GetPropertyAsString("worker-threads"));
+  }
+  this->startWorkers(nWorkers);
+}
+
+void DataProcessingDevice::startWorkers(int nThreads)
+{
+  this->stopWorkers();
+  if (nThreads <= 1) {
+    return;
+  }
+  if (allowsWorkers(mSpec) == false) {
+    LOGP(WARNING, "{} worker threads requested, but {} is not labelled as independent-timeslices or dispatches its outputs when ready. Processing on the main thread.", nThreads, mSpec.name);
+    return;
+  }
+  auto& context = mDataProcessorContexes.at(0);
+  mWorkers = std::make_unique<WorkerPool>();
+  for (int wi = 0; wi < nThreads; ++wi) {
+    auto stream = std::make_unique<WorkerStream>();
+    stream->id.index = wi;
+    stream->services = mServiceRegistry.createStreamServices(mState, *GetConfig(), stream->preProcessingHandles, stream->postProcessingHandles);
+    stream->registry = mServiceRegistry.makeStreamRegistry(stream->services);
+    stream->allocator = std::make_unique<DataAllocator>(&stream->timingInfo, &stream->registry, mSpec.outputs);
+    mWorkers->idle.push_back(stream.get());
+    mWorkers->streams.push_back(std::move(stream));
+  }
+  for (auto& stream : mWorkers->streams) {
+    mWorkers->threads.emplace_back(DataProcessingDevice::runWorker, std::ref(context), std::ref(*mWorkers), std::ref(*stream));
+  }
+  context.workers = mWorkers.get();
+  LOGP(INFO, "Processing timeslices of {} on {} worker threads", mSpec.name, nThreads);
+}
+
+bool DataProcessingDevice::allowsWorkers(DeviceSpec const& spec)
+{
+  // Only the DataProcessors which declare that their timeslices can be
+  // processed concurrently, i.e. that their callbacks are thread safe.
+  if (std::find(spec.labels.begin(), spec.labels.end(), DataProcessorLabel{"independent-timeslices"}) == spec.labels.end()) {
+    return false;
+  }
+  // Outputs dispatched when ready would be sent from the worker threads.
+  return spec.dispatchPolicy.action != DispatchPolicy::DispatchOp::WhenReady;
+}
+
+void DataProcessingDevice::stopWorkers()
+{
+  if (mWorkers.get() == nullptr) {
+    return;
+  }
+  // The timeslices in flight are finalised, so that their outputs are sent
+  // and their slots released, before the relayer is reset.
+  mWorkers->draining = true;
+  std::vector<DataRelayer::RecordAction> completed;
+  for (auto& context : mDataProcessorContexes) {
+    if (context.workers != nullptr) {
+      DataProcessingDevice::tryDispatchComputation(context, completed);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mWorkers->mutex);
+    mWorkers->stop = true;
+  }
+  mWorkers->scheduledCondition.notify_all();
+  for (auto& thread : mWorkers->threads) {
+    thread.join();
+  }
+  for (auto& context : mDataProcessorContexes) {
+    context.workers = nullptr;
+  }
+  mWorkers.reset();
 }
 
 void DataProcessingDevice::fillContext(DataProcessorContext& context, DeviceContext& deviceContext)
@@ -801,6 +874,7 @@ void DataProcessingDevice::doRun(DataProcessorContext& context)
 
 void DataProcessingDevice::ResetTask()
 {
+  this->stopWorkers();
   mRelayer->clear();
 }
 
@@ -1007,6 +1081,22 @@ void update_maximum(std::atomic<T>& maximum_value, T const& value) noexcept
          !maximum_value.compare_exchange_weak(prev_value, value)) {
   }
 }
+
+auto makeInputSpan(std::vector<MessageSet>& inputs) -> InputSpan
+{
+  auto getter = [&inputs](size_t i, size_t partindex) -> DataRef {
+    if (inputs[i].size() > partindex) {
+      return DataRef{nullptr,
+                     static_cast<char const*>(inputs[i].at(partindex).header->GetData()),
+                     static_cast<char const*>(inputs[i].at(partindex).payload->GetData())};
+    }
+    return DataRef{nullptr, nullptr, nullptr};
+  };
+  auto nofPartsGetter = [&inputs](size_t i) -> size_t {
+    return inputs[i].size();
+  };
+  return InputSpan{getter, nofPartsGetter, inputs.size()};
+}
 } // namespace
 
 bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context, std::vector<DataRelayer::RecordAction>& completed)
@@ -1048,18 +1138,7 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
   auto getInputSpan = [&relayer = context.relayer,
                        &currentSetOfInputs](TimesliceSlot slot) {
     currentSetOfInputs = std::move(relayer->getInputsForTimeslice(slot));
-    auto getter = [&currentSetOfInputs](size_t i, size_t partindex) -> DataRef {
-      if (currentSetOfInputs[i].size() > partindex) {
-        return DataRef{nullptr,
-                       static_cast<char const*>(currentSetOfInputs[i].at(partindex).header->GetData()),
-                       static_cast<char const*>(currentSetOfInputs[i].at(partindex).payload->GetData())};
-      }
-      return DataRef{nullptr, nullptr, nullptr};
-    };
-    auto nofPartsGetter = [&currentSetOfInputs](size_t i) -> size_t {
-      return currentSetOfInputs[i].size();
-    };
-    return InputSpan{getter, nofPartsGetter, currentSetOfInputs.size()};
+    return makeInputSpan(currentSetOfInputs);
   };
 
   auto markInputsAsDone = [&relayer = context.relayer](TimesliceSlot slot) -> void {
@@ -1070,13 +1149,12 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
   // propagates it to the various contextes (i.e. the actual entities which
   // create messages) because the messages need to have the timeslice id into
   // it.
-  auto prepareAllocatorForCurrentTimeSlice = [&timingInfo = context.timingInfo,
-                                              &relayer = context.relayer](TimesliceSlot i) {
+  auto prepareAllocatorForCurrentTimeSlice = [&relayer = context.relayer](TimesliceSlot i, TimingInfo& timingInfo) {
     ZoneScopedN("DataProcessingDevice::prepareForCurrentTimeslice");
     auto timeslice = relayer->getTimesliceForSlot(i);
-    timingInfo->timeslice = timeslice.value;
-    timingInfo->tfCounter = relayer->getFirstTFCounterForSlot(i);
-    timingInfo->firstTFOrbit = relayer->getFirstTFOrbitForSlot(i);
+    timingInfo.timeslice = timeslice.value;
+    timingInfo.tfCounter = relayer->getFirstTFCounterForSlot(i);
+    timingInfo.firstTFOrbit = relayer->getFirstTFOrbitForSlot(i);
   };
 
   // When processing them, timers will have to be cleaned up
@@ -1204,10 +1282,6 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
     control.notifyStreamingState(state->streaming);
   };
 
-  if (canDispatchSomeComputation() == false) {
-    return false;
-  }
-
   auto postUpdateStats = [&stats = context.registry->get<DataProcessingStats>()](DataRelayer::RecordAction const& action, InputRecord const& record, uint64_t tStart) {
     std::atomic_thread_fence(std::memory_order_release);
     for (size_t ai = 0; ai != record.size(); ai++) {
@@ -1235,12 +1309,104 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
     }
   };
 
+  // Timeslices of independent DataProcessors are processed by the worker
+  // threads. Everything else (i.e. sending their outputs, forwarding their
+  // inputs, the stats) happens here, on the main thread, once they are done.
+  auto finaliseStream = [&context, &currentSetOfInputs, &forwardInputs, &postUpdateStats, &cleanupRecord](WorkerStream& stream) {
+    ZoneScopedN("finalise worker stream");
+    currentSetOfInputs = std::move(stream.inputs);
+    InputSpan span = makeInputSpan(currentSetOfInputs);
+    InputRecord record{context.deviceContext->spec->inputs, span};
+    ProcessingContext processContext{record, stream.registry, *stream.allocator};
+    if (stream.error.has_value()) {
+      auto e = *stream.error;
+      stream.error.reset();
+      (*context.errorHandling)(e, record);
+    } else {
+      for (auto& handle : stream.postProcessingHandles) {
+        handle.callback(processContext, handle.service);
+      }
+      context.registry->postWorkerProcessingCallbacks(processContext);
+    }
+    postUpdateStats(stream.action, record, stream.tStart);
+    context.registry->postDispatchingCallbacks(processContext);
+    if (context.deviceContext->spec->forwards.empty() == false) {
+      forwardInputs(stream.action.slot, record);
+    }
+#ifdef TRACY_ENABLE
+    cleanupRecord(record);
+#endif
+    currentSetOfInputs.clear();
+  };
+
+  // Finalise the streams which are done, waiting until at least minIdle
+  // of them are available for new timeslices.
+  auto finaliseWorkers = [&workers = context.workers, &finaliseStream](size_t minIdle) -> bool {
+    if (workers == nullptr) {
+      return false;
+    }
+    std::vector<WorkerStream*> done;
+    {
+      std::unique_lock<std::mutex> lock(workers->mutex);
+      workers->doneCondition.wait(lock, [&workers, minIdle]() { return workers->idle.size() + workers->done.size() >= minIdle; });
+      done.swap(workers->done);
+    }
+    for (auto* stream : done) {
+      finaliseStream(*stream);
+      workers->idle.push_back(stream);
+    }
+    return done.empty() == false;
+  };
+
+  auto scheduleOnWorker = [&context, &finaliseWorkers, &prepareAllocatorForCurrentTimeSlice,
+                           &markInputsAsDone, &preUpdateStats](DataRelayer::RecordAction const& action) {
+    auto& workers = *context.workers;
+    if (workers.idle.empty()) {
+      ZoneScopedN("wait for worker");
+      finaliseWorkers(1);
+    }
+    WorkerStream& stream = *workers.idle.back();
+    workers.idle.pop_back();
+    prepareAllocatorForCurrentTimeSlice(action.slot, stream.timingInfo);
+    stream.action = action;
+    stream.inputs = context.relayer->getInputsForTimeslice(action.slot);
+    InputSpan span = makeInputSpan(stream.inputs);
+    InputRecord record{context.deviceContext->spec->inputs, span};
+    ProcessingContext processContext{record, stream.registry, *stream.allocator};
+    context.registry->preWorkerProcessingCallbacks(processContext);
+    markInputsAsDone(action.slot);
+    stream.tStart = uv_hrtime();
+    preUpdateStats(action, record, stream.tStart);
+    {
+      std::lock_guard<std::mutex> lock(workers.mutex);
+      stream.scheduled = true;
+    }
+    workers.scheduledCondition.notify_all();
+  };
+
+  // When the stream is over, or the workers are being stopped, everything
+  // in flight must be sent before going further.
+  auto allWorkers = context.workers ? context.workers->streams.size() : 0;
+  bool draining = context.workers != nullptr && context.workers->draining;
+  bool finalised = finaliseWorkers(context.deviceContext->state->streaming == StreamingState::EndOfStreaming || draining ? allWorkers : 0);
+  if (draining) {
+    return finalised;
+  }
+
+  if (canDispatchSomeComputation() == false) {
+    return finalised;
+  }
+
   for (auto action : getReadyActions()) {
     if (action.op == CompletionPolicy::CompletionOp::Wait) {
       continue;
     }
+    if (context.workers != nullptr && action.op == CompletionPolicy::CompletionOp::Consume) {
+      scheduleOnWorker(action);
+      continue;
+    }
 
-    prepareAllocatorForCurrentTimeSlice(TimesliceSlot{action.slot});
+    prepareAllocatorForCurrentTimeSlice(TimesliceSlot{action.slot}, *context.timingInfo);
     InputSpan span = getInputSpan(action.slot);
     InputRecord record{context.deviceContext->spec->inputs, span};
     ProcessingContext processContext{record, *context.registry, *context.allocator};
@@ -1315,6 +1481,7 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
   }
   // We now broadcast the end of stream if it was requested
   if (context.deviceContext->state->streaming == StreamingState::EndOfStreaming) {
+    finaliseWorkers(allWorkers);
     for (auto& channel : context.deviceContext->spec->outputChannels) {
       DataProcessingHelpers::sendEndOfStream(*context.deviceContext->device, channel);
     }
@@ -1324,6 +1491,53 @@ bool DataProcessingDevice::tryDispatchComputation(DataProcessorContext& context,
   return true;
 }
 
+void DataProcessingDevice::runWorker(DataProcessorContext& context, WorkerPool& workers, WorkerStream& stream)
+{
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(workers.mutex);
+      workers.scheduledCondition.wait(lock, [&workers, &stream]() { return stream.scheduled || workers.stop; });
+      // A scheduled timeslice is always processed, so that it is not lost
+      if (stream.scheduled == false) {
+        return;
+      }
+    }
+    ZoneScopedN("worker process");
+    InputSpan span = makeInputSpan(stream.inputs);
+    InputRecord record{context.deviceContext->spec->inputs, span};
+    // The outputs of this thread end up in the stream own contexts.
+    ProcessingContext processContext{record, stream.registry, *stream.allocator};
+    for (auto& handle : stream.preProcessingHandles) {
+      handle.callback(processContext, handle.service);
+    }
+    // Exceptions cannot leave the thread, they are handled by the main
+    // thread together with the rest of the timeslice.
+    try {
+      if (context.deviceContext->state->quitRequested == false) {
+        if (*context.statefulProcess) {
+          ZoneScopedN("statefull process");
+          (*context.statefulProcess)(processContext);
+        }
+        if (*context.statelessProcess) {
+          ZoneScopedN("stateless process");
+          (*context.statelessProcess)(processContext);
+        }
+      }
+    } catch (std::exception& ex) {
+      stream.error = runtime_error(ex.what());
+    } catch (o2::framework::RuntimeErrorRef e) {
+      stream.error = e;
+    }
+    {
+      std::lock_guard<std::mutex> lock(workers.mutex);
+      stream.scheduled = false;
+      workers.done.push_back(&stream);
+    }
+    workers.doneCondition.notify_one();
+    uv_async_send(context.deviceContext->state->awakeMainThread);
+  }
+}
+
 void DataProcessingDevice::error(const char* msg)
 {
   LOG(ERROR) << msg;
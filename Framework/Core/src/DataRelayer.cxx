@@ -59,8 +59,6 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
     mDistinctRoutesIndex{DataRelayerHelpers::createDistinctRouteIndex(routes)},
     mInputMatchers{DataRelayerHelpers::createInputMatchers(routes)}
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
-
   setPipelineLength(DEFAULT_PIPELINE_LENGTH);
 
   // The queries are all the same, so we only have width 1
@@ -80,14 +78,15 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
 
 TimesliceId DataRelayer::getTimesliceForSlot(TimesliceSlot slot)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::shared_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+  std::scoped_lock<std::mutex> slotLock(mSlotMutexes[slot.index]);
   return mTimesliceIndex.getTimesliceForSlot(slot);
 }
 
 DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<ExpirationHandler> const& expirationHandlers,
                                                               ServiceRegistry& services, bool createNew)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
 
   ActivityStats activity;
   /// Nothing to do if nothing can expire.
@@ -118,12 +117,8 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
     for (size_t ei = 0; ei < expirationHandlers.size(); ++ei) {
       auto& expirator = expirationHandlers[ei];
       // We check that no data is already there for the given cell
-      // it is enough to check the first element
       auto& part = mCache[ti * mDistinctRoutesIndex.size() + expirator.routeIndex.value];
-      if (part.size() > 0 && part[0].header != nullptr) {
-        continue;
-      }
-      if (part.size() > 0 && part[0].payload != nullptr) {
+      if (hasData(slot, expirator.routeIndex.value)) {
         continue;
       }
       // We check that the cell can actually be expired.
@@ -145,6 +140,9 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
       }
       expirator.handler(services, part[0], timestamp.value, variables);
       activity.expiredSlots++;
+      if (expirator.routeIndex.value < 64) {
+        mFilledInputs[ti] |= uint64_t(1) << expirator.routeIndex.value;
+      }
 
       mTimesliceIndex.markAsDirty(slot, true);
       assert(part[0].header != nullptr);
@@ -207,11 +205,10 @@ DataRelayer::RelayChoice
                      std::unique_ptr<FairMQMessage>* restOfParts,
                      size_t restOfPartsSize)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
   // STATE HOLDING VARIABLES
-  // This is the class level state of the relaying. If we start supporting
-  // multithreading this will have to be made thread safe before we can invoke
-  // relay concurrently.
+  // This is the class level state of the relaying. Only the fast path
+  // below can run concurrently, and it only touches the state of a single
+  // slot while holding its lock.
   auto& index = mTimesliceIndex;
 
   auto& cache = mCache;
@@ -257,6 +254,7 @@ DataRelayer::RelayChoice
   // hence the first if.
   auto pruneCache = [&cache,
                      &cachedStateMetrics = mCachedStateMetrics,
+                     &filledInputs = mFilledInputs,
                      &numInputTypes,
                      &index,
                      &metrics](TimesliceSlot slot) {
@@ -270,11 +268,13 @@ DataRelayer::RelayChoice
       cache[ai].clear();
       cachedStateMetrics[ai] = CacheEntryStatus::EMPTY;
     }
+    filledInputs[slot.index] = 0;
   };
 
   // Actually save the header / payload in the slot
   auto saveInSlot = [&firstPart,
                      &cachedStateMetrics = mCachedStateMetrics,
+                     &filledInputs = mFilledInputs,
                      &restOfParts,
                      &restOfPartsSize,
                      &cache,
@@ -283,6 +283,9 @@ DataRelayer::RelayChoice
     auto cacheIdx = numInputTypes * slot.index + input;
     std::vector<PartRef>& parts = cache[cacheIdx].parts;
     cachedStateMetrics[cacheIdx] = CacheEntryStatus::PENDING;
+    if (input < 64) {
+      filledInputs[slot.index] |= uint64_t(1) << input;
+    }
     // TODO: make sure that multiple parts can only be added within the same call of
     // DataRelayer::relay
     PartRef entry{std::move(firstPart), std::move(restOfParts[0])};
@@ -324,6 +327,44 @@ DataRelayer::RelayChoice
   auto timeslice = TimesliceId{TimesliceId::INVALID};
   auto slot = TimesliceSlot{TimesliceSlot::INVALID};
 
+  // FAST PATH
+  //
+  // Matching against a pristine context gives us the timeslice, which
+  // allows us to look up directly the slot already holding it, rather than
+  // trying all the routes on every slot. The match is then confirmed using
+  // the variables of that slot only. This only needs the relayer lock
+  // shared and the lock of the slot.
+  {
+    VariableContext lookupContext;
+    std::tie(input, timeslice) = getInputTimeslice(lookupContext);
+    if (input != INVALID_INPUT && TimesliceId::isValid(timeslice)) {
+      std::shared_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+      slot = index.findSlot(timeslice);
+      if (TimesliceSlot::isValid(slot)) {
+        std::scoped_lock<std::mutex> slotLock(mSlotMutexes[slot.index]);
+        std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
+        if (input != INVALID_INPUT) {
+          O2_SIGNPOST(O2_PROBE_DATARELAYER, timeslice.value, 0, 0, 0);
+          saveInSlot(timeslice, input, slot);
+          index.publishSlot(slot);
+          index.markAsDirty(slot, true);
+          mStats.relayedMessages++;
+          return WillRelay;
+        }
+      }
+    }
+  }
+
+  // SLOW PATH
+  //
+  // Either the timeslice is not associated to any slot yet or the slot
+  // holding it does not match, we need to go through all the slots and
+  // possibly associate a new one, so we need exclusive access.
+  std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+  input = INVALID_INPUT;
+  timeslice = TimesliceId{TimesliceId::INVALID};
+  slot = TimesliceSlot{TimesliceSlot::INVALID};
+
   bool needsCleaning = false;
   // First look for matching slots which already have some
   // partial match.
@@ -359,6 +400,7 @@ DataRelayer::RelayChoice
     O2_SIGNPOST(O2_PROBE_DATARELAYER, timeslice.value, 0, 0, 0);
     if (needsCleaning) {
       pruneCache(slot);
+      index.indexSlot(slot);
     }
     saveInSlot(timeslice, input, slot);
     index.publishSlot(slot);
@@ -450,7 +492,7 @@ DataRelayer::RelayChoice
 
 void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& completed)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::shared_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
 
   // THE STATE
   const auto& cache = mCache;
@@ -494,13 +536,17 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
 
   for (size_t li = 0; li < cacheLines; ++li) {
     TimesliceSlot slot{li};
+    std::scoped_lock<std::mutex> slotLock(mSlotMutexes[li]);
     // We only check the cachelines which have been updated by an incoming
     // message.
     if (mTimesliceIndex.isDirty(slot) == false) {
       continue;
     }
     auto partial = getPartialRecord(li);
-    auto getter = [&partial](size_t idx, size_t part) {
+    auto getter = [&partial, filled = mFilledInputs[li]](size_t idx, size_t part) {
+      if (idx < 64 && ((filled >> idx) & 1) == 0) {
+        return DataRef{};
+      }
       if (partial[idx].size() > 0 && partial[idx].at(part).header && partial[idx].at(part).payload) {
         return DataRef{nullptr,
                        reinterpret_cast<const char*>(partial[idx].at(part).header->GetData()),
@@ -530,7 +576,8 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
 
 void DataRelayer::updateCacheStatus(TimesliceSlot slot, CacheEntryStatus oldStatus, CacheEntryStatus newStatus)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::shared_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+  std::scoped_lock<std::mutex> slotLock(mSlotMutexes[slot.index]);
   const auto numInputTypes = mDistinctRoutesIndex.size();
   auto& index = mTimesliceIndex;
 
@@ -549,7 +596,7 @@ void DataRelayer::updateCacheStatus(TimesliceSlot slot, CacheEntryStatus oldStat
 
 std::vector<o2::framework::MessageSet> DataRelayer::getInputsForTimeslice(TimesliceSlot slot)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
 
   const auto numInputTypes = mDistinctRoutesIndex.size();
   // State of the computation
@@ -591,6 +638,7 @@ std::vector<o2::framework::MessageSet> DataRelayer::getInputsForTimeslice(Timesl
     }
     index.markAsInvalid(s);
   };
+  mFilledInputs[slot.index] = 0;
 
   // Outer loop here.
   jumpToCacheEntryAssociatedWith(slot);
@@ -604,11 +652,12 @@ std::vector<o2::framework::MessageSet> DataRelayer::getInputsForTimeslice(Timesl
 
 void DataRelayer::clear()
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
 
   for (auto& cache : mCache) {
     cache.clear();
   }
+  std::fill(mFilledInputs.begin(), mFilledInputs.end(), 0);
   for (size_t s = 0; s < mTimesliceIndex.size(); ++s) {
     mTimesliceIndex.markAsInvalid(TimesliceSlot{s});
   }
@@ -626,19 +675,32 @@ size_t
 /// the time pipelining.
 void DataRelayer::setPipelineLength(size_t s)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
-
-  mTimesliceIndex.resize(s);
-  mVariableContextes.resize(s);
+  {
+    std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+    mTimesliceIndex.resize(s);
+    mVariableContextes.resize(s);
+    resizeSlots();
+  }
   publishMetrics();
 }
 
+void DataRelayer::resizeSlots()
+{
+  mCache.resize(mDistinctRoutesIndex.size() * mTimesliceIndex.size());
+  // The slot locks are only ever taken while holding mMutex shared, so nobody
+  // holds one while mMutex is held exclusively and they can be replaced.
+  if (!mSlotMutexes || mFilledInputs.size() != mTimesliceIndex.size()) {
+    mSlotMutexes = std::make_unique<std::mutex[]>(mTimesliceIndex.size());
+  }
+  mFilledInputs.resize(mTimesliceIndex.size(), 0);
+}
+
 void DataRelayer::publishMetrics()
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
 
   auto numInputTypes = mDistinctRoutesIndex.size();
-  mCache.resize(numInputTypes * mTimesliceIndex.size());
+  resizeSlots();
   mMetrics.send({(int)numInputTypes, "data_relayer/h"});
   mMetrics.send({(int)mTimesliceIndex.size(), "data_relayer/w"});
   sMetricsNames.resize(mCache.size());
@@ -667,6 +729,16 @@ void DataRelayer::publishMetrics()
   }
 }
 
+bool DataRelayer::hasData(TimesliceSlot slot, size_t input) const
+{
+  if (input < 64) {
+    return (mFilledInputs[slot.index] >> input) & 1;
+  }
+  // it is enough to check the first element
+  auto& part = mCache[slot.index * mDistinctRoutesIndex.size() + input];
+  return part.size() > 0 && (part[0].header != nullptr || part[0].payload != nullptr);
+}
+
 DataRelayerStats const& DataRelayer::getStats() const
 {
   return mStats;
@@ -674,19 +746,21 @@ DataRelayerStats const& DataRelayer::getStats() const
 
 uint32_t DataRelayer::getFirstTFOrbitForSlot(TimesliceSlot slot)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::shared_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+  std::scoped_lock<std::mutex> slotLock(mSlotMutexes[slot.index]);
   return mTimesliceIndex.getFirstTFOrbitForSlot(slot);
 }
 
 uint32_t DataRelayer::getFirstTFCounterForSlot(TimesliceSlot slot)
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::shared_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
+  std::scoped_lock<std::mutex> slotLock(mSlotMutexes[slot.index]);
   return mTimesliceIndex.getFirstTFCounterForSlot(slot);
 }
 
 void DataRelayer::sendContextState()
 {
-  std::scoped_lock<LockableBase(std::recursive_mutex)> lock(mMutex);
+  std::scoped_lock<SharedLockableBase(std::shared_mutex)> lock(mMutex);
   for (size_t ci = 0; ci < mTimesliceIndex.size(); ++ci) {
     auto slot = TimesliceSlot{ci};
     sendVariableContextMetrics(mTimesliceIndex.getPublishedVariablesForSlot(slot), slot,
@@ -1118,6 +1118,8 @@ void DeviceSpecHelpers::prepareArguments(bool defaultQuiet, bool defaultStopped,
         realOdesc.add_options()("shm-monitor", bpo::value<std::string>());
         realOdesc.add_options()("channel-prefix", bpo::value<std::string>());
         realOdesc.add_options()("session", bpo::value<std::string>());
+        realOdesc.add_options()("worker-threads", bpo::value<std::string>());
+        realOdesc.add_options()("message-pool-size", bpo::value<std::string>());
         filterArgsFct(expansions.we_wordc, expansions.we_wordv, realOdesc);
         wordfree(&expansions);
         return;
@@ -1266,6 +1268,8 @@ boost::program_options::options_description DeviceSpecHelpers::getForwardedDevic
      "dump stacktrace on specified signal(s) (any of `all`, `segv`, `bus`, `ill`, `abrt`, `fpe`, `sys`.)")                                    //
     ("post-fork-command", bpo::value<std::string>(), "post fork command to execute (e.g. numactl {pid}")                                      //
     ("session", bpo::value<std::string>(), "unique label for the shared memory session")                                                      //
+    ("worker-threads", bpo::value<std::string>(), "number of threads processing timeslices of independent-timeslices devices")                //
+    ("message-pool-size", bpo::value<std::string>(), "size in MB of the per-channel region used for small messages, 0 to disable")            //
     ("configuration,cfg", bpo::value<std::string>(), "configuration connection string")                                                       //
     ("driver-client-backend", bpo::value<std::string>(), "driver connection string")                                                          //
     ("monitoring-backend", bpo::value<std::string>(), "monitoring connection string")                                                         //
@@ -17,10 +17,14 @@
 #include "arrow/table.h"
 #include "fmt/format.h"
 #include <stack>
+#include <sstream>
 #include <iostream>
 #include <unordered_map>
 #include <set>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 using namespace o2::framework;
 
@@ -320,43 +324,98 @@ gandiva::ExpressionPtr makeExpression(gandiva::NodePtr node, gandiva::FieldPtr r
   return gandiva::TreeExprBuilder::MakeExpression(node, result);
 }
 
+namespace
+{
+/// Compiled gandiva objects of a given kind, keyed by the schema and the
+/// expressions they were compiled for. Literals, including the updated
+/// placeholders, are part of the expressions, so a different cut gives a
+/// different key.
+template <typename T>
+struct CompilationCache {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::shared_ptr<T>> compiled;
+};
+
+std::atomic<uint64_t> gCacheHits = 0;
+std::atomic<uint64_t> gCacheMisses = 0;
+std::atomic<uint64_t> gCompileTime = 0;
+
+template <typename T, typename F>
+std::shared_ptr<T> getCompiled(std::string const& key, F&& compile)
+{
+  static CompilationCache<T> cache;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto entry = cache.compiled.find(key);
+    if (entry != cache.compiled.end()) {
+      gCacheHits.fetch_add(1, std::memory_order_relaxed);
+      return entry->second;
+    }
+  }
+  // Compile outside of the lock, so that different expressions can be
+  // compiled concurrently. If two threads compile the same one, the first
+  // result is kept.
+  gCacheMisses.fetch_add(1, std::memory_order_relaxed);
+  auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<T> result = compile();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  gCompileTime.fetch_add(elapsed.count(), std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.compiled.emplace(key, std::move(result)).first->second;
+}
+} // namespace
+
+CompilationCacheStats compilationCacheStats()
+{
+  return CompilationCacheStats{gCacheHits.load(std::memory_order_relaxed),
+                               gCacheMisses.load(std::memory_order_relaxed),
+                               gCompileTime.load(std::memory_order_relaxed)};
+}
+
 std::shared_ptr<gandiva::Filter>
   createFilter(gandiva::SchemaPtr const& Schema, Operations const& opSpecs)
 {
-  std::shared_ptr<gandiva::Filter> filter;
-  auto s = gandiva::Filter::Make(Schema,
-                                 makeCondition(createExpressionTree(opSpecs, Schema)),
-                                 &filter);
-  if (!s.ok()) {
-    throw runtime_error_f("Failed to create filter: %s", s.ToString().c_str());
-  }
-  return filter;
+  return createFilter(Schema, makeCondition(createExpressionTree(opSpecs, Schema)));
 }
 
 std::shared_ptr<gandiva::Filter>
   createFilter(gandiva::SchemaPtr const& Schema, gandiva::ConditionPtr condition)
 {
-  std::shared_ptr<gandiva::Filter> filter;
-  auto s = gandiva::Filter::Make(Schema,
-                                 condition,
-                                 &filter);
-  if (!s.ok()) {
-    throw runtime_error_f("Failed to create filter: %s", s.ToString().c_str());
+  return getCompiled<gandiva::Filter>(Schema->ToString() + "\n" + condition->ToString(), [&]() {
+    std::shared_ptr<gandiva::Filter> filter;
+    auto s = gandiva::Filter::Make(Schema,
+                                   condition,
+                                   &filter);
+    if (!s.ok()) {
+      throw runtime_error_f("Failed to create filter: %s", s.ToString().c_str());
+    }
+    return filter;
+  });
+}
+
+std::shared_ptr<gandiva::Projector>
+  createProjector(gandiva::SchemaPtr const& Schema, gandiva::ExpressionVector const& expressions)
+{
+  std::string key = Schema->ToString();
+  for (auto& expression : expressions) {
+    key += "\n" + expression->ToString();
   }
-  return filter;
+  return getCompiled<gandiva::Projector>(key, [&]() {
+    std::shared_ptr<gandiva::Projector> projector;
+    auto s = gandiva::Projector::Make(Schema,
+                                      expressions,
+                                      &projector);
+    if (!s.ok()) {
+      throw runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
+    }
+    return projector;
+  });
 }
 
 std::shared_ptr<gandiva::Projector>
   createProjector(gandiva::SchemaPtr const& Schema, Operations const& opSpecs, gandiva::FieldPtr result)
 {
-  std::shared_ptr<gandiva::Projector> projector;
-  auto s = gandiva::Projector::Make(Schema,
-                                    {makeExpression(createExpressionTree(opSpecs, Schema), result)},
-                                    &projector);
-  if (!s.ok()) {
-    throw runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
-  }
-  return projector;
+  return createProjector(Schema, {makeExpression(createExpressionTree(opSpecs, Schema), result)});
 }
 
 std::shared_ptr<gandiva::Projector>
@@ -537,6 +596,20 @@ gandiva::NodePtr createExpressionTree(Operations const& opSpecs,
   return tree;
 }
 
+std::set<std::string> getColumnLabels(Filter const& expression)
+{
+  std::set<std::string> labels;
+  for (auto& spec : createOperations(expression)) {
+    if (spec.left.datum.index() == 3) {
+      labels.insert(std::get<std::string>(spec.left.datum));
+    }
+    if (spec.right.datum.index() == 3) {
+      labels.insert(std::get<std::string>(spec.right.datum));
+    }
+  }
+  return labels;
+}
+
 bool isTableCompatible(std::set<size_t> const& hashes, Operations const& specs)
 {
   std::set<size_t> opHashes;
@@ -593,4 +666,172 @@ void updateExpressionInfos(expressions::Filter const& filter, std::vector<Expres
   }
 }
 
+namespace
+{
+char const* comparisonName(BasicOp op)
+{
+  switch (op) {
+    case BasicOp::LessThan:
+      return "lt";
+    case BasicOp::LessThanOrEqual:
+      return "le";
+    case BasicOp::GreaterThan:
+      return "gt";
+    case BasicOp::GreaterThanOrEqual:
+      return "ge";
+    case BasicOp::Equal:
+      return "eq";
+    default:
+      return nullptr;
+  }
+}
+
+// the comparison with swapped operands
+BasicOp mirrored(BasicOp op)
+{
+  switch (op) {
+    case BasicOp::LessThan:
+      return BasicOp::GreaterThan;
+    case BasicOp::LessThanOrEqual:
+      return BasicOp::GreaterThanOrEqual;
+    case BasicOp::GreaterThan:
+      return BasicOp::LessThan;
+    case BasicOp::GreaterThanOrEqual:
+      return BasicOp::LessThanOrEqual;
+    default:
+      return op;
+  }
+}
+
+double literalValue(LiteralNode const& node)
+{
+  return std::visit([](auto value) { return static_cast<double>(value); }, node.value);
+}
+
+// A comparison between a column and a literal, with the column on the left
+struct Comparison {
+  BasicOp op;
+  BindingNode const* binding;
+  double value;
+};
+
+std::optional<Comparison> asComparison(Node const& node)
+{
+  auto opNode = std::get_if<OpNode>(&node.self);
+  if (opNode == nullptr || comparisonName(opNode->op) == nullptr || !node.left || !node.right) {
+    return std::nullopt;
+  }
+  // placeholders are a different alternative of the variant, so that their
+  // value, which is only known once the task is initialised, is not used
+  if (auto binding = std::get_if<BindingNode>(&node.left->self)) {
+    if (auto literal = std::get_if<LiteralNode>(&node.right->self)) {
+      return Comparison{opNode->op, binding, literalValue(*literal)};
+    }
+  } else if (auto binding = std::get_if<BindingNode>(&node.right->self)) {
+    if (auto literal = std::get_if<LiteralNode>(&node.left->self)) {
+      return Comparison{mirrored(opNode->op), binding, literalValue(*literal)};
+    }
+  }
+  return std::nullopt;
+}
+
+Node parseRangePredicate(std::istream& tokens)
+{
+  std::string token;
+  if (!(tokens >> token)) {
+    throw runtime_error("Truncated range predicate");
+  }
+  if (token == "true") {
+    return LiteralNode{true};
+  }
+  if (token == "and" || token == "or") {
+    auto left = parseRangePredicate(tokens);
+    auto right = parseRangePredicate(tokens);
+    return Node{OpNode{token == "and" ? BasicOp::LogicalAnd : BasicOp::LogicalOr}, std::move(left), std::move(right)};
+  }
+  for (auto op : {BasicOp::LessThan, BasicOp::LessThanOrEqual, BasicOp::GreaterThan, BasicOp::GreaterThanOrEqual, BasicOp::Equal}) {
+    if (token == comparisonName(op)) {
+      std::string column;
+      double value;
+      if (!(tokens >> column >> value)) {
+        throw runtime_error_f("Malformed comparison in range predicate: %s", token.c_str());
+      }
+      return Node{OpNode{op}, BindingNode{column, 0, atype::DOUBLE}, LiteralNode{value}};
+    }
+  }
+  throw runtime_error_f("Unknown token in range predicate: %s", token.c_str());
+}
+} // namespace
+
+std::string rangePredicate(Node const& node)
+{
+  if (auto comparison = asComparison(node)) {
+    return fmt::format("{} {} {}", comparisonName(comparison->op), comparison->binding->name, comparison->value);
+  }
+  auto opNode = std::get_if<OpNode>(&node.self);
+  if (opNode != nullptr && node.left && node.right) {
+    if (opNode->op == BasicOp::LogicalAnd) {
+      auto left = rangePredicate(*node.left);
+      auto right = rangePredicate(*node.right);
+      if (left == "true") {
+        return right;
+      }
+      if (right == "true") {
+        return left;
+      }
+      return "and " + left + " " + right;
+    }
+    if (opNode->op == BasicOp::LogicalOr) {
+      auto left = rangePredicate(*node.left);
+      auto right = rangePredicate(*node.right);
+      if (left == "true" || right == "true") {
+        return "true";
+      }
+      return "or " + left + " " + right;
+    }
+  }
+  return "true";
+}
+
+Node parseRangePredicate(std::string const& predicate)
+{
+  std::istringstream tokens(predicate);
+  return parseRangePredicate(tokens);
+}
+
+bool mayPass(Node const& node, ColumnRanges const& ranges)
+{
+  if (auto comparison = asComparison(node)) {
+    auto range = ranges(comparison->binding->name);
+    if (!range) {
+      return true;
+    }
+    auto value = comparison->value;
+    switch (comparison->op) {
+      case BasicOp::LessThan:
+        return range->min < value;
+      case BasicOp::LessThanOrEqual:
+        return range->min <= value;
+      case BasicOp::GreaterThan:
+        return range->max > value;
+      case BasicOp::GreaterThanOrEqual:
+        return range->max >= value;
+      case BasicOp::Equal:
+        return range->min <= value && value <= range->max;
+      default:
+        return true;
+    }
+  }
+  auto opNode = std::get_if<OpNode>(&node.self);
+  if (opNode != nullptr && node.left && node.right) {
+    if (opNode->op == BasicOp::LogicalAnd) {
+      return mayPass(*node.left, ranges) && mayPass(*node.right, ranges);
+    }
+    if (opNode->op == BasicOp::LogicalOr) {
+      return mayPass(*node.left, ranges) || mayPass(*node.right, ranges);
+    }
+  }
+  return true;
+}
+
 } // namespace o2::framework::expressions
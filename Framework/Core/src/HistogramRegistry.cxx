@@ -10,7 +10,10 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/HistogramRegistry.h"
+#include <algorithm>
 #include <regex>
+#include <TArrayD.h>
+#include <TArrayF.h>
 #include <TList.h>
 
 namespace o2::framework
@@ -18,15 +21,13 @@ namespace o2::framework
 
 constexpr HistogramRegistry::HistName::HistName(char const* const name)
   : str(name),
-    hash(compile_time_hash(name)),
-    idx(hash & REGISTRY_BITMASK)
+    hash(compile_time_hash(name))
 {
 }
 
 HistogramRegistry::HistogramRegistry(char const* const name, std::vector<HistogramSpec> histSpecs, OutputObjHandlingPolicy policy, bool sortHistos, bool createRegistryDir)
-  : mName(name), mPolicy(policy), mRegistryKey(), mRegistryValue(), mSortHistos(sortHistos), mCreateRegistryDir(createRegistryDir)
+  : mName(name), mPolicy(policy), mRegistryKey(INITIAL_REGISTRY_SIZE, 0u), mRegistryIndex(INITIAL_REGISTRY_SIZE, FREE_INDEX), mSortHistos(sortHistos), mCreateRegistryDir(createRegistryDir)
 {
-  mRegistryKey.fill(0u);
   for (auto& histSpec : histSpecs) {
     insert(histSpec);
   }
@@ -60,19 +61,62 @@ void HistogramRegistry::setHash(uint32_t hash)
 void HistogramRegistry::insert(const HistogramSpec& histSpec)
 {
   validateHistName(histSpec.name.data(), histSpec.hash);
-  const uint32_t idx = imask(histSpec.hash);
-  for (auto i = 0u; i < MAX_REGISTRY_SIZE; ++i) {
-    TObject* rawPtr = nullptr;
-    std::visit([&](const auto& sharedPtr) { rawPtr = sharedPtr.get(); }, mRegistryValue[imask(idx + i)]);
-    if (!rawPtr) {
-      registerName(histSpec.name);
-      mRegistryKey[imask(idx + i)] = histSpec.hash;
-      mRegistryValue[imask(idx + i)] = HistFactory::createHistVariant(histSpec);
+  registerName(histSpec.name);
+  insertHist(histSpec.hash, HistFactory::createHistVariant(histSpec));
+}
+
+void HistogramRegistry::insertHist(uint32_t hash, HistPtr hist)
+{
+  const uint32_t pos = getFreeIndex(hash);
+  const uint32_t idx = mRegistryValue.size();
+  mRegistryKey[pos] = hash;
+  mRegistryIndex[pos] = idx;
+  mRegistryValue.push_back(std::move(hist));
+  cloneToSlots(idx);
+  setupFillBuffers(idx);
+}
+
+// find the first free position along the probe sequence of the hash
+uint32_t HistogramRegistry::getFreeIndex(uint32_t hash)
+{
+  if (2 * (mRegistryValue.size() + 1) > mRegistryKey.size()) {
+    grow();
+  }
+  const uint32_t idx = imask(hash);
+  for (auto i = 0u; i < mRegistryKey.size(); ++i) {
+    if (mRegistryIndex[imask(idx + i)] == FREE_INDEX) {
       lookup += i;
-      return;
+      return imask(idx + i);
     }
   }
   LOGF(FATAL, R"(Internal array of HistogramRegistry "%s" is full.)", mName);
+  return 0;
+}
+
+// double the size of the lookup and insert the histograms again, which themselves stay in place
+void HistogramRegistry::grow()
+{
+  const uint32_t size = 2 * mRegistryKey.size();
+  std::vector<uint32_t> keys(size, 0u);
+  std::vector<uint32_t> indices(size, FREE_INDEX);
+
+  mRegistryMask = size - 1;
+  lookup = 0;
+  for (auto j = 0u; j < mRegistryKey.size(); ++j) {
+    if (mRegistryIndex[j] == FREE_INDEX) {
+      continue;
+    }
+    auto i = 0u;
+    while (indices[imask(mRegistryKey[j] + i)] != FREE_INDEX) {
+      ++i;
+    }
+    const uint32_t pos = imask(mRegistryKey[j] + i);
+    lookup += i;
+    keys[pos] = mRegistryKey[j];
+    indices[pos] = mRegistryIndex[j];
+  }
+  mRegistryKey = std::move(keys);
+  mRegistryIndex = std::move(indices);
 }
 
 // helper function that checks if histogram name can be used in registry
@@ -80,8 +124,8 @@ void HistogramRegistry::validateHistName(const char* name, const uint32_t hash)
 {
   // validate that hash is unique
   auto it = std::find(mRegistryKey.begin(), mRegistryKey.end(), hash);
-  if (it != mRegistryKey.end()) {
-    auto idx = it - mRegistryKey.begin();
+  if (it != mRegistryKey.end() && mRegistryIndex[it - mRegistryKey.begin()] != FREE_INDEX) {
+    auto idx = mRegistryIndex[it - mRegistryKey.begin()];
     std::string collidingName{};
     std::visit([&](const auto& hist) { collidingName = hist->GetName(); }, mRegistryValue[idx]);
     LOGF(FATAL, R"(Hash collision in HistogramRegistry "%s"! Please rename histogram "%s" or "%s".)", mName, name, collidingName);
@@ -134,7 +178,9 @@ void HistogramRegistry::addClone(const std::string& source, const std::string& t
     }
   };
 
-  for (auto& histVariant : mRegistryValue) {
+  // the registry may grow while the clones are inserted
+  auto histVariants = mRegistryValue;
+  for (auto& histVariant : histVariants) {
     std::visit(doInsertClone, histVariant);
   }
 }
@@ -143,12 +189,15 @@ void HistogramRegistry::addClone(const std::string& source, const std::string& t
 bool HistogramRegistry::contains(const HistName& histName)
 {
   // check for all occurances of the hash
-  auto iter = mRegistryKey.begin();
-  while ((iter = std::find(iter, mRegistryKey.end(), histName.hash)) != mRegistryKey.end()) {
+  for (auto iter = mRegistryKey.begin(); (iter = std::find(iter, mRegistryKey.end(), histName.hash)) != mRegistryKey.end(); ++iter) {
+    auto idx = mRegistryIndex[iter - mRegistryKey.begin()];
+    if (idx == FREE_INDEX) {
+      continue;
+    }
     const char* curName = nullptr;
-    std::visit([&](auto&& hist) { if(hist) { curName = hist->GetName(); } }, mRegistryValue[iter - mRegistryKey.begin()]);
+    std::visit([&](auto&& hist) { if(hist) { curName = hist->GetName(); } }, mRegistryValue[idx]);
     // if hash is the same, make sure that name is indeed the same
-    if (strcmp(curName, histName.str) == 0) {
+    if (curName && strcmp(curName, histName.str) == 0) {
       return true;
     }
   }
@@ -167,7 +216,7 @@ double HistogramRegistry::getSize(const HistName& histName, double fillFraction)
 double HistogramRegistry::getSize(double fillFraction)
 {
   double size{};
-  for (auto j = 0u; j < MAX_REGISTRY_SIZE; ++j) {
+  for (auto j = 0u; j < mRegistryValue.size(); ++j) {
     std::visit([&fillFraction, &size](auto&& hist) { if(hist) { size += HistFiller::getSize(hist, fillFraction);} }, mRegistryValue[j]);
   }
   return size;
@@ -262,13 +311,303 @@ void HistogramRegistry::print(bool showAxisDetails)
   LOGF(INFO, "");
 }
 
+// give each of the additional threads of a parallel processing its own copy of the histograms
+void HistogramRegistry::beginParallel(int nSlots)
+{
+  mSlotRegistryValue.resize(std::max(nSlots - 1, 0));
+  if (mFillBufferSize != 0) {
+    // the copies start from empty buffers
+    flush();
+    mSlotFillBuffers.resize(mSlotRegistryValue.size(), mFillBuffers);
+  }
+  for (auto j = 0u; j < mRegistryValue.size(); ++j) {
+    cloneToSlots(j);
+  }
+  mParallel = !mSlotRegistryValue.empty();
+}
+
+void HistogramRegistry::cloneToSlots(uint32_t idx)
+{
+  for (auto& slotValues : mSlotRegistryValue) {
+    if (slotValues.size() <= idx) {
+      slotValues.resize(idx + 1);
+    }
+    TObject* copy{};
+    std::visit([&copy](const auto& hist) { copy = hist.get(); }, slotValues[idx]);
+    if (copy) {
+      continue;
+    }
+    std::visit([&slotValues, idx](const auto& hist) {
+      if (hist) {
+        using T = typename std::decay_t<decltype(hist)>::element_type;
+        slotValues[idx] = std::shared_ptr<T>(static_cast<T*>(hist->Clone()));
+      }
+    },
+               mRegistryValue[idx]);
+  }
+}
+
+// merge the copies filled by the additional threads into the histograms and reset them for the next processing
+void HistogramRegistry::endParallel()
+{
+  flush();
+  // the histograms themselves are filled again by all the threads
+  mParallel = false;
+  for (auto j = 0u; j < mRegistryValue.size(); ++j) {
+    std::visit([&](auto& hist) {
+      if (!hist) {
+        return;
+      }
+      using T = typename std::decay_t<decltype(hist)>::element_type;
+      TList copies;
+      for (auto& slotValues : mSlotRegistryValue) {
+        if (auto copy = std::get_if<std::shared_ptr<T>>(&slotValues[j]); copy && *copy) {
+          copies.Add(copy->get());
+        }
+      }
+      if (copies.GetEntries() == 0) {
+        return;
+      }
+      hist->Merge(&copies);
+      for (auto& slotValues : mSlotRegistryValue) {
+        if (auto copy = std::get_if<std::shared_ptr<T>>(&slotValues[j]); copy && *copy) {
+          if constexpr (std::is_base_of_v<StepTHn, T>) {
+            // StepTHn cannot be reset, a new copy is made for the next processing
+            copy->reset();
+          } else {
+            (*copy)->Reset();
+          }
+        }
+      }
+    },
+               mRegistryValue[j]);
+  }
+}
+
+void HistogramRegistry::setFillBufferSize(uint32_t bufferSize)
+{
+  flush();
+  mFillBufferSize = bufferSize;
+  if (bufferSize == 0) {
+    mFillBuffers.clear();
+    mSlotFillBuffers.clear();
+    return;
+  }
+  mSlotFillBuffers.resize(mSlotRegistryValue.size());
+  for (auto j = 0u; j < mRegistryValue.size(); ++j) {
+    setupFillBuffers(j);
+  }
+}
+
+// only TH1, TH2 and TH3 fills are buffered, the other histograms are filled directly
+void HistogramRegistry::setupFillBuffers(uint32_t idx)
+{
+  if (mFillBufferSize == 0) {
+    return;
+  }
+  int nDimensions = 0;
+  std::visit([&nDimensions](const auto& hist) {
+    using T = typename std::decay_t<decltype(hist)>::element_type;
+    if constexpr (std::is_same_v<TH1, T> || std::is_same_v<TH2, T> || std::is_same_v<TH3, T>) {
+      if (hist) {
+        nDimensions = hist->GetDimension();
+      }
+    }
+  },
+             mRegistryValue[idx]);
+  for (int slot = 0; slot <= (int)mSlotFillBuffers.size(); ++slot) {
+    if (fillBuffers(slot).size() <= idx) {
+      fillBuffers(slot).resize(idx + 1);
+    }
+    auto& buffer = fillBuffers(slot)[idx];
+    buffer.nDimensions = nDimensions;
+    buffer.x.reserve(mFillBufferSize);
+    buffer.y.reserve(nDimensions > 1 ? mFillBufferSize : 0);
+    buffer.z.reserve(nDimensions > 2 ? mFillBufferSize : 0);
+    buffer.w.reserve(mFillBufferSize);
+  }
+}
+
+void HistogramRegistry::flush()
+{
+  if (mFillBuffers.empty()) {
+    return;
+  }
+  for (int slot = 0; slot <= (int)mSlotFillBuffers.size(); ++slot) {
+    for (auto j = 0u; j < mRegistryValue.size(); ++j) {
+      flush(slot, j);
+    }
+  }
+}
+
+void HistogramRegistry::flush(int slot, uint32_t idx)
+{
+  auto& buffer = fillBuffers(slot)[idx];
+  if (buffer.w.empty()) {
+    return;
+  }
+  std::visit([&buffer](const auto& hist) {
+    using T = typename std::decay_t<decltype(hist)>::element_type;
+    if constexpr (std::is_base_of_v<TH1, T>) {
+      applyFills(hist.get(), buffer);
+    }
+  },
+             values(slot)[idx]);
+  buffer.x.clear();
+  buffer.y.clear();
+  buffer.z.clear();
+  buffer.w.clear();
+}
+
+namespace
+{
+// bins of the coordinates along an axis, following TAxis::FindBin for axes which cannot be extended
+void findBins(const TAxis* axis, const double* x, size_t n, std::vector<int>& bins)
+{
+  const int nBins = axis->GetNbins();
+  const double min = axis->GetXmin();
+  const double max = axis->GetXmax();
+  bins.resize(n);
+  if (axis->GetXbins()->fN == 0) {
+    for (size_t i = 0; i < n; ++i) {
+      bins[i] = (x[i] < min) ? 0 : (!(x[i] < max) ? nBins + 1 : 1 + int(nBins * (x[i] - min) / (max - min)));
+    }
+  } else {
+    const double* edges = axis->GetXbins()->GetArray();
+    for (size_t i = 0; i < n; ++i) {
+      bins[i] = (x[i] < min) ? 0 : (!(x[i] < max) ? nBins + 1 : int(std::upper_bound(edges, edges + nBins + 1, x[i]) - edges));
+    }
+  }
+}
+
+// apply n fills, in the same order and with the same arithmetic as TH1::Fill, TH2::Fill and TH3::Fill
+void applyFillRange(TH1* hist, const double* x, const double* y, const double* z, const double* w, size_t n)
+{
+  if (n == 0) {
+    return;
+  }
+  const int nDimensions = hist->GetDimension();
+  const TAxis* axes[3] = {hist->GetXaxis(), hist->GetYaxis(), hist->GetZaxis()};
+  const double* coordinates[3] = {x, y, z};
+
+  // global bin of each entry and whether it lies within the axis ranges
+  std::vector<int> globalBins(n, 0);
+  std::vector<char> inRange(n, 1);
+  std::vector<int> bins;
+  int stride = 1;
+  for (int d = 0; d < nDimensions; ++d) {
+    findBins(axes[d], coordinates[d], n, bins);
+    const int nBins = axes[d]->GetNbins();
+    for (size_t i = 0; i < n; ++i) {
+      globalBins[i] += stride * bins[i];
+      inRange[i] &= (bins[i] != 0 && bins[i] <= nBins);
+    }
+    stride *= nBins + 2;
+  }
+
+  // the stats are read before the bins are touched: if the sum of weights is
+  // zero with entries, GetStats recomputes them from the bin contents
+  double stats[TH1::kNstat] = {0};
+  hist->GetStats(stats);
+
+  if (auto array = dynamic_cast<TArrayD*>(hist)) {
+    for (size_t i = 0; i < n; ++i) {
+      array->fArray[globalBins[i]] += w[i];
+    }
+  } else if (auto array = dynamic_cast<TArrayF*>(hist)) {
+    for (size_t i = 0; i < n; ++i) {
+      array->fArray[globalBins[i]] += Float_t(w[i]);
+    }
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      hist->AddBinContent(globalBins[i], w[i]);
+    }
+  }
+  if (hist->GetSumw2N()) {
+    double* sumw2 = hist->GetSumw2()->GetArray();
+    for (size_t i = 0; i < n; ++i) {
+      sumw2[globalBins[i]] += w[i] * w[i];
+    }
+  }
+
+  const bool statOverflows = hist->GetStatOverflowsBehaviour();
+  for (size_t i = 0; i < n; ++i) {
+    if (!inRange[i] && !statOverflows) {
+      continue;
+    }
+    const double v = w[i];
+    stats[0] += v;
+    stats[1] += v * v;
+    stats[2] += v * x[i];
+    stats[3] += v * x[i] * x[i];
+    if (nDimensions > 1) {
+      stats[4] += v * y[i];
+      stats[5] += v * y[i] * y[i];
+      stats[6] += v * x[i] * y[i];
+    }
+    if (nDimensions > 2) {
+      stats[7] += v * z[i];
+      stats[8] += v * z[i] * z[i];
+      stats[9] += v * x[i] * z[i];
+      stats[10] += v * y[i] * z[i];
+    }
+  }
+  hist->PutStats(stats);
+  hist->SetEntries(hist->GetEntries() + n);
+}
+} // namespace
+
+void HistogramRegistry::applyFills(TH1* hist, FillBuffer& buffer)
+{
+  const size_t n = buffer.w.size();
+  const double* x = buffer.x.data();
+  const double* y = buffer.y.data();
+  const double* z = buffer.z.data();
+  const double* w = buffer.w.data();
+
+  // histograms with their own fill buffer or axes which may change during the filling are filled one entry at a time
+  bool fillDirectly = hist->GetBufferSize() > 0;
+  for (auto axis : {hist->GetXaxis(), hist->GetYaxis(), hist->GetZaxis()}) {
+    fillDirectly |= axis->CanExtend() || axis->IsAlphanumeric() || axis->TestBit(TAxis::kAxisRange);
+  }
+  if (fillDirectly) {
+    for (size_t i = 0; i < n; ++i) {
+      switch (buffer.nDimensions) {
+        case 1:
+          hist->Fill(x[i], w[i]);
+          break;
+        case 2:
+          static_cast<TH2*>(hist)->Fill(x[i], y[i], w[i]);
+          break;
+        case 3:
+          static_cast<TH3*>(hist)->Fill(x[i], y[i], z[i], w[i]);
+          break;
+      }
+    }
+    return;
+  }
+
+  // a weighted fill enables the storage of the sum of squares of weights, as TH1::Fill does
+  size_t first = 0;
+  if (!hist->GetSumw2N() && !hist->TestBit(TH1::kIsNotW)) {
+    size_t weighted = std::find_if(w, w + n, [](double weight) { return weight != 1.; }) - w;
+    if (weighted != n) {
+      applyFillRange(hist, x, y, z, w, weighted);
+      hist->Sumw2();
+      first = weighted;
+    }
+  }
+  applyFillRange(hist, x + first, buffer.nDimensions > 1 ? y + first : y, buffer.nDimensions > 2 ? z + first : z, w + first, n - first);
+}
+
 // create output structure will be propagated to file-sink
 TList* HistogramRegistry::operator*()
 {
   TList* list = new TList();
   list->SetName(mName.data());
 
-  for (auto i = 0u; i < MAX_REGISTRY_SIZE; ++i) {
+  flush();
+  for (auto i = 0u; i < mRegistryValue.size(); ++i) {
     TNamed* rawPtr = nullptr;
     std::visit([&](const auto& sharedPtr) { rawPtr = (TNamed*)sharedPtr.get(); }, mRegistryValue[i]);
     if (rawPtr) {
@@ -11,6 +11,7 @@
 
 #include "Framework/Output.h"
 #include "Framework/MessageContext.h"
+#include "Framework/MessagePool.h"
 #include "fairmq/FairMQDevice.h"
 
 namespace o2
@@ -20,6 +21,12 @@ namespace framework
 
 FairMQMessagePtr MessageContext::createMessage(const std::string& channel, int index, size_t size)
 {
+  if (mPool && size <= MessagePool::MaxBlockSize) {
+    auto message = mPool->create(channel, size);
+    if (message) {
+      return message;
+    }
+  }
   return proxy().getDevice()->NewMessageFor(channel, 0, size, fair::mq::Alignment{64});
 }
 
@@ -0,0 +1,91 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/MessagePool.h"
+#include "Framework/Logger.h"
+
+#include <fairmq/FairMQDevice.h>
+#include <fairmq/FairMQUnmanagedRegion.h>
+
+namespace o2::framework
+{
+
+MessagePool::MessagePool(FairMQDevice* device, size_t regionSize)
+  : mDevice{device},
+    mRegionSize{regionSize}
+{
+}
+
+MessagePool::~MessagePool() = default;
+
+MessagePool::ChannelPool* MessagePool::getChannelPool(std::string const& channel)
+{
+  std::lock_guard<std::mutex> lock(mPoolsMutex);
+  auto pi = mPools.find(channel);
+  if (pi != mPools.end()) {
+    return pi->second.get();
+  }
+  auto pool = std::make_unique<ChannelPool>();
+  auto* poolPtr = pool.get();
+  try {
+    // Invoked whenever the last user of a message created on the region
+    // lets it go. The hint is the size class of the block.
+    pool->region = mDevice->NewUnmanagedRegionFor(channel, 0, mRegionSize, [poolPtr](void* data, size_t, void* hint) {
+      std::lock_guard<std::mutex> lock(poolPtr->mutex);
+      poolPtr->free[reinterpret_cast<size_t>(hint)].push_back(data);
+    });
+    pool->next = reinterpret_cast<char*>(pool->region->GetData());
+    pool->end = pool->next + pool->region->GetSize();
+    LOGP(DEBUG, "Created message pool region of {} bytes for channel {}", mRegionSize, channel);
+  } catch (std::exception& e) {
+    // Not all the transports support unmanaged regions. Requests for the
+    // channel will not be served by the pool.
+    LOGP(WARNING, "Unable to create message pool region for channel {}: {}", channel, e.what());
+    pool->region.reset();
+  }
+  return mPools.emplace(channel, std::move(pool)).first->second.get();
+}
+
+FairMQMessagePtr MessagePool::create(std::string const& channel, size_t size)
+{
+  int sc = sizeClass(size);
+  if (sc < 0) {
+    return nullptr;
+  }
+  auto* pool = getChannelPool(channel);
+  if (pool->region.get() == nullptr) {
+    mMisses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  void* block = nullptr;
+  {
+    // the region is also carved by the other streams sharing the pool
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    auto& freeBlocks = pool->free[sc];
+    if (freeBlocks.empty() == false) {
+      block = freeBlocks.back();
+      freeBlocks.pop_back();
+      mHits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      mMisses.fetch_add(1, std::memory_order_relaxed);
+      size_t blockSize = MinBlockSize << sc;
+      // The region is exhausted, the caller allocates as usual.
+      if (pool->next + blockSize > pool->end) {
+        return nullptr;
+      }
+      block = pool->next;
+      pool->next += blockSize;
+    }
+  }
+  return mDevice->NewMessageFor(channel, 0, pool->region, block, size, reinterpret_cast<void*>(static_cast<size_t>(sc)));
+}
+
+} // namespace o2::framework
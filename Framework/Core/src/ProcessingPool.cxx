@@ -0,0 +1,106 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/ProcessingPool.h"
+
+namespace o2::framework
+{
+
+ProcessingSlot& ProcessingSlot::current()
+{
+  static thread_local ProcessingSlot slot;
+  return slot;
+}
+
+ProcessingPool::ProcessingPool(int nSlots)
+{
+  for (int slot = 1; slot < nSlots; ++slot) {
+    mThreads.emplace_back([this, slot]() { loop(slot); });
+  }
+}
+
+ProcessingPool::~ProcessingPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mStartCondition.notify_all();
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+}
+
+void ProcessingPool::run(int nChunks, std::function<void(int)> const& job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJob = &job;
+    mNChunks = nChunks;
+    mNextChunk = 0;
+    mRunning = static_cast<int>(mThreads.size());
+    mError = nullptr;
+    ++mGeneration;
+  }
+  mStartCondition.notify_all();
+  work(0);
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  mDoneCondition.wait(lock, [this]() { return mRunning == 0; });
+  mJob = nullptr;
+  if (mError) {
+    std::rethrow_exception(mError);
+  }
+}
+
+void ProcessingPool::loop(int slot)
+{
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStartCondition.wait(lock, [this, generation]() { return mStop || mGeneration != generation; });
+      if (mStop) {
+        return;
+      }
+      generation = mGeneration;
+    }
+    work(slot);
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (--mRunning == 0) {
+        mDoneCondition.notify_one();
+      }
+    }
+  }
+}
+
+void ProcessingPool::work(int slot)
+{
+  auto& current = ProcessingSlot::current();
+  current.slot = slot;
+  for (int chunk = mNextChunk++; chunk < mNChunks; chunk = mNextChunk++) {
+    current.chunk = chunk;
+    try {
+      (*mJob)(chunk);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (!mError) {
+        mError = std::current_exception();
+      }
+      mNextChunk = mNChunks;
+    }
+  }
+  current.chunk = -1;
+  current.slot = -1;
+}
+
+} // namespace o2::framework
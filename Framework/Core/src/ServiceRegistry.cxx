@@ -67,12 +67,47 @@ void ServiceRegistry::registerService(hash_type typeHash, void* service, Service
 void ServiceRegistry::declareService(ServiceSpec const& spec, DeviceState& state, fair::mq::ProgOptions& options)
 {
   mSpecs.push_back(spec);
-  // Services which are not stream must have a single instance created upfront.
-  if (spec.kind != ServiceKind::Stream) {
+  // All the services have an instance created upfront. For stream services
+  // this is the one used by the main thread.
+  ServiceHandle handle = spec.init(*this, state, options);
+  auto kind = spec.kind == ServiceKind::Stream ? ServiceKind::Stream : handle.kind;
+  this->registerService(handle.hash, handle.instance, kind, 0, handle.name.c_str());
+  this->bindService(spec, handle.instance);
+}
+
+std::vector<ServiceHandle> ServiceRegistry::createStreamServices(DeviceState& state, fair::mq::ProgOptions& options,
+                                                                 std::vector<ServiceProcessingHandle>& preProcessing,
+                                                                 std::vector<ServiceProcessingHandle>& postProcessing)
+{
+  std::vector<ServiceHandle> handles;
+  for (auto& spec : mSpecs) {
+    if (spec.kind != ServiceKind::Stream) {
+      continue;
+    }
     ServiceHandle handle = spec.init(*this, state, options);
-    this->registerService(handle.hash, handle.instance, handle.kind, 0, handle.name.c_str());
-    this->bindService(spec, handle.instance);
+    handle.kind = ServiceKind::Stream;
+    if (spec.preProcessing) {
+      preProcessing.push_back(ServiceProcessingHandle{spec.preProcessing, handle.instance});
+    }
+    if (spec.postProcessing) {
+      postProcessing.push_back(ServiceProcessingHandle{spec.postProcessing, handle.instance});
+    }
+    handles.push_back(handle);
   }
+  return handles;
+}
+
+ServiceRegistry ServiceRegistry::makeStreamRegistry(std::vector<ServiceHandle> const& handles) const
+{
+  ServiceRegistry registry{*this};
+  for (auto& handle : handles) {
+    for (size_t i = 0; i < registry.mServicesKey.size(); ++i) {
+      if (registry.mServicesBooked[i].load() && registry.mServicesKey[i].load() == handle.hash && registry.mServicesMeta[i].kind == ServiceKind::Stream) {
+        registry.mServicesValue[i] = handle.instance;
+      }
+    }
+  }
+  return registry;
 }
 
 void ServiceRegistry::bindService(ServiceSpec const& spec, void* service)
@@ -80,10 +115,10 @@ void ServiceRegistry::bindService(ServiceSpec const& spec, void* service)
   static TracyLockableN(std::mutex, bindMutex, "bind mutex");
   std::scoped_lock<LockableBase(std::mutex)> lock(bindMutex);
   if (spec.preProcessing) {
-    mPreProcessingHandles.push_back(ServiceProcessingHandle{spec.preProcessing, service});
+    mPreProcessingHandles.push_back(ServiceProcessingHandle{spec.preProcessing, service, spec.kind});
   }
   if (spec.postProcessing) {
-    mPostProcessingHandles.push_back(ServiceProcessingHandle{spec.postProcessing, service});
+    mPostProcessingHandles.push_back(ServiceProcessingHandle{spec.postProcessing, service, spec.kind});
   }
   if (spec.preDangling) {
     mPreDanglingHandles.push_back(ServiceDanglingHandle{spec.preDangling, service});
@@ -122,6 +157,26 @@ void ServiceRegistry::postProcessingCallbacks(ProcessingContext& processContext)
     handle.callback(processContext, handle.service);
   }
 }
+/// Invoke callbacks to be executed before every process method invokation
+/// on a worker stream, except those of the stream services
+void ServiceRegistry::preWorkerProcessingCallbacks(ProcessingContext& processContext)
+{
+  for (auto& handle : mPreProcessingHandles) {
+    if (handle.kind != ServiceKind::Stream) {
+      handle.callback(processContext, handle.service);
+    }
+  }
+}
+/// Invoke callbacks to be executed after every process method invokation
+/// on a worker stream, except those of the stream services
+void ServiceRegistry::postWorkerProcessingCallbacks(ProcessingContext& processContext)
+{
+  for (auto& handle : mPostProcessingHandles) {
+    if (handle.kind != ServiceKind::Stream) {
+      handle.callback(processContext, handle.service);
+    }
+  }
+}
 /// Invoke callbacks to be executed before every dangling check
 void ServiceRegistry::preDanglingCallbacks(DanglingContext& danglingContext)
 {
@@ -11,9 +11,20 @@
 #include "Framework/TableTreeHelpers.h"
 #include <stdexcept>
 #include "Framework/Logger.h"
+#include "Framework/RuntimeError.h"
+#include "Framework/StringHelpers.h"
 
 #include "arrow/type_traits.h"
+#include <arrow/buffer.h>
 #include <arrow/util/key_value_metadata.h>
+#include <TBufferFile.h>
+#include <TLeaf.h>
+#include <TParameter.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string_view>
 
 namespace o2::framework
 {
@@ -22,88 +33,75 @@ namespace
 {
 // -----------------------------------------------------------------------------
 // TreeToTable allows to fill the contents of a given TTree to an arrow::Table
-//  ColumnIterator is used by TreeToTable
+//  BranchToColumn is used by TreeToTable
 //
 // To copy the contents of a tree tr to a table ta do:
-//  . TreeToTable t2t(tr);
+//  . TreeToTable t2t;
 //  . t2t.addColumn(columnname1); t2t.addColumn(columnname2); ...
 //    OR
-//    t2t.addAllColumns();
-//  . auto ta = t2t.process();
+//    t2t.addAllColumns(tr);
+//  . t2t.fill(tr);
+//  . auto ta = t2t.finalize();
 //
 // .............................................................................
-class ColumnIterator
+class BranchToColumn
 {
 
  private:
-  // all the possible TTreeReaderValue<T> types
-  TTreeReaderValue<bool>* mReaderValue_o = nullptr;
-  TTreeReaderValue<uint8_t>* mReaderValue_ub = nullptr;
-  TTreeReaderValue<uint16_t>* mReaderValue_us = nullptr;
-  TTreeReaderValue<uint32_t>* mReaderValue_ui = nullptr;
-  TTreeReaderValue<ULong64_t>* mReaderValue_ul = nullptr;
-  TTreeReaderValue<int8_t>* mReaderValue_b = nullptr;
-  TTreeReaderValue<int16_t>* mReaderValue_s = nullptr;
-  TTreeReaderValue<int32_t>* mReaderValue_i = nullptr;
-  TTreeReaderValue<int64_t>* mReaderValue_l = nullptr;
-  TTreeReaderValue<float>* mReaderValue_f = nullptr;
-  TTreeReaderValue<double>* mReaderValue_d = nullptr;
-
-  // all the possible TTreeReaderArray<T> types
-  TTreeReaderArray<bool>* mReaderArray_o = nullptr;
-  TTreeReaderArray<uint8_t>* mReaderArray_ub = nullptr;
-  TTreeReaderArray<uint16_t>* mReaderArray_us = nullptr;
-  TTreeReaderArray<uint32_t>* mReaderArray_ui = nullptr;
-  TTreeReaderArray<uint64_t>* mReaderArray_ul = nullptr;
-  TTreeReaderArray<int8_t>* mReaderArray_b = nullptr;
-  TTreeReaderArray<int16_t>* mReaderArray_s = nullptr;
-  TTreeReaderArray<int32_t>* mReaderArray_i = nullptr;
-  TTreeReaderArray<int64_t>* mReaderArray_l = nullptr;
-  TTreeReaderArray<float>* mReaderArray_f = nullptr;
-  TTreeReaderArray<double>* mReaderArray_d = nullptr;
-
-  // all the possible arrow::TBuilder types
-  arrow::FixedSizeListBuilder* mTableBuilder_list = nullptr;
-
-  arrow::BooleanBuilder* mTableBuilder_o = nullptr;
-  arrow::UInt8Builder* mTableBuilder_ub = nullptr;
-  arrow::UInt16Builder* mTableBuilder_us = nullptr;
-  arrow::UInt32Builder* mTableBuilder_ui = nullptr;
-  arrow::UInt64Builder* mTableBuilder_ul = nullptr;
-  arrow::Int8Builder* mTableBuilder_b = nullptr;
-  arrow::Int16Builder* mTableBuilder_s = nullptr;
-  arrow::Int32Builder* mTableBuilder_i = nullptr;
-  arrow::Int64Builder* mTableBuilder_l = nullptr;
-  arrow::FloatBuilder* mTableBuilder_f = nullptr;
-  arrow::DoubleBuilder* mTableBuilder_d = nullptr;
+  TBranch* mBranch = nullptr;
+  // branch holding the number of elements of a variable size array
+  TBranch* mCountBranch = nullptr;
+  TLeaf* mCountLeaf = nullptr;
+  int mCountSize = 0;
 
   bool mStatus = false;
-  EDataType mElementType;
-  int64_t mNumberElements;
   const char* mColumnName;
+  EDataType mElementType;
+  std::shared_ptr<arrow::DataType> mElementArrowType;
+  int mElementSize = 0;
+  // number of elements of a fixed size array, 1 for a single value
+  int64_t mNumberElements = 1;
 
   std::shared_ptr<arrow::Field> mField;
-  std::shared_ptr<arrow::Array> mArray;
+
+  // the values read so far and, for a variable size array, the offsets of
+  // all the entries to read
+  std::shared_ptr<arrow::ResizableBuffer> mValues;
+  std::shared_ptr<arrow::ResizableBuffer> mOffsets;
+  int64_t mNumEntries = 0;
+  int64_t mNumValues = 0;
+
+  // read the values of the entries [first, last)
+  void readFixedSize(int64_t first, int64_t last, TBufferFile& buffer);
+  // read the sizes and the values of the entries [first, last) of a variable size array
+  void readVariableSize(int64_t first, int64_t last, TBufferFile& buffer);
+  // copy to @a dst the values of the entries [first, last) of @a branch,
+  // basket by basket if the branch supports bulk reading. @return the
+  // first entry which was not read this way.
+  int64_t bulkRead(TBranch* branch, int64_t first, int64_t last, TBufferFile& buffer, std::function<void(unsigned char const*, int64_t, int64_t)> const& copy);
+  // the arrow::Array of the elements, from the values as stored by ROOT
+  std::shared_ptr<arrow::Array> makeValues(std::shared_ptr<arrow::Buffer> values, int64_t numValues);
 
  public:
-  ColumnIterator(TTreeReader& reader, const char* colname);
-  ~ColumnIterator();
+  BranchToColumn(TTree* tree, const char* colname);
 
-  // has the iterator been properly initialized
+  // has the column been properly initialized
   bool getStatus();
 
-  // copy the TTreeReaderValue to the arrow::TBuilder
-  void push();
+  std::shared_ptr<arrow::Field> getSchema() { return mField; }
 
-  // reserve enough space to push s elements without reallocating
-  void reserve(size_t s);
+  TBranch* getCountBranch() { return mCountBranch; }
 
-  std::shared_ptr<arrow::Array> getArray() { return mArray; }
-  std::shared_ptr<arrow::Field> getSchema() { return mField; }
+  // allocate the buffers for @a numEntries entries
+  void prepare(int64_t numEntries);
 
-  // finish the arrow::TBuilder
-  // with this mArray is prepared to be used in arrow::Table::Make
-  void finish();
+  // read the entries [first, last), following the ones read before. The
+  // baskets of branches supporting bulk reading are copied at once, the
+  // entries of the other ones are deserialized one by one by ROOT.
+  void read(int64_t first, int64_t last, TBufferFile& buffer);
+
+  // @return the column with all the entries
+  std::shared_ptr<arrow::Array> finish();
 };
 } // namespace
 
@@ -419,425 +417,489 @@ bool TableToTree::addAllBranches()
   return status;
 }
 
-TTree* TableToTree::process()
+namespace
 {
-
-  bool togo = mTreePtr->GetNbranches() > 0;
-  while (togo) {
-    // fill the tree
-    mTreePtr->Fill();
-
-    // update the branches
-    for (auto brit : mBranchIterators) {
-      togo &= brit->push();
+template <typename T>
+void updateRange(arrow::ChunkedArray const& column, double& min, double& max)
+{
+  for (auto const& chunk : column.chunks()) {
+    auto values = std::static_pointer_cast<arrow::NumericArray<T>>(chunk);
+    for (int64_t i = 0; i < values->length(); ++i) {
+      auto value = static_cast<double>(values->Value(i));
+      // NaNs are ignored
+      min = std::min(min, value);
+      max = std::max(max, value);
     }
   }
-  mTreePtr->Write("", TObject::kOverwrite);
-
-  return mTreePtr;
 }
 
-// -----------------------------------------------------------------------------
-#define MAKE_LIST_BUILDER(ElementType, NumElements)                \
-  std::unique_ptr<arrow::ArrayBuilder> ValueBuilder;               \
-  arrow::MemoryPool* MemoryPool = arrow::default_memory_pool();    \
-  auto stat = MakeBuilder(MemoryPool, ElementType, &ValueBuilder); \
-  mTableBuilder_list = new arrow::FixedSizeListBuilder(            \
-    MemoryPool,                                                    \
-    std::move(ValueBuilder),                                       \
-    NumElements);
-
-#define MAKE_FIELD(ElementType, NumElements)                                                         \
-  if (NumElements == 1) {                                                                            \
-    mField =                                                                                         \
-      std::make_shared<arrow::Field>(mColumnName, ElementType);                                      \
-  } else {                                                                                           \
-    mField =                                                                                         \
-      std::make_shared<arrow::Field>(mColumnName, arrow::fixed_size_list(ElementType, NumElements)); \
-  }
-
-#define MAKE_FIELD_AND_BUILDER(ElementCType, NumElements, Builder)                                                                            \
-  MAKE_FIELD(arrow::TypeTraits<arrow::CTypeTraits<ElementCType>::ArrowType>::type_singleton(), NumElements);                                  \
-  if (NumElements == 1) {                                                                                                                     \
-    arrow::MemoryPool* MemoryPool = arrow::default_memory_pool();                                                                             \
-    Builder = new arrow::TypeTraits<arrow::CTypeTraits<ElementCType>::ArrowType>::BuilderType(MemoryPool);                                    \
-  } else {                                                                                                                                    \
-    MAKE_LIST_BUILDER(arrow::TypeTraits<arrow::CTypeTraits<ElementCType>::ArrowType>::type_singleton(), NumElements);                         \
-    Builder = static_cast<arrow::TypeTraits<arrow::CTypeTraits<ElementCType>::ArrowType>::BuilderType*>(mTableBuilder_list->value_builder()); \
-  }
-
-// is used in TreeToTable
-ColumnIterator::ColumnIterator(TTreeReader& reader, const char* colname)
+void mergeParameter(TList* userInfo, std::string const& name, double value, bool isMin, bool isNew)
 {
-
-  // find branch
-  auto tree = reader.GetTree();
-  if (!tree) {
-    LOGP(FATAL, "Can not locate tree!");
+  auto parameter = (TParameter<double>*)userInfo->FindObject(name.c_str());
+  if (parameter == nullptr) {
+    if (isNew) {
+      userInfo->Add(new TParameter<double>(name.c_str(), value));
+    }
     return;
   }
+  parameter->SetVal(isMin ? std::min(parameter->GetVal(), value) : std::max(parameter->GetVal(), value));
+}
 
-  auto br = tree->GetBranch(colname);
-  if (!br) {
-    LOGP(WARNING, "Can not locate branch {}", colname);
+// The range of the values of the numeric columns is stored with the tree,
+// as "min:<column>" and "max:<column>" parameters of its user info, so
+// that the readers can skip the trees in which no row can pass their
+// selections. Ranges are only kept if they cover all the entries.
+void storeColumnRanges(TTree* tree, arrow::Table const& table)
+{
+  if (table.num_rows() == 0) {
     return;
   }
-  mColumnName = colname;
-
-  // type of the branch elements
-  TClass* cl;
-  br->GetExpectedType(cl, mElementType);
-
-  // currently only single-value or single-array branches are accepted
-  // thus of the form e.g. alpha/D or alpha[5]/D
-  // check if this is a single-value or single-array branch
-  mNumberElements = 1;
-  std::string branchTitle = br->GetTitle();
-  Int_t pos0 = branchTitle.find("[");
-  Int_t pos1 = branchTitle.find("]");
-  if (pos0 > 0 && pos1 > 0) {
-    mNumberElements = atoi(branchTitle.substr(pos0 + 1, pos1 - pos0 - 1).c_str());
-  }
-
-  // initialize the TTreeReaderValue<T> / TTreeReaderArray<T>
-  //            the corresponding arrow::TBuilder
-  //            the column field
-  // the TTreeReaderValue is incremented by reader->Next()
-  // switch according to mElementType
-  mStatus = true;
-
-  if (mNumberElements == 1) {
-    switch (mElementType) {
-      case EDataType::kBool_t:
-        mReaderValue_o = new TTreeReaderValue<bool>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(bool, 1, mTableBuilder_o);
-        break;
-      case EDataType::kUChar_t:
-        mReaderValue_ub = new TTreeReaderValue<uint8_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint8_t, 1, mTableBuilder_ub);
-        break;
-      case EDataType::kUShort_t:
-        mReaderValue_us = new TTreeReaderValue<uint16_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint16_t, 1, mTableBuilder_us);
-        break;
-      case EDataType::kUInt_t:
-        mReaderValue_ui = new TTreeReaderValue<uint32_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint32_t, 1, mTableBuilder_ui);
-        break;
-      case EDataType::kULong64_t:
-        mReaderValue_ul = new TTreeReaderValue<ULong64_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint64_t, 1, mTableBuilder_ul);
-        break;
-      case EDataType::kChar_t:
-        mReaderValue_b = new TTreeReaderValue<int8_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int8_t, 1, mTableBuilder_b);
-        break;
-      case EDataType::kShort_t:
-        mReaderValue_s = new TTreeReaderValue<int16_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int16_t, 1, mTableBuilder_s);
-        break;
-      case EDataType::kInt_t:
-        mReaderValue_i = new TTreeReaderValue<int32_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int32_t, 1, mTableBuilder_i);
-        break;
-      case EDataType::kLong64_t:
-        mReaderValue_l = new TTreeReaderValue<int64_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int64_t, 1, mTableBuilder_l);
-        break;
-      case EDataType::kFloat_t:
-        mReaderValue_f = new TTreeReaderValue<float>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(float, 1, mTableBuilder_f);
-        break;
-      case EDataType::kDouble_t:
-        mReaderValue_d = new TTreeReaderValue<double>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(double, 1, mTableBuilder_d);
-        break;
-      default:
-        LOGP(FATAL, "Type {} not handled!", mElementType);
-        break;
+  bool isNew = tree->GetEntries() == 0;
+  for (int ci = 0; ci < table.num_columns(); ++ci) {
+    auto const& name = table.schema()->field(ci)->name();
+    if (tree->GetBranch(name.c_str()) == nullptr) {
+      continue;
     }
-  } else {
-    switch (mElementType) {
-      case EDataType::kBool_t:
-        mReaderArray_o = new TTreeReaderArray<bool>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(bool, mNumberElements, mTableBuilder_o);
+    auto const& column = *table.column(ci);
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    switch (column.type()->id()) {
+      case arrow::Type::UINT8:
+        updateRange<arrow::UInt8Type>(column, min, max);
         break;
-      case EDataType::kUChar_t:
-        mReaderArray_ub = new TTreeReaderArray<uint8_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint8_t, mNumberElements, mTableBuilder_ub);
+      case arrow::Type::UINT16:
+        updateRange<arrow::UInt16Type>(column, min, max);
         break;
-      case EDataType::kUShort_t:
-        mReaderArray_us = new TTreeReaderArray<uint16_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint16_t, mNumberElements, mTableBuilder_us);
+      case arrow::Type::UINT32:
+        updateRange<arrow::UInt32Type>(column, min, max);
         break;
-      case EDataType::kUInt_t:
-        mReaderArray_ui = new TTreeReaderArray<uint32_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint32_t, mNumberElements, mTableBuilder_ui);
+      case arrow::Type::UINT64:
+        updateRange<arrow::UInt64Type>(column, min, max);
         break;
-      case EDataType::kULong64_t:
-        mReaderArray_ul = new TTreeReaderArray<uint64_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(uint64_t, mNumberElements, mTableBuilder_ul);
+      case arrow::Type::INT8:
+        updateRange<arrow::Int8Type>(column, min, max);
         break;
-      case EDataType::kChar_t:
-        mReaderArray_b = new TTreeReaderArray<int8_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int8_t, mNumberElements, mTableBuilder_b);
+      case arrow::Type::INT16:
+        updateRange<arrow::Int16Type>(column, min, max);
         break;
-      case EDataType::kShort_t:
-        mReaderArray_s = new TTreeReaderArray<int16_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int16_t, mNumberElements, mTableBuilder_s);
+      case arrow::Type::INT32:
+        updateRange<arrow::Int32Type>(column, min, max);
         break;
-      case EDataType::kInt_t:
-        mReaderArray_i = new TTreeReaderArray<int32_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int32_t, mNumberElements, mTableBuilder_i);
+      case arrow::Type::INT64:
+        updateRange<arrow::Int64Type>(column, min, max);
         break;
-      case EDataType::kLong64_t:
-        mReaderArray_l = new TTreeReaderArray<int64_t>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(int64_t, mNumberElements, mTableBuilder_l);
+      case arrow::Type::FLOAT:
+        updateRange<arrow::FloatType>(column, min, max);
         break;
-      case EDataType::kFloat_t:
-        mReaderArray_f = new TTreeReaderArray<float>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(float, mNumberElements, mTableBuilder_f);
-        break;
-      case EDataType::kDouble_t:
-        mReaderArray_d = new TTreeReaderArray<double>(reader, mColumnName);
-        MAKE_FIELD_AND_BUILDER(double, mNumberElements, mTableBuilder_d);
+      case arrow::Type::DOUBLE:
+        updateRange<arrow::DoubleType>(column, min, max);
         break;
       default:
-        LOGP(FATAL, "Type {} not handled!", mElementType);
-        break;
+        continue;
     }
+    mergeParameter(tree->GetUserInfo(), "min:" + name, min, true, isNew);
+    mergeParameter(tree->GetUserInfo(), "max:" + name, max, false, isNew);
   }
 }
 
-ColumnIterator::~ColumnIterator()
-{
-  // delete all pointers
-  delete mReaderValue_o;
-  delete mReaderValue_ub;
-  delete mReaderValue_us;
-  delete mReaderValue_ui;
-  delete mReaderValue_ul;
-  delete mReaderValue_b;
-  delete mReaderValue_s;
-  delete mReaderValue_i;
-  delete mReaderValue_l;
-  delete mReaderValue_f;
-  delete mReaderValue_d;
-
-  delete mReaderArray_o;
-  delete mReaderArray_ub;
-  delete mReaderArray_us;
-  delete mReaderArray_ui;
-  delete mReaderArray_ul;
-  delete mReaderArray_b;
-  delete mReaderArray_s;
-  delete mReaderArray_i;
-  delete mReaderArray_l;
-  delete mReaderArray_f;
-  delete mReaderArray_d;
-
-  if (mTableBuilder_list) {
-    delete mTableBuilder_list;
-  } else {
-    delete mTableBuilder_o;
-    delete mTableBuilder_ub;
-    delete mTableBuilder_us;
-    delete mTableBuilder_ui;
-    delete mTableBuilder_ul;
-    delete mTableBuilder_b;
-    delete mTableBuilder_s;
-    delete mTableBuilder_i;
-    delete mTableBuilder_l;
-    delete mTableBuilder_f;
-    delete mTableBuilder_d;
+// The hash of the schema of the branches of the tree is stored when the
+// tree is created, the tables appended later have the same columns.
+void storeSchemaHash(TTree* tree, arrow::Schema const& schema)
+{
+  auto userInfo = tree->GetUserInfo();
+  if (userInfo->FindObject("schema-hash") != nullptr) {
+    return;
   }
-};
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (auto& field : schema.fields()) {
+    if (tree->GetBranch(field->name().c_str()) != nullptr) {
+      fields.push_back(field);
+    }
+  }
+  userInfo->Add(new TParameter<double>("schema-hash", schemaHash(arrow::Schema{fields})));
+}
 
-bool ColumnIterator::getStatus()
+constexpr std::string_view SourceRowsPrefix = "source-rows:";
+
+bool isSourceRows(std::string const& key)
 {
-  return mStatus;
+  return key.rfind(SourceRowsPrefix, 0) == 0;
 }
 
-void ColumnIterator::reserve(size_t s)
+// The numbers of rows of the sources of an index are stored as parameters
+// of the user info when the tree is created. Appending another table to
+// the tree invalidates them.
+void storeSourceRows(TTree* tree, arrow::Schema const& schema)
 {
-  arrow::Status stat;
+  auto userInfo = tree->GetUserInfo();
+  if (tree->GetEntries() != 0) {
+    std::vector<TObject*> stale;
+    for (auto object : *userInfo) {
+      if (isSourceRows(object->GetName())) {
+        stale.push_back(object);
+      }
+    }
+    for (auto object : stale) {
+      userInfo->Remove(object);
+      delete object;
+    }
+    return;
+  }
+  auto metadata = schema.metadata();
+  if (metadata == nullptr) {
+    return;
+  }
+  for (int64_t i = 0; i < metadata->size(); ++i) {
+    if (isSourceRows(metadata->key(i))) {
+      userInfo->Add(new TParameter<double>(metadata->key(i).c_str(), std::stod(metadata->value(i))));
+    }
+  }
+}
+} // namespace
 
-  switch (mElementType) {
-    case EDataType::kBool_t:
-      stat = mTableBuilder_o->Reserve(s * mNumberElements);
+uint32_t schemaHash(arrow::Schema const& schema)
+{
+  std::string description;
+  for (auto& field : schema.fields()) {
+    description += field->name() + ":" + field->type()->ToString() + ";";
+  }
+  return compile_time_hash(description.c_str());
+}
+
+std::shared_ptr<arrow::Table> withSourceRows(std::shared_ptr<arrow::Table> const& table, std::vector<int64_t> const& rows)
+{
+  auto metadata = table->schema()->metadata() ? table->schema()->metadata()->Copy() : std::make_shared<arrow::KeyValueMetadata>();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    metadata->Append(std::string{SourceRowsPrefix} + std::to_string(i), std::to_string(rows[i]));
+  }
+  return table->ReplaceSchemaMetadata(metadata);
+}
+
+std::vector<int64_t> getSourceRows(arrow::Schema const& schema)
+{
+  std::vector<int64_t> rows;
+  auto metadata = schema.metadata();
+  for (size_t i = 0; metadata != nullptr; ++i) {
+    auto index = metadata->FindKey(std::string{SourceRowsPrefix} + std::to_string(i));
+    if (index < 0) {
       break;
-    case EDataType::kUChar_t:
-      stat = mTableBuilder_ub->Reserve(s * mNumberElements);
+    }
+    rows.push_back(std::stoll(metadata->value(index)));
+  }
+  return rows;
+}
+
+TTree* TableToTree::process()
+{
+  storeColumnRanges(mTreePtr, *mTable);
+  storeSchemaHash(mTreePtr, *mTable->schema());
+  storeSourceRows(mTreePtr, *mTable->schema());
+
+  bool togo = mTreePtr->GetNbranches() > 0;
+  while (togo) {
+    // fill the tree
+    mTreePtr->Fill();
+
+    // update the branches
+    for (auto brit : mBranchIterators) {
+      togo &= brit->push();
+    }
+  }
+  mTreePtr->Write("", TObject::kOverwrite);
+
+  return mTreePtr;
+}
+
+// -----------------------------------------------------------------------------
+namespace
+{
+std::shared_ptr<arrow::Buffer> allocateBuffer(int64_t size)
+{
+  auto result = arrow::AllocateBuffer(size);
+  if (!result.ok()) {
+    throw runtime_error_f("Unable to allocate %lld bytes: %s", (long long)size, result.status().ToString().c_str());
+  }
+  return std::move(result).ValueOrDie();
+}
+
+std::shared_ptr<arrow::ResizableBuffer> allocateResizableBuffer(int64_t size)
+{
+  auto result = arrow::AllocateResizableBuffer(size);
+  if (!result.ok()) {
+    throw runtime_error_f("Unable to allocate %lld bytes: %s", (long long)size, result.status().ToString().c_str());
+  }
+  return std::move(result).ValueOrDie();
+}
+
+// ROOT stores the values as big endian. The loops are kept trivial so
+// that the compiler vectorizes them.
+template <typename T>
+void swapCopy(T* dst, unsigned char const* src, int64_t n)
+{
+  for (int64_t i = 0; i < n; ++i) {
+    T value;
+    std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+    if constexpr (sizeof(T) == 2) {
+      dst[i] = __builtin_bswap16(value);
+    } else if constexpr (sizeof(T) == 4) {
+      dst[i] = __builtin_bswap32(value);
+    } else {
+      dst[i] = __builtin_bswap64(value);
+    }
+  }
+}
+
+void copyFromBigEndian(unsigned char* dst, unsigned char const* src, int64_t n, int size)
+{
+  switch (size) {
+    case 1:
+      std::memcpy(dst, src, n);
       break;
-    case EDataType::kUShort_t:
-      stat = mTableBuilder_us->Reserve(s * mNumberElements);
+    case 2:
+      swapCopy(reinterpret_cast<uint16_t*>(dst), src, n);
       break;
-    case EDataType::kUInt_t:
-      stat = mTableBuilder_ui->Reserve(s * mNumberElements);
+    case 4:
+      swapCopy(reinterpret_cast<uint32_t*>(dst), src, n);
       break;
-    case EDataType::kULong64_t:
-      stat = mTableBuilder_ul->Reserve(s * mNumberElements);
+    case 8:
+      swapCopy(reinterpret_cast<uint64_t*>(dst), src, n);
       break;
+  }
+}
+
+// the sizes of variable size arrays are never negative
+int64_t countFromBigEndian(unsigned char const* src, int size)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < size; ++i) {
+    value = (value << 8) | src[i];
+  }
+  return static_cast<int64_t>(value);
+}
+
+std::shared_ptr<arrow::DataType> arrowTypeFor(EDataType type, int& size)
+{
+  switch (type) {
+    case EDataType::kBool_t:
+      size = 1;
+      return arrow::boolean();
+    case EDataType::kUChar_t:
+      size = 1;
+      return arrow::uint8();
+    case EDataType::kUShort_t:
+      size = 2;
+      return arrow::uint16();
+    case EDataType::kUInt_t:
+      size = 4;
+      return arrow::uint32();
+    case EDataType::kULong64_t:
+      size = 8;
+      return arrow::uint64();
     case EDataType::kChar_t:
-      stat = mTableBuilder_b->Reserve(s * mNumberElements);
-      break;
+      size = 1;
+      return arrow::int8();
     case EDataType::kShort_t:
-      stat = mTableBuilder_s->Reserve(s * mNumberElements);
-      break;
+      size = 2;
+      return arrow::int16();
     case EDataType::kInt_t:
-      stat = mTableBuilder_i->Reserve(s * mNumberElements);
-      break;
+      size = 4;
+      return arrow::int32();
     case EDataType::kLong64_t:
-      stat = mTableBuilder_l->Reserve(s * mNumberElements);
-      break;
+      size = 8;
+      return arrow::int64();
     case EDataType::kFloat_t:
-      stat = mTableBuilder_f->Reserve(s * mNumberElements);
-      break;
+      size = 4;
+      return arrow::float32();
     case EDataType::kDouble_t:
-      stat = mTableBuilder_d->Reserve(s * mNumberElements);
-      break;
+      size = 8;
+      return arrow::float64();
     default:
-      LOGP(FATAL, "Type {} not handled!", mElementType);
-      break;
+      return nullptr;
   }
 }
+} // namespace
 
-void ColumnIterator::push()
+// is used in TreeToTable
+BranchToColumn::BranchToColumn(TTree* tree, const char* colname)
 {
-  arrow::Status stat;
+  mBranch = tree->GetBranch(colname);
+  if (!mBranch) {
+    LOGP(WARNING, "Can not locate branch {}", colname);
+    return;
+  }
+  mColumnName = colname;
 
-  // switch according to mElementType
-  if (mNumberElements == 1) {
-    switch (mElementType) {
-      case EDataType::kBool_t:
-        mTableBuilder_o->UnsafeAppend((bool)**mReaderValue_o);
-        break;
-      case EDataType::kUChar_t:
-        mTableBuilder_ub->UnsafeAppend(**mReaderValue_ub);
-        break;
-      case EDataType::kUShort_t:
-        mTableBuilder_us->UnsafeAppend(**mReaderValue_us);
-        break;
-      case EDataType::kUInt_t:
-        mTableBuilder_ui->UnsafeAppend(**mReaderValue_ui);
-        break;
-      case EDataType::kULong64_t:
-        mTableBuilder_ul->UnsafeAppend(**mReaderValue_ul);
-        break;
-      case EDataType::kChar_t:
-        mTableBuilder_b->UnsafeAppend(**mReaderValue_b);
-        break;
-      case EDataType::kShort_t:
-        mTableBuilder_s->UnsafeAppend(**mReaderValue_s);
-        break;
-      case EDataType::kInt_t:
-        mTableBuilder_i->UnsafeAppend(**mReaderValue_i);
-        break;
-      case EDataType::kLong64_t:
-        mTableBuilder_l->UnsafeAppend(**mReaderValue_l);
-        break;
-      case EDataType::kFloat_t:
-        mTableBuilder_f->UnsafeAppend(**mReaderValue_f);
-        break;
-      case EDataType::kDouble_t:
-        mTableBuilder_d->UnsafeAppend(**mReaderValue_d);
-        break;
-      default:
-        LOGP(FATAL, "Type {} not handled!", mElementType);
-        break;
-    }
+  // type of the branch elements
+  TClass* cl;
+  mBranch->GetExpectedType(cl, mElementType);
+  mElementArrowType = arrowTypeFor(mElementType, mElementSize);
+  if (!mElementArrowType) {
+    LOGP(FATAL, "Type {} not handled!", mElementType);
+    return;
+  }
+
+  // currently only single-value or single-array branches are accepted
+  // thus of the form e.g. alpha/D, alpha[5]/D or alpha[n]/D
+  auto leaf = static_cast<TLeaf*>(mBranch->GetListOfLeaves()->At(0));
+  if (leaf->GetLeafCount() != nullptr) {
+    mCountLeaf = leaf->GetLeafCount();
+    mCountBranch = mCountLeaf->GetBranch();
+    mCountSize = mCountLeaf->GetLenType();
+    mField = std::make_shared<arrow::Field>(mColumnName, arrow::list(mElementArrowType));
   } else {
-    stat = mTableBuilder_list->AppendValues(1);
-    switch (mElementType) {
-      case EDataType::kBool_t:
-        stat &= mTableBuilder_o->AppendValues((uint8_t*)&((*mReaderArray_o)[0]), mNumberElements);
-        break;
-      case EDataType::kUChar_t:
-        stat &= mTableBuilder_ub->AppendValues(&((*mReaderArray_ub)[0]), mNumberElements);
-        break;
-      case EDataType::kUShort_t:
-        stat &= mTableBuilder_us->AppendValues(&((*mReaderArray_us)[0]), mNumberElements);
-        break;
-      case EDataType::kUInt_t:
-        stat &= mTableBuilder_ui->AppendValues(&((*mReaderArray_ui)[0]), mNumberElements);
-        break;
-      case EDataType::kULong64_t:
-        stat &= mTableBuilder_ul->AppendValues(&((*mReaderArray_ul)[0]), mNumberElements);
-        break;
-      case EDataType::kChar_t:
-        stat &= mTableBuilder_b->AppendValues(&((*mReaderArray_b)[0]), mNumberElements);
-        break;
-      case EDataType::kShort_t:
-        stat &= mTableBuilder_s->AppendValues(&((*mReaderArray_s)[0]), mNumberElements);
-        break;
-      case EDataType::kInt_t:
-        stat &= mTableBuilder_i->AppendValues(&((*mReaderArray_i)[0]), mNumberElements);
-        break;
-      case EDataType::kLong64_t:
-        stat &= mTableBuilder_l->AppendValues(&((*mReaderArray_l)[0]), mNumberElements);
-        break;
-      case EDataType::kFloat_t:
-        stat &= mTableBuilder_f->AppendValues(&((*mReaderArray_f)[0]), mNumberElements);
-        break;
-      case EDataType::kDouble_t:
-        stat &= mTableBuilder_d->AppendValues(&((*mReaderArray_d)[0]), mNumberElements);
-        break;
-      default:
-        LOGP(FATAL, "Type {} not handled!", mElementType);
-        break;
+    mNumberElements = leaf->GetLenStatic();
+    if (mNumberElements == 1) {
+      mField = std::make_shared<arrow::Field>(mColumnName, mElementArrowType);
+    } else {
+      mField = std::make_shared<arrow::Field>(mColumnName, arrow::fixed_size_list(mElementArrowType, mNumberElements));
     }
   }
+  mStatus = true;
 }
 
-void ColumnIterator::finish()
+bool BranchToColumn::getStatus()
 {
-  arrow::Status stat;
+  return mStatus;
+}
 
-  // switch according to mElementType
-  if (mNumberElements == 1) {
-    switch (mElementType) {
-      case EDataType::kBool_t:
-        stat = mTableBuilder_o->Finish(&mArray);
-        break;
-      case EDataType::kUChar_t:
-        stat = mTableBuilder_ub->Finish(&mArray);
-        break;
-      case EDataType::kUShort_t:
-        stat = mTableBuilder_us->Finish(&mArray);
-        break;
-      case EDataType::kUInt_t:
-        stat = mTableBuilder_ui->Finish(&mArray);
-        break;
-      case EDataType::kULong64_t:
-        stat = mTableBuilder_ul->Finish(&mArray);
-        break;
-      case EDataType::kChar_t:
-        stat = mTableBuilder_b->Finish(&mArray);
-        break;
-      case EDataType::kShort_t:
-        stat = mTableBuilder_s->Finish(&mArray);
-        break;
-      case EDataType::kInt_t:
-        stat = mTableBuilder_i->Finish(&mArray);
-        break;
-      case EDataType::kLong64_t:
-        stat = mTableBuilder_l->Finish(&mArray);
-        break;
-      case EDataType::kFloat_t:
-        stat = mTableBuilder_f->Finish(&mArray);
-        break;
-      case EDataType::kDouble_t:
-        stat = mTableBuilder_d->Finish(&mArray);
-        break;
-      default:
-        LOGP(FATAL, "Type {} not handled!", mElementType);
-        break;
+void BranchToColumn::prepare(int64_t numEntries)
+{
+  mNumEntries = numEntries;
+  mNumValues = 0;
+  if (mCountBranch == nullptr) {
+    mValues = allocateResizableBuffer(numEntries * mNumberElements * mElementSize);
+    return;
+  }
+  mOffsets = allocateResizableBuffer((numEntries + 1) * sizeof(int32_t));
+  reinterpret_cast<int32_t*>(mOffsets->mutable_data())[0] = 0;
+  // the total number of values is known only once all the sizes are read
+  mValues = allocateResizableBuffer(std::max<int64_t>(mBranch->GetTotBytes(), 1024));
+}
+
+int64_t BranchToColumn::bulkRead(TBranch* branch, int64_t first, int64_t last, TBufferFile& buffer, std::function<void(unsigned char const*, int64_t, int64_t)> const& copy)
+{
+  int64_t entry = first;
+  if (!branch->SupportsBulkRead()) {
+    return entry;
+  }
+  while (entry < last) {
+    // the whole basket holding the entry is returned
+    auto readEntries = branch->GetBulkRead().GetEntriesSerialized(entry, buffer);
+    if (readEntries <= 0) {
+      LOGP(WARNING, "Bulk read of branch {} failed at entry {}, reading entry by entry", branch->GetName(), entry);
+      break;
+    }
+    int64_t basketFirst = branch->GetBasketEntry()[branch->GetReadBasket()];
+    auto basketLast = std::min<int64_t>(basketFirst + readEntries, last);
+    copy(reinterpret_cast<unsigned char const*>(buffer.GetCurrent()), basketFirst, basketLast);
+    entry = basketLast;
+  }
+  return entry;
+}
+
+void BranchToColumn::readFixedSize(int64_t first, int64_t last, TBufferFile& buffer)
+{
+  auto entrySize = mElementSize * mNumberElements;
+  auto dst = mValues->mutable_data();
+
+  auto entry = bulkRead(mBranch, first, last, buffer, [&](unsigned char const* basket, int64_t basketFirst, int64_t basketLast) {
+    auto begin = std::max(first, basketFirst);
+    copyFromBigEndian(dst + begin * entrySize, basket + (begin - basketFirst) * entrySize, (basketLast - begin) * mNumberElements, mElementSize);
+  });
+  // let ROOT deserialize the remaining entries straight into the buffer
+  if (entry < last) {
+    for (; entry < last; ++entry) {
+      mBranch->SetAddress(dst + entry * entrySize);
+      mBranch->GetEntry(entry);
+    }
+    mBranch->ResetAddress();
+  }
+  mNumValues = last * mNumberElements;
+}
+
+void BranchToColumn::readVariableSize(int64_t first, int64_t last, TBufferFile& buffer)
+{
+  // the offsets are built in one pass over the sizes
+  auto offsets = reinterpret_cast<int32_t*>(mOffsets->mutable_data());
+  auto entry = bulkRead(mCountBranch, first, last, buffer, [&](unsigned char const* basket, int64_t basketFirst, int64_t basketLast) {
+    for (auto i = std::max(first, basketFirst); i < basketLast; ++i) {
+      offsets[i + 1] = offsets[i] + countFromBigEndian(basket + (i - basketFirst) * mCountSize, mCountSize);
     }
+  });
+  for (; entry < last; ++entry) {
+    mCountBranch->GetEntry(entry);
+    offsets[entry + 1] = offsets[entry] + static_cast<int32_t>(mCountLeaf->GetValue());
+  }
+
+  int64_t numValues = offsets[last];
+  if (numValues * mElementSize > mValues->capacity()) {
+    auto status = mValues->Reserve(std::max<int64_t>(numValues * mElementSize, 2 * mValues->capacity()));
+    if (!status.ok()) {
+      throw runtime_error_f("Unable to allocate the values of column %s: %s", mColumnName, status.ToString().c_str());
+    }
+  }
+  auto dst = mValues->mutable_data();
+  entry = bulkRead(mBranch, first, last, buffer, [&](unsigned char const* basket, int64_t basketFirst, int64_t basketLast) {
+    // the values of the entries of the basket are contiguous
+    auto begin = std::max(first, basketFirst);
+    copyFromBigEndian(dst + offsets[begin] * mElementSize, basket + (offsets[begin] - offsets[basketFirst]) * mElementSize, offsets[basketLast] - offsets[begin], mElementSize);
+  });
+  if (entry < last) {
+    for (; entry < last; ++entry) {
+      if (offsets[entry + 1] == offsets[entry]) {
+        continue;
+      }
+      // ROOT needs the size of the current entry to deserialize the array
+      mCountBranch->GetEntry(entry);
+      mBranch->SetAddress(dst + offsets[entry] * mElementSize);
+      mBranch->GetEntry(entry);
+    }
+    mBranch->ResetAddress();
+  }
+  mNumValues = numValues;
+}
+
+void BranchToColumn::read(int64_t first, int64_t last, TBufferFile& buffer)
+{
+  if (mCountBranch != nullptr) {
+    readVariableSize(first, last, buffer);
   } else {
-    stat = mTableBuilder_list->Finish(&mArray);
+    readFixedSize(first, last, buffer);
   }
 }
 
+std::shared_ptr<arrow::Array> BranchToColumn::makeValues(std::shared_ptr<arrow::Buffer> values, int64_t numValues)
+{
+  if (mElementType == EDataType::kBool_t) {
+    // one byte per value in ROOT, one bit in arrow
+    auto bits = allocateBuffer((numValues + 7) / 8);
+    auto bitsPtr = bits->mutable_data();
+    auto bytesPtr = values->data();
+    std::memset(bitsPtr, 0, bits->size());
+    for (int64_t i = 0; i < numValues; ++i) {
+      bitsPtr[i >> 3] |= (bytesPtr[i] != 0) << (i & 7);
+    }
+    values = bits;
+  }
+  return arrow::MakeArray(arrow::ArrayData::Make(mElementArrowType, numValues, {nullptr, values}));
+}
+
+std::shared_ptr<arrow::Array> BranchToColumn::finish()
+{
+  auto status = mValues->Resize(mNumValues * mElementSize);
+  if (!status.ok()) {
+    throw runtime_error_f("Unable to resize the values of column %s: %s", mColumnName, status.ToString().c_str());
+  }
+  auto values = makeValues(mValues, mNumValues);
+  if (mCountBranch != nullptr) {
+    return std::make_shared<arrow::ListArray>(mField->type(), mNumEntries, mOffsets, values);
+  }
+  if (mNumberElements == 1) {
+    return values;
+  }
+  return std::make_shared<arrow::FixedSizeListArray>(mField->type(), mNumEntries, values);
+}
+
 void TreeToTable::setLabel(const char* label)
 {
   mTableLabel = label;
@@ -867,44 +929,53 @@ bool TreeToTable::addAllColumns(TTree* tree)
 
 void TreeToTable::fill(TTree* tree)
 {
-  std::vector<std::unique_ptr<ColumnIterator>> columnIterators;
-  TTreeReader treeReader{tree};
+  std::vector<std::unique_ptr<BranchToColumn>> columns;
 
   tree->SetCacheSize(50000000);
   tree->SetClusterPrefetch(true);
   for (auto&& columnName : mColumnNames) {
     tree->AddBranchToCache(columnName.c_str(), true);
-    auto colit = std::make_unique<ColumnIterator>(treeReader, columnName.c_str());
-    auto stat = colit->getStatus();
-    if (!stat) {
+    auto column = std::make_unique<BranchToColumn>(tree, columnName.c_str());
+    if (!column->getStatus()) {
       throw std::runtime_error("Unable to convert column " + columnName);
     }
-    columnIterators.push_back(std::move(colit));
+    if (column->getCountBranch() != nullptr) {
+      tree->AddBranchToCache(column->getCountBranch(), true);
+    }
+    columns.push_back(std::move(column));
   }
   tree->StopCacheLearningPhase();
-  auto numEntries = treeReader.GetEntries(true);
-  if (numEntries > 0) {
-    for (auto&& column : columnIterators) {
-      column->reserve(numEntries);
-    }
-    // copy all values from the tree to the table builders
-    treeReader.Restart();
-    while (treeReader.Next()) {
-      for (auto&& column : columnIterators) {
-        column->push();
-      }
+  auto numEntries = tree->GetEntries();
+  for (auto&& column : columns) {
+    column->prepare(numEntries);
+  }
+
+  // all the columns are read for one cluster before moving to the next
+  // one, so that each cluster is loaded only once into the cache
+  TBufferFile buffer{TBuffer::EMode::kWrite, 4 * 1024 * 1024};
+  auto clusters = tree->GetClusterIterator(0);
+  for (Long64_t first = clusters(); first < numEntries; first = clusters()) {
+    auto last = std::min<Long64_t>(clusters.GetNextEntry(), numEntries);
+    for (auto&& column : columns) {
+      column->read(first, last, buffer);
     }
   }
 
-  // prepare the elements needed to create the final table
   std::vector<std::shared_ptr<arrow::Array>> array_vector;
   std::vector<std::shared_ptr<arrow::Field>> schema_vector;
-  for (auto&& colit : columnIterators) {
-    colit->finish();
-    array_vector.push_back(colit->getArray());
-    schema_vector.push_back(colit->getSchema());
+  for (auto&& column : columns) {
+    array_vector.push_back(column->finish());
+    schema_vector.push_back(column->getSchema());
+  }
+  // the numbers of rows of the sources of a stored index are restored
+  auto metadata = std::make_shared<arrow::KeyValueMetadata>(std::vector{std::string{"label"}}, std::vector{mTableLabel});
+  for (auto object : *tree->GetUserInfo()) {
+    auto parameter = dynamic_cast<TParameter<double>*>(object);
+    if (parameter != nullptr && isSourceRows(parameter->GetName())) {
+      metadata->Append(parameter->GetName(), std::to_string(static_cast<int64_t>(parameter->GetVal())));
+    }
   }
-  auto fields = std::make_shared<arrow::Schema>(schema_vector, std::make_shared<arrow::KeyValueMetadata>(std::vector{std::string{"label"}}, std::vector{mTableLabel}));
+  auto fields = std::make_shared<arrow::Schema>(schema_vector, metadata);
 
   // create the final table
   // ta is of type std::shared_ptr<arrow::Table>
@@ -41,6 +41,9 @@ std::vector<ConfigParamSpec> WorkflowCustomizationHelpers::requiredWorkflowOptio
                                        // options for AOD rate limiting
                                        ConfigParamSpec{"aod-memory-rate-limit", VariantType::Int64, 0LL, {"Rate limit AOD processing based on memory"}},
 
+                                       // options for AOD index builder
+                                       ConfigParamSpec{"aod-stored-indices", VariantType::Bool, false, {"Reuse the index tables saved in the input files"}},
+
                                        // options for AOD writer
                                        ConfigParamSpec{"aod-writer-json", VariantType::String, "", {"Name of the json configuration file"}},
                                        ConfigParamSpec{"aod-writer-resfile", VariantType::String, "", {"Default name of the output file"}},
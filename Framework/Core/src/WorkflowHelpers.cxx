@@ -29,6 +29,7 @@
 #include "Headers/DataHeader.h"
 #include <algorithm>
 #include <list>
+#include <regex>
 #include <set>
 #include <utility>
 #include <vector>
@@ -160,13 +161,79 @@ void addMissingOutputsToReader(std::vector<OutputSpec> const& providedOutputs,
   }
 }
 
+// The columns of each table provided by the reader which are used by the
+// workflow are passed as metadata of the reader input. A table is read as
+// a whole if any of its consumers does not specify the columns it needs.
+void addColumnsToReader(std::vector<InputSpec> const& requestedInputs,
+                        DataProcessorSpec& publisher)
+{
+  std::regex word_regex("(\\w+)");
+  for (auto& output : publisher.outputs) {
+    std::set<std::string> columns;
+    bool wholeTable = false;
+    for (InputSpec const& requested : requestedInputs) {
+      if (!DataSpecUtils::match(requested, output)) {
+        continue;
+      }
+      auto metadata = std::find_if(requested.metadata.begin(), requested.metadata.end(), [](ConfigParamSpec const& spec) { return spec.name == "aod-columns"; });
+      if (metadata == requested.metadata.end()) {
+        wholeTable = true;
+        break;
+      }
+      auto labels = metadata->defaultValue.get<std::string>();
+      for (auto word = std::sregex_iterator(labels.begin(), labels.end(), word_regex); word != std::sregex_iterator(); ++word) {
+        columns.insert(word->str());
+      }
+    }
+    if (wholeTable || columns.empty()) {
+      continue;
+    }
+    std::string joined;
+    for (auto& column : columns) {
+      joined += (joined.empty() ? "" : ",") + column;
+    }
+    auto concrete = DataSpecUtils::asConcreteDataMatcher(output);
+    auto table = concrete.origin.as<std::string>() + "/" + concrete.description.as<std::string>();
+    publisher.inputs[0].metadata.push_back(ConfigParamSpec{"columns:" + table, VariantType::String, joined, {"columns to read"}});
+  }
+}
+
+// The range predicates of the filters applied to the tables provided by the
+// reader, which allow it to skip the time frames in which no row can pass.
+// A table has a predicate only if all its consumers filter it.
+void addFiltersToReader(std::vector<InputSpec> const& requestedInputs,
+                        DataProcessorSpec& publisher)
+{
+  for (auto& output : publisher.outputs) {
+    std::string predicate;
+    for (InputSpec const& requested : requestedInputs) {
+      if (!DataSpecUtils::match(requested, output)) {
+        continue;
+      }
+      auto metadata = std::find_if(requested.metadata.begin(), requested.metadata.end(), [](ConfigParamSpec const& spec) { return spec.name == "aod-filter"; });
+      if (metadata == requested.metadata.end()) {
+        predicate.clear();
+        break;
+      }
+      auto filter = metadata->defaultValue.get<std::string>();
+      predicate = predicate.empty() ? filter : "or " + predicate + " " + filter;
+    }
+    if (predicate.empty()) {
+      continue;
+    }
+    auto concrete = DataSpecUtils::asConcreteDataMatcher(output);
+    auto table = concrete.origin.as<std::string>() + "/" + concrete.description.as<std::string>();
+    publisher.inputs[0].metadata.push_back(ConfigParamSpec{"filter:" + table, VariantType::String, predicate, {"range predicate of the filters"}});
+  }
+}
+
 void addMissingOutputsToSpawner(std::vector<InputSpec>&& requestedDYNs,
                                 std::vector<InputSpec>& requestedAODs,
                                 DataProcessorSpec& publisher)
 {
   for (auto& input : requestedDYNs) {
     publisher.inputs.emplace_back(InputSpec{input.binding, header::DataOrigin{"AOD"}, DataSpecUtils::asConcreteDataMatcher(input).description});
-    requestedAODs.emplace_back(InputSpec{input.binding, header::DataOrigin{"AOD"}, DataSpecUtils::asConcreteDataMatcher(input).description});
+    requestedAODs.emplace_back(InputSpec{input.binding, header::DataOrigin{"AOD"}, DataSpecUtils::asConcreteDataMatcher(input).description, Lifetime::Timeframe, input.metadata});
     auto concrete = DataSpecUtils::asConcreteDataMatcher(input);
     publisher.outputs.emplace_back(OutputSpec{concrete.origin, concrete.description, concrete.subSpec});
   }
@@ -207,6 +274,25 @@ void addMissingOutputsToBuilder(std::vector<InputSpec>&& requestedIDXs,
   }
 }
 
+// The index tables saved in the input files are requested from the reader,
+// together with the hash of the schema they must have to be reused by the
+// builder. The reader provides an empty table when there is no such index.
+void addStoredIndicesToBuilder(std::vector<InputSpec> const& requestedIDXs,
+                               std::vector<InputSpec>& requestedAODs,
+                               DataProcessorSpec& builder,
+                               DataProcessorSpec& publisher)
+{
+  for (auto& input : requestedIDXs) {
+    auto concrete = DataSpecUtils::asConcreteDataMatcher(input);
+    InputSpec stored{"stored-" + input.binding, header::DataOrigin{"AOD"}, concrete.description};
+    builder.inputs.push_back(stored);
+    requestedAODs.push_back(stored);
+    auto table = "AOD/" + concrete.description.as<std::string>();
+    auto hash = static_cast<int64_t>(readers::AODReaderHelpers::indexSchemaHash(concrete.description));
+    publisher.inputs[0].metadata.push_back(ConfigParamSpec{"index:" + table, VariantType::Int64, hash, {"schema hash of the stored index"}});
+  }
+}
+
 void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow, ConfigContext const& ctx)
 {
   auto fakeCallback = AlgorithmSpec{[](InitContext& ic) {
@@ -263,6 +349,9 @@ void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow, ConfigContext
     {ConfigParamSpec{"aod-file", VariantType::String, {"Input AOD file"}},
      ConfigParamSpec{"aod-reader-json", VariantType::String, {"json configuration file"}},
      ConfigParamSpec{"time-limit", VariantType::Int64, 0ll, {"Maximum run time limit in seconds"}},
+     ConfigParamSpec{"aod-prefetch-folders", VariantType::Int, 0, {"Number of time frames of the next file to preload, 0 to disable"}},
+     ConfigParamSpec{"aod-prefetch-memory", VariantType::Int64, 500ll, {"Memory in MB for the preloaded time frames"}},
+     ConfigParamSpec{"aod-skip-filtered-dfs", VariantType::Bool, false, {"Skip the time frames in which no row of a filtered table can pass the filters"}},
      ConfigParamSpec{"orbit-offset-enumeration", VariantType::Int64, 0ll, {"initial value for the orbit"}},
      ConfigParamSpec{"orbit-multiplier-enumeration", VariantType::Int64, 0ll, {"multiplier to get the orbit from the counter"}},
      ConfigParamSpec{"start-value-enumeration", VariantType::Int64, 0ll, {"initial value for the enumeration"}},
@@ -392,12 +481,17 @@ void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow, ConfigContext
     {},
     {},
     readers::AODReaderHelpers::indexBuilderCallback(requestedIDXs),
-    {}};
+    {ConfigParamSpec{"index-builder-threads", VariantType::Int, 1, {"Number of threads reading and matching the tables of an index"}}}};
 
   addMissingOutputsToSpawner(std::move(requestedDYNs), requestedAODs, aodSpawner);
+  if (ctx.options().get<bool>("aod-stored-indices")) {
+    addStoredIndicesToBuilder(requestedIDXs, requestedAODs, indexBuilder, aodReader);
+  }
   addMissingOutputsToBuilder(std::move(requestedIDXs), requestedAODs, indexBuilder);
 
   addMissingOutputsToReader(providedAODs, requestedAODs, aodReader);
+  addColumnsToReader(requestedAODs, aodReader);
+  addFiltersToReader(requestedAODs, aodReader);
   addMissingOutputsToReader(providedCCDBs, requestedCCDBs, ccdbBackend);
 
   std::vector<DataProcessorSpec> extraSpecs;
@@ -495,6 +589,20 @@ void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow, ConfigContext
     outputsInputsAOD.emplace_back(InputSpec{"tfn", "TFN", "TFNumber"});
     auto fileSink = CommonDataProcessors::getGlobalAODSink(dod, outputsInputsAOD);
     extraSpecs.push_back(fileSink);
+
+    // tables copied from the input file to the output one are read as a whole
+    auto reader = std::find_if(workflow.begin(), workflow.end(), [](DataProcessorSpec const& spec) { return spec.name == "internal-dpl-aod-reader"; });
+    if (reader != workflow.end()) {
+      auto& metadata = reader->inputs[0].metadata;
+      for (auto& output : reader->outputs) {
+        if (std::none_of(outputsInputsAOD.begin(), outputsInputsAOD.end(), [&output](InputSpec const& input) { return DataSpecUtils::match(input, output); })) {
+          continue;
+        }
+        auto concrete = DataSpecUtils::asConcreteDataMatcher(output);
+        auto table = "columns:" + concrete.origin.as<std::string>() + "/" + concrete.description.as<std::string>();
+        metadata.erase(std::remove_if(metadata.begin(), metadata.end(), [&table](ConfigParamSpec const& spec) { return spec.name == table; }), metadata.end());
+      }
+    }
   }
 
   workflow.insert(workflow.end(), extraSpecs.begin(), extraSpecs.end());
@@ -973,6 +1081,10 @@ std::tuple<std::vector<InputSpec>, std::vector<unsigned char>> WorkflowHelpers::
     if (DataSpecUtils::partialMatch(outputSpec, header::DataOrigin("RN2"))) {
       outputType |= ANALYSIS;
     }
+    // is IDX? Built index tables can be saved to be reused
+    if (DataSpecUtils::partialMatch(outputSpec, header::DataOrigin("IDX"))) {
+      outputType |= ANALYSIS;
+    }
 
     // is dangling output?
     bool matched = false;
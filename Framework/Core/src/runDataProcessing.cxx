@@ -1101,6 +1101,8 @@ int doChild(int argc, char** argv, ServiceRegistry& serviceRegistry,
       ("driver-client-backend", bpo::value<std::string>()->default_value(defaultDriverClient), "backend for device -> driver communicataon: stdout://: use stdout, ws://: use websockets") //
       ("infologger-severity", bpo::value<std::string>()->default_value(""), "minimum FairLogger severity to send to InfoLogger")                                                           //
       ("configuration,cfg", bpo::value<std::string>()->default_value("command-line"), "configuration backend")                                                                             //
+      ("worker-threads", bpo::value<std::string>()->default_value("1"), "number of threads processing timeslices, if the device is labelled as independent-timeslices")                    //
+      ("message-pool-size", bpo::value<std::string>()->default_value("0"), "size in MB of the per-channel region used for small messages, 0 to disable")                                   //
       ("infologger-mode", bpo::value<std::string>()->default_value(""), "O2_INFOLOGGER_MODE override");
     r.fConfig.AddToCmdLineOptions(optsDesc, true);
   });
@@ -1143,9 +1145,16 @@ int doChild(int argc, char** argv, ServiceRegistry& serviceRegistry,
     r.fDevice = std::move(device);
     fair::Logger::SetConsoleColor(false);
 
-    /// Create all the requested services and initialise them
-    for (auto& service : spec.services) {
+    /// Create all the requested services and initialise them. The stream
+    /// services get one instance per worker thread only if the device
+    /// has any, otherwise they are serial ones.
+    bool workerStreams = r.fConfig.Count("worker-threads") && std::stoi(r.fConfig.GetPropertyAsString("worker-threads")) > 1 &&
+                         DataProcessingDevice::allowsWorkers(spec);
+    for (auto service : spec.services) {
       LOG(debug) << "Declaring service " << service.name;
+      if (service.kind == ServiceKind::Stream && workerStreams == false) {
+        service.kind = ServiceKind::Serial;
+      }
       serviceRegistry.declareService(service, *deviceState.get(), r.fConfig);
     }
     if (ResourcesMonitoringHelper::isResourcesMonitoringEnabled(spec.resourceMonitoringInterval)) {
@@ -1590,6 +1599,8 @@ int runStateMachine(DataProcessorSpecs const& workflow,
           const auto uniformOptions = {
             "--aod-file",
             "--aod-memory-rate-limit",
+            "--aod-prefetch-folders",
+            "--aod-prefetch-memory",
             "--aod-writer-json",
             "--aod-writer-ntfmerge",
             "--aod-writer-resfile",
@@ -650,6 +650,22 @@ BOOST_AUTO_TEST_CASE(TestEmptyTables)
   BOOST_CHECK_EQUAL(spawned.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(TestMissingColumns)
+{
+  // tables read from file only have the requested columns
+  TableBuilder builder;
+  auto rowWriter = builder.persist<int32_t>({"x"});
+  rowWriter(0, 1);
+  rowWriter(0, 2);
+  auto table = builder.finalize();
+
+  Points p{table};
+  BOOST_REQUIRE_EQUAL(p.size(), 2);
+  auto it = p.begin();
+  BOOST_CHECK_EQUAL(it.x(), 1);
+  BOOST_CHECK_THROW(it.y(), o2::framework::RuntimeErrorRef);
+}
+
 DECLARE_SOA_TABLE(Origins, "TST", "ORIG", o2::soa::Index<>, test::X, test::SomeBool);
 namespace test
 {
@@ -761,3 +777,53 @@ BOOST_AUTO_TEST_CASE(TestAdvancedIndices)
     BOOST_CHECK_EQUAL(g2f[i].globalIndex(), aa[i]);
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestSelectionOperations)
+{
+  auto check = [](SelectionVector const& a, SelectionVector const& b) {
+    SelectionVector expectedUnion;
+    SelectionVector expectedIntersection;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expectedUnion));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expectedIntersection));
+    BOOST_CHECK(selectionUnion(a, b) == expectedUnion);
+    BOOST_CHECK(selectionIntersection(a, b) == expectedIntersection);
+  };
+  auto rows = [](int64_t first, int64_t last, int64_t step) {
+    SelectionVector selection;
+    for (auto row = first; row < last; row += step) {
+      selection.push_back(row);
+    }
+    return selection;
+  };
+  // contiguous ranges, overlapping, adjacent and apart
+  check(rows(0, 100, 1), rows(50, 150, 1));
+  check(rows(0, 100, 1), rows(100, 150, 1));
+  check(rows(0, 100, 1), rows(200, 250, 1));
+  // a range and a sparse selection
+  check(rows(30, 70, 1), rows(0, 10000, 97));
+  // dense selections, combined as bitmaps
+  check(rows(0, 1000, 2), rows(1, 1000, 3));
+  check(rows(5, 1000, 2), rows(64, 700, 5));
+  // sparse selections
+  check(rows(0, 100000, 1000), rows(0, 100000, 1500));
+  check({}, rows(0, 10, 1));
+  check(rows(0, 10, 2), {});
+
+  // the iterators of a copy of a filtered table use its own selection
+  TableBuilder builder;
+  auto rowWriter = builder.persist<int32_t, int32_t>({"x", "y"});
+  for (int i = 0; i < 8; ++i) {
+    rowWriter(0, i, i + 8);
+  }
+  auto table = builder.finalize();
+  using TestA = o2::soa::Table<o2::soa::Index<>, test::X, test::Y>;
+  using FilteredTest = Filtered<TestA>;
+  std::unique_ptr<FilteredTest> original = std::make_unique<FilteredTest>(std::vector<std::shared_ptr<arrow::Table>>{table}, SelectionVector{1, 4, 6});
+  FilteredTest copy{*original};
+  original.reset();
+  std::vector<int32_t> xs;
+  for (auto& row : copy) {
+    xs.push_back(row.x());
+  }
+  BOOST_CHECK((xs == std::vector<int32_t>{1, 4, 6}));
+}
@@ -442,6 +442,22 @@ BOOST_AUTO_TEST_CASE(Combinations)
   }
   BOOST_CHECK_EQUAL(count, 6);
 
+  // the filtered tables are temporaries, the iterators must keep their selections alive
+  count = 0;
+  i = 4;
+  j = 5;
+  for (auto& [t0, t1] : combinations(pairsFilter, testsA, testsA)) {
+    BOOST_CHECK_EQUAL(t0.x(), i);
+    BOOST_CHECK_EQUAL(t1.x(), j);
+    count++;
+    j++;
+    if (j == nA) {
+      i++;
+      j = i + 1;
+    }
+  }
+  BOOST_CHECK_EQUAL(count, 6);
+
   count = 0;
   i = 0;
   j = 1;
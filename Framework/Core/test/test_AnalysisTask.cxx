@@ -145,6 +145,16 @@ struct JTask {
   }
 };
 
+struct KTask {
+  static constexpr bool reentrant = true;
+  Produces<aod::FooBars> foobars;
+  HistogramRegistry registry{"registry", {{"x", "x", {HistType::kTH1F, {{10, 0., 1.}}}}}};
+  void process(o2::aod::Collision const&, o2::aod::Tracks const& tracks)
+  {
+    registry.fill(HIST("x"), tracks.size());
+  }
+};
+
 BOOST_AUTO_TEST_CASE(AdaptorCompilation)
 {
   auto cfgc = makeEmptyConfigContext();
@@ -155,6 +165,16 @@ BOOST_AUTO_TEST_CASE(AdaptorCompilation)
   BOOST_CHECK_EQUAL(task1.inputs[1].binding, std::string("TracksExtension"));
   BOOST_CHECK_EQUAL(task1.inputs[0].binding, std::string("Tracks"));
   BOOST_CHECK_EQUAL(task1.outputs[0].binding.value, std::string("FooBars"));
+  // the columns to be read from file are attached to the inputs, the
+  // extension only needs the columns used by its expressions
+  BOOST_REQUIRE_EQUAL(task1.inputs[0].metadata.size(), 1);
+  BOOST_CHECK_EQUAL(task1.inputs[0].metadata[0].name, "aod-columns");
+  auto trackColumns = task1.inputs[0].metadata[0].defaultValue.get<std::string>();
+  BOOST_CHECK(trackColumns.find("fIndexCollisions,") != std::string::npos);
+  BOOST_CHECK(trackColumns.find("fX,") != std::string::npos);
+  BOOST_CHECK(trackColumns.find("fPt") == std::string::npos);
+  BOOST_REQUIRE_EQUAL(task1.inputs[1].metadata.size(), 1);
+  BOOST_CHECK_EQUAL(task1.inputs[1].metadata[0].defaultValue.get<std::string>(), "fAlpha,fSigned1Pt,fSnp,fTgl");
 
   auto task2 = adaptAnalysisTask<BTask>(*cfgc, TaskName{"test2"});
   BOOST_CHECK_EQUAL(task2.inputs.size(), 9);
@@ -197,6 +217,12 @@ BOOST_AUTO_TEST_CASE(AdaptorCompilation)
   BOOST_CHECK_EQUAL(task9.inputs.size(), 4);
 
   auto task10 = adaptAnalysisTask<JTask>(*cfgc, TaskName{"test10"});
+  BOOST_CHECK(std::none_of(task10.options.begin(), task10.options.end(), [](ConfigParamSpec const& option) { return option.name == "process-threads"; }));
+
+  auto task11 = adaptAnalysisTask<KTask>(*cfgc, TaskName{"test11"});
+  BOOST_CHECK(is_reentrant_task_v<KTask>);
+  BOOST_CHECK(!is_reentrant_task_v<JTask>);
+  BOOST_CHECK(std::any_of(task11.options.begin(), task11.options.end(), [](ConfigParamSpec const& option) { return option.name == "process-threads"; }));
 }
 
 BOOST_AUTO_TEST_CASE(TestPartitionIteration)
@@ -145,6 +145,13 @@ DataProcessorSpec getSourceSpec()
     pmrvec.emplace_back(o2::test::TriviallyCopyable{1, 2, 3});
     pc.outputs().adoptContainer(pmrOutputSpec, std::move(pmrvec));
 
+    // move-snapshot of a PMR vector, the buffer is sent without copy
+    Output pmrSnapshotSpec{"TST", "PMRSNAPSHOT", 0};
+    auto pmrsnapshot = pc.outputs().makeVector<o2::test::TriviallyCopyable>(pmrSnapshotSpec);
+    pmrsnapshot.emplace_back(o2::test::TriviallyCopyable{4, 5, 6});
+    pmrsnapshot.emplace_back(o2::test::TriviallyCopyable{7, 8, 9});
+    pc.outputs().snapshot(pmrSnapshotSpec, std::move(pmrsnapshot));
+
     // make a vector of POD and set some data
     pc.outputs().make<std::vector<int>>(OutputRef{"podvector"}) = {10, 21, 42};
 
@@ -178,6 +185,7 @@ DataProcessorSpec getSourceSpec()
                             OutputSpec{"TST", "ROOTSERLZDVEC", 0, Lifetime::Timeframe},
                             OutputSpec{"TST", "ROOTSERLZDVEC2", 0, Lifetime::Timeframe},
                             OutputSpec{"TST", "PMRTESTVECTOR", 0, Lifetime::Timeframe},
+                            OutputSpec{"TST", "PMRSNAPSHOT", 0, Lifetime::Timeframe},
                             OutputSpec{{"podvector"}, "TST", "PODVECTOR", 0, Lifetime::Timeframe}},
                            AlgorithmSpec(processingFct)};
 }
@@ -325,6 +333,12 @@ DataProcessorSpec getSinkSpec()
     auto header = o2::header::get<const o2::header::DataHeader*>(dataref.header);
     ASSERT_ERROR((header->payloadSize == sizeof(o2::test::TriviallyCopyable)));
 
+    LOG(INFO) << "extracting move-snapshot of PMR vector";
+    auto pmrsnapshot = pc.inputs().get<gsl::span<o2::test::TriviallyCopyable>>("inputPMRsnapshot");
+    ASSERT_ERROR(pmrsnapshot.size() == 2);
+    ASSERT_ERROR((pmrsnapshot[0] == o2::test::TriviallyCopyable{4, 5, 6}));
+    ASSERT_ERROR((pmrsnapshot[1] == o2::test::TriviallyCopyable{7, 8, 9}));
+
     LOG(INFO) << "extracting POD vector";
     // TODO: use the ReturnType helper once implemented
     //InputRecord::ReturnType<std::vector<int>> podvector;
@@ -353,6 +367,7 @@ DataProcessorSpec getSinkSpec()
                             InputSpec{"input14", "TST", "ROOTSERLZBLOBJ", 0, Lifetime::Timeframe},
                             InputSpec{"input15", "TST", "ROOTSERLZBLVECT", 0, Lifetime::Timeframe},
                             InputSpec{"inputPMR", "TST", "PMRTESTVECTOR", 0, Lifetime::Timeframe},
+                            InputSpec{"inputPMRsnapshot", "TST", "PMRSNAPSHOT", 0, Lifetime::Timeframe},
                             InputSpec{"inputPODvector", "TST", "PODVECTOR", 0, Lifetime::Timeframe},
                             InputSpec{"inputMP", ConcreteDataTypeMatcher{"TST", "MULTIPARTS"}, Lifetime::Timeframe}},
                            Outputs{OutputSpec{"TST", "MSGABLVECTORCPY", 0, Lifetime::Timeframe}},
@@ -18,6 +18,9 @@
 #include "Headers/DataHeader.h"
 #include "Framework/DataInputDirector.h"
 
+#include <TFile.h>
+#include <TTree.h>
+
 BOOST_AUTO_TEST_CASE(TestDatainputDirector)
 {
   using namespace o2::header;
@@ -108,3 +111,54 @@ BOOST_AUTO_TEST_CASE(TestDatainputDirector)
   BOOST_CHECK(didesc);
   BOOST_CHECK_EQUAL(didesc->getNumberInputfiles(), 3);
 }
+
+BOOST_AUTO_TEST_CASE(TestDataInputDirectorPrefetching)
+{
+  using namespace o2::header;
+  using namespace o2::framework;
+
+  // two files with two time frames each
+  std::vector<std::string> inputFiles = {"prefetch_0.root", "prefetch_1.root"};
+  for (size_t fi = 0; fi < inputFiles.size(); ++fi) {
+    TFile f(inputFiles[fi].c_str(), "RECREATE");
+    for (int tf = 1; tf <= 2; ++tf) {
+      auto dir = f.mkdir(("DF_" + std::to_string(tf)).c_str());
+      dir->cd();
+      TTree t("O2uno", "O2uno");
+      int x = 0;
+      float y = 0.;
+      t.Branch("fX", &x, "fX/I");
+      t.Branch("fY", &y, "fY/F");
+      for (int i = 0; i < 10 * tf; ++i) {
+        x = i + 100 * fi;
+        y = i;
+        t.Fill();
+      }
+      t.Write();
+    }
+    f.Close();
+  }
+
+  auto dh = DataHeader(DataDescription{"UNO"},
+                       DataOrigin{"AOD"},
+                       DataHeader::SubSpecificationType{0});
+  DataInputDirector didir(inputFiles);
+  didir.addPrefetchedTable(dh, {"fX"});
+  didir.setPrefetching(1, 100 * 1024 * 1024, 1);
+
+  // the trees are the same, whether they were prefetched or not
+  for (int counter = 0; counter < 2; ++counter) {
+    for (int numTF = 0; numTF < 2; ++numTF) {
+      auto tree = didir.getDataTree(dh, counter, numTF);
+      BOOST_REQUIRE(tree != nullptr);
+      BOOST_CHECK_EQUAL(tree->GetEntries(), 10 * (numTF + 1));
+      int x = -1;
+      tree->SetBranchAddress("fX", &x);
+      tree->GetEntry(3);
+      BOOST_CHECK_EQUAL(x, 3 + 100 * counter);
+      delete tree;
+    }
+  }
+  BOOST_CHECK(didir.getDataTree(dh, 2, 0) == nullptr);
+  didir.closeInputFiles();
+}
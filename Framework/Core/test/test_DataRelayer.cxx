@@ -23,7 +23,10 @@
 #include "Framework/WorkflowSpec.h"
 #include <Monitoring/Monitoring.h>
 #include <fairmq/FairMQTransportFactory.h>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <thread>
 
 using Monitoring = o2::monitoring::Monitoring;
 using namespace o2::framework;
@@ -593,3 +596,102 @@ BOOST_AUTO_TEST_CASE(SplitParts)
   BOOST_CHECK_NE(header2.get(), nullptr);
   BOOST_CHECK_NE(payload2.get(), nullptr);
 }
+
+/// Relay the parts of several timeslices from different threads while the
+/// completion is checked, verifying that all the timeslices are complete.
+BOOST_AUTO_TEST_CASE(TestConcurrentRelay)
+{
+  Monitoring metrics;
+  InputSpec spec1{"clusters", "TPC", "CLUSTERS"};
+  InputSpec spec2{"clusters_its", "ITS", "CLUSTERS"};
+
+  std::vector<InputRoute> inputs = {
+    InputRoute{spec1, 0, "Fake1", 0},
+    InputRoute{spec2, 1, "Fake2", 0}};
+
+  TimesliceIndex index;
+
+  auto policy = CompletionPolicyHelpers::consumeWhenAll();
+  DataRelayer relayer(policy, inputs, metrics, index);
+  constexpr size_t nTimeslices = 8;
+  relayer.setPipelineLength(nTimeslices);
+
+  DataHeader dh1;
+  dh1.dataDescription = "CLUSTERS";
+  dh1.dataOrigin = "TPC";
+  dh1.subSpecification = 0;
+  dh1.splitPayloadIndex = 0;
+  dh1.splitPayloadParts = 1;
+
+  DataHeader dh2;
+  dh2.dataDescription = "CLUSTERS";
+  dh2.dataOrigin = "ITS";
+  dh2.subSpecification = 0;
+  dh2.splitPayloadIndex = 0;
+  dh2.splitPayloadParts = 1;
+
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  auto createMessages = [&transport](DataHeader const& dh, size_t time) {
+    Stack stack{dh, DataProcessingHeader{time, 1}};
+    std::pair<FairMQMessagePtr, FairMQMessagePtr> messages{transport->CreateMessage(stack.size()), transport->CreateMessage(1000)};
+    memcpy(messages.first->GetData(), stack.data(), stack.size());
+    return messages;
+  };
+
+  // The first part of each timeslice associates it to a slot
+  for (size_t ti = 0; ti < nTimeslices; ++ti) {
+    auto [header, payload] = createMessages(dh1, ti);
+    BOOST_REQUIRE_EQUAL(relayer.relay(header, payload), DataRelayer::WillRelay);
+  }
+
+  // The second parts are relayed concurrently to the slots already associated
+  std::vector<std::pair<FairMQMessagePtr, FairMQMessagePtr>> parts;
+  for (size_t ti = 0; ti < nTimeslices; ++ti) {
+    parts.push_back(createMessages(dh2, ti));
+  }
+  std::vector<DataRelayer::RelayChoice> choices(nTimeslices, DataRelayer::Invalid);
+  std::atomic<bool> relaying = true;
+  std::thread checker([&relayer, &relaying]() {
+    while (relaying) {
+      std::vector<RecordAction> ready;
+      relayer.getReadyToProcess(ready);
+    }
+  });
+  std::vector<std::thread> threads;
+  for (size_t ti = 0; ti < nTimeslices; ++ti) {
+    threads.emplace_back([&relayer, &parts, &choices, ti]() {
+      choices[ti] = relayer.relay(parts[ti].first, parts[ti].second);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  relaying = false;
+  checker.join();
+
+  for (size_t ti = 0; ti < nTimeslices; ++ti) {
+    BOOST_CHECK_EQUAL(choices[ti], DataRelayer::WillRelay);
+    BOOST_CHECK_EQUAL(parts[ti].first.get(), nullptr);
+  }
+  BOOST_CHECK_EQUAL(relayer.getStats().relayedMessages.load(), 2 * nTimeslices);
+
+  // The checker thread might already have consumed the dirty flags, so mark all the slots again.
+  for (size_t ti = 0; ti < nTimeslices; ++ti) {
+    index.markAsDirty(TimesliceSlot{ti}, true);
+  }
+  std::vector<RecordAction> ready;
+  relayer.getReadyToProcess(ready);
+  BOOST_REQUIRE_EQUAL(ready.size(), nTimeslices);
+  std::vector<bool> seen(nTimeslices, false);
+  for (auto& action : ready) {
+    BOOST_CHECK_EQUAL(action.op, CompletionPolicy::CompletionOp::Consume);
+    auto timeslice = relayer.getTimesliceForSlot(action.slot);
+    BOOST_REQUIRE_LT(timeslice.value, nTimeslices);
+    seen[timeslice.value] = true;
+    auto result = relayer.getInputsForTimeslice(action.slot);
+    BOOST_REQUIRE_EQUAL(result.size(), 2);
+    BOOST_CHECK_EQUAL(result.at(0).size(), 1);
+    BOOST_CHECK_EQUAL(result.at(1).size(), 1);
+  }
+  BOOST_CHECK(std::all_of(seen.begin(), seen.end(), [](bool s) { return s; }));
+}
@@ -0,0 +1,104 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework EventMixing
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "Framework/EventMixing.h"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace o2::framework;
+
+namespace
+{
+std::vector<std::pair<int, int>> makeEvents(std::vector<int> const& bins, int firstId)
+{
+  std::vector<std::pair<int, int>> events;
+  for (auto bin : bins) {
+    events.emplace_back(bin, firstId++);
+  }
+  return events;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestMixingPairs)
+{
+  MixingPool<int> pool(2);
+  std::vector<std::pair<int, int>> pairs;
+  auto collect = [&pairs](int event, int partner) { pairs.emplace_back(event, partner); };
+
+  // first timeframe: events 0..4, event 4 is not binned
+  pool.mix(makeEvents({0, 1, 0, 0, -1}, 0), collect);
+  BOOST_CHECK((pairs == std::vector<std::pair<int, int>>{{2, 0}, {3, 0}, {3, 2}}));
+  BOOST_CHECK_EQUAL(pool.size(0), 2);
+  BOOST_CHECK_EQUAL(pool.size(1), 1);
+  BOOST_CHECK_EQUAL(pool.size(-1), 0);
+
+  // second timeframe: the partners are kept from the first one, at most two per bin
+  pairs.clear();
+  pool.mix(makeEvents({0, 1, 2}, 10), collect);
+  BOOST_CHECK((pairs == std::vector<std::pair<int, int>>{{10, 2}, {10, 3}, {11, 1}}));
+  BOOST_CHECK_EQUAL(pool.size(0), 2);
+  BOOST_CHECK_EQUAL(pool.size(2), 1);
+
+  pool.clear();
+  BOOST_CHECK_EQUAL(pool.size(0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestMixingTriplets)
+{
+  MixingPool<int> pool(3);
+  std::vector<std::vector<int>> triplets;
+  pool.mix<3>(makeEvents({0, 0, 0, 0, 0}, 0), [&triplets](int event, int first, int second) { triplets.push_back({event, first, second}); });
+  // event 2 with {0, 1}, event 3 with pairs of {0, 1, 2}, event 4 with pairs of {1, 2, 3}
+  BOOST_CHECK((triplets == std::vector<std::vector<int>>{{2, 0, 1}, {3, 0, 1}, {3, 0, 2}, {3, 1, 2}, {4, 1, 2}, {4, 1, 3}, {4, 2, 3}}));
+}
+
+BOOST_AUTO_TEST_CASE(TestMixingParallel)
+{
+  ProcessingPool threads(4);
+  MixingPool<std::vector<double>> serialPool(5);
+  MixingPool<std::vector<double>> parallelPool(5);
+
+  // the checks are done on the main thread, the sums are kept per slot
+  for (int timeframe = 0; timeframe < 3; ++timeframe) {
+    std::vector<std::pair<int, std::vector<double>>> events;
+    for (int i = 0; i < 200; ++i) {
+      events.emplace_back(i % 7, std::vector<double>{0.5 * i, 1. * timeframe});
+    }
+    double serialSum = 0;
+    int serialCount = 0;
+    serialPool.mix(events, [&](auto const& event, auto const& partner) {
+      serialSum += event[0] * partner[0] + partner[1];
+      ++serialCount;
+    });
+    std::vector<double> sums(threads.size(), 0);
+    std::vector<int> counts(threads.size(), 0);
+    parallelPool.mix(
+      events, [&](auto const& event, auto const& partner) {
+        auto slot = ProcessingSlot::current().slot;
+        sums[slot] += event[0] * partner[0] + partner[1];
+        ++counts[slot];
+      },
+      &threads);
+    double parallelSum = 0;
+    int parallelCount = 0;
+    for (int slot = 0; slot < threads.size(); ++slot) {
+      parallelSum += sums[slot];
+      parallelCount += counts[slot];
+    }
+    BOOST_CHECK_EQUAL(parallelCount, serialCount);
+    BOOST_CHECK_CLOSE(parallelSum, serialSum, 1e-9);
+  }
+}
@@ -203,3 +203,52 @@ BOOST_AUTO_TEST_CASE(TestGandivaTreeCreation)
   BOOST_REQUIRE(s.ok());
 #endif
 }
+
+BOOST_AUTO_TEST_CASE(TestCompilationCache)
+{
+  auto infield = o2::aod::track::Signed1Pt::asArrowField();
+  auto resfield = o2::aod::track::Pt::asArrowField();
+  auto schema = std::make_shared<arrow::Schema>(std::vector{infield, resfield});
+
+  auto before = compilationCacheStats();
+  auto projector1 = createProjector(schema, createOperations(o2::aod::track::Pt::Projector()), resfield);
+  auto projector2 = createProjector(schema, createOperations(o2::aod::track::Pt::Projector()), resfield);
+  auto after = compilationCacheStats();
+  BOOST_CHECK(projector1 == projector2);
+  BOOST_CHECK(after.hits >= before.hits + 1);
+  BOOST_CHECK(after.misses <= before.misses + 1);
+
+  Filter cut1 = o2::aod::track::signed1Pt > 0.5f;
+  Filter cut2 = o2::aod::track::signed1Pt > 1.5f;
+  auto filter1 = createFilter(schema, createOperations(cut1));
+  auto filter2 = createFilter(schema, createOperations(cut2));
+  BOOST_CHECK(filter1 != filter2);
+  BOOST_CHECK(createFilter(schema, createOperations(cut1)) == filter1);
+}
+
+BOOST_AUTO_TEST_CASE(TestRangePredicates)
+{
+  Filter cut = (o2::aod::track::signed1Pt > 0.5f) && (o2::aod::track::eta < 1.f);
+  auto predicate = rangePredicate(*cut.node);
+  BOOST_CHECK_EQUAL(predicate, "and gt fSigned1Pt 0.5 lt fEta 1");
+
+  auto node = parseRangePredicate(predicate);
+  BOOST_CHECK_EQUAL(rangePredicate(node), predicate);
+
+  auto ranges = [](double min, double max) {
+    return [min, max](std::string const& column) -> std::optional<ColumnRange> {
+      if (column == "fSigned1Pt") {
+        return ColumnRange{min, max};
+      }
+      return std::nullopt;
+    };
+  };
+  BOOST_CHECK(mayPass(node, ranges(0., 1.)));
+  BOOST_CHECK(!mayPass(node, ranges(-1., 0.5)));
+
+  // only the comparisons of a column with a literal constrain the rows
+  Configurable<float> ptCut{"ptCut", 0.5f, "pt cut"};
+  Filter withPlaceholder = (o2::aod::track::signed1Pt > ptCut) || (o2::aod::track::eta < 1.f);
+  BOOST_CHECK_EQUAL(rangePredicate(*withPlaceholder.node), "true");
+  BOOST_CHECK(mayPass(parseRangePredicate("true"), ranges(-1., 0.)));
+}
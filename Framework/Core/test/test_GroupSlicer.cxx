@@ -68,6 +68,10 @@ DECLARE_SOA_COLUMN(Boo, boo, bool);
 
 DECLARE_SOA_TABLE(EventExtra, "AOD", "EVTSXTRA", test::Arr, test::Boo);
 
+DECLARE_SOA_TABLE(TrksXSum, "AOD", "TRKSXSUM",
+                  test::EventId,
+                  test::X);
+
 } // namespace o2::aod
 BOOST_AUTO_TEST_CASE(GroupSlicerOneAssociated)
 {
@@ -323,6 +327,92 @@ BOOST_AUTO_TEST_CASE(EmptySliceables)
   }
 }
 
+BOOST_AUTO_TEST_CASE(GroupSlicerCache)
+{
+  TableBuilder builderE;
+  auto evtsWriter = builderE.cursor<aod::Events>();
+  for (auto i = 0; i < 20; ++i) {
+    evtsWriter(0, i, 0.5f * i, 2.f * i, 3.f * i);
+  }
+  auto evtTable = builderE.finalize();
+
+  TableBuilder builderT;
+  auto trksWriter = builderT.cursor<aod::TrksX>();
+  for (auto i = 0; i < 20; ++i) {
+    if (i == 3 || i == 19) {
+      continue;
+    }
+    for (auto j = 0.f; j < 5; j += 0.5f) {
+      trksWriter(0, i, 0.5f * j);
+    }
+  }
+  auto trkTable = builderT.finalize();
+  aod::Events e{evtTable};
+  aod::TrksX t{trkTable};
+
+  ArrowTableSlicingCache cache;
+  auto slices = cache.getSlices(trkTable, "fIndexEvents", 20);
+  BOOST_REQUIRE_EQUAL(slices->offsets.size(), 20);
+  BOOST_CHECK_EQUAL(slices->sizes[3], 0);
+  BOOST_CHECK_EQUAL(slices->sizes[19], 0);
+  BOOST_CHECK_EQUAL(slices->offsets[4], 30);
+  BOOST_CHECK_EQUAL(slices->sizes[4], 10);
+  // a different arrow::Table over the same data is grouped only once
+  auto sameTable = arrow::Table::Make(trkTable->schema(), trkTable->columns());
+  BOOST_CHECK(cache.getSlices(sameTable, "fIndexEvents", 20) == slices);
+
+  auto tt = std::make_tuple(t);
+  o2::framework::AnalysisDataProcessorBuilder::GroupSlicer g(e, tt, &cache);
+  unsigned int count = 0;
+  for (auto& slice : g) {
+    auto trks = std::get<aod::TrksX>(slice.associatedTables());
+    BOOST_CHECK_EQUAL(trks.size(), (count == 3 || count == 19) ? 0 : 10);
+    for (auto& trk : trks) {
+      BOOST_CHECK_EQUAL(trk.eventId(), count);
+    }
+    ++count;
+  }
+  BOOST_CHECK_EQUAL(count, 20);
+
+  cache.clear();
+  BOOST_CHECK(cache.getSlices(trkTable, "fIndexEvents", 20) != slices);
+}
+
+BOOST_AUTO_TEST_CASE(GroupSlicerCacheLifetime)
+{
+  auto makeTable = [](int shift) {
+    TableBuilder builderT;
+    auto trksWriter = builderT.cursor<aod::TrksX>();
+    for (auto i = 0; i < 100; ++i) {
+      trksWriter(0, i / 10 + shift, 0.f);
+    }
+    return builderT.finalize();
+  };
+
+  ArrowTableSlicingCache cache;
+  {
+    auto trkTable = makeTable(0);
+    BOOST_CHECK_EQUAL(cache.getSlices(trkTable, "fIndexEvents", 20)->sizes[0], 10);
+  }
+  // the memory of the index of the first table, which is gone, cannot be
+  // reused by the second one while its grouping is cached
+  auto trkTable = makeTable(1);
+  auto slices = cache.getSlices(trkTable, "fIndexEvents", 20);
+  BOOST_CHECK_EQUAL(slices->sizes[0], 0);
+  BOOST_CHECK_EQUAL(slices->sizes[1], 10);
+}
+
+BOOST_AUTO_TEST_CASE(GroupSlicerUnsortedIndex)
+{
+  TableBuilder builderT;
+  auto trksWriter = builderT.cursor<aod::TrksX>();
+  for (auto i : {0, 1, 2, 1}) {
+    trksWriter(0, i, 0.f);
+  }
+  auto trkTable = builderT.finalize();
+  BOOST_CHECK_THROW(ArrowTableSlicingCache::computeSlices(*trkTable->GetColumnByName("fIndexEvents"), 3), RuntimeErrorRef);
+}
+
 BOOST_AUTO_TEST_CASE(ArrowDirectSlicing)
 {
   int counts[] = {5, 5, 5, 4, 1};
@@ -378,3 +468,114 @@ BOOST_AUTO_TEST_CASE(ArrowDirectSlicing)
     BOOST_CHECK(cb->Equals(slices_bool[i]));
   }
 }
+
+BOOST_AUTO_TEST_CASE(GroupSlicerChunks)
+{
+  TableBuilder builderE;
+  auto evtsWriter = builderE.cursor<aod::Events>();
+  for (auto i = 0; i < 20; ++i) {
+    evtsWriter(0, i, 0.5f * i, 2.f * i, 3.f * i);
+  }
+  auto evtTable = builderE.finalize();
+
+  TableBuilder builderT;
+  auto trksWriter = builderT.cursor<aod::TrksX>();
+  for (auto i = 0; i < 20; ++i) {
+    for (auto j = 0; j < i % 4; ++j) {
+      trksWriter(0, i, 0.5f * j);
+    }
+  }
+  auto trkTable = builderT.finalize();
+  aod::Events e{evtTable};
+  aod::TrksX t{trkTable};
+  auto tt = std::make_tuple(t);
+  o2::framework::AnalysisDataProcessorBuilder::GroupSlicer g(e, tt);
+
+  // chunks of consecutive groups, processed out of order
+  int nChunks = 6;
+  for (auto chunk = nChunks - 1; chunk >= 0; --chunk) {
+    auto first = g.max * chunk / nChunks;
+    auto last = g.max * (chunk + 1) / nChunks;
+    auto slice = g.begin();
+    slice.advance(first);
+    for (auto position = first; position < last; ++position, ++slice) {
+      BOOST_CHECK_EQUAL(slice.groupingElement().globalIndex(), position);
+      auto trks = std::get<aod::TrksX>(slice.associatedTables());
+      BOOST_CHECK_EQUAL(trks.size(), position % 4);
+      for (auto& trk : trks) {
+        BOOST_CHECK_EQUAL(trk.eventId(), position);
+      }
+    }
+  }
+}
+
+namespace
+{
+struct SumTask {
+  static constexpr bool reentrant = true;
+  Produces<aod::TrksXSum> sums;
+  HistogramRegistry registry{"registry", {{"n", "n", {HistType::kTH1F, {{10, 0., 10.}}}}}};
+  void process(aod::Event const& event, aod::TrksX const& trks)
+  {
+    float sum = 0.f;
+    for (auto& trk : trks) {
+      sum += trk.x();
+    }
+    sums(event.globalIndex(), sum);
+    registry.fill(HIST("n"), trks.size());
+  }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(GroupSlicerParallelProcess)
+{
+  TableBuilder builderE;
+  auto evtsWriter = builderE.cursor<aod::Events>();
+  for (auto i = 0; i < 100; ++i) {
+    evtsWriter(0, i, 0.5f * i, 2.f * i, 3.f * i);
+  }
+  auto evtTable = builderE.finalize();
+
+  TableBuilder builderT;
+  auto trksWriter = builderT.cursor<aod::TrksX>();
+  for (auto i = 0; i < 100; ++i) {
+    for (auto j = 0; j < i % 7; ++j) {
+      trksWriter(0, i, 0.5f * j);
+    }
+  }
+  auto trkTable = builderT.finalize();
+  aod::Events e{evtTable};
+  aod::TrksX t{trkTable};
+  auto tt = std::make_tuple(t);
+
+  // the same task run serially and on several threads
+  SumTask serialTask;
+  TableBuilder serialBuilder;
+  serialTask.sums.resetCursor(serialBuilder);
+  o2::framework::AnalysisDataProcessorBuilder::GroupSlicer serialSlicer(e, tt);
+  for (auto& slice : serialSlicer) {
+    auto associatedSlices = slice.associatedTables();
+    AnalysisDataProcessorBuilder::invokeProcessWithArgsGeneric(serialTask, &SumTask::process, slice.groupingElement(), associatedSlices);
+  }
+
+  SumTask parallelTask;
+  TableBuilder parallelBuilder;
+  parallelTask.sums.resetCursor(parallelBuilder);
+  o2::framework::AnalysisDataProcessorBuilder::GroupSlicer parallelSlicer(e, tt);
+  ProcessingPool pool(4);
+  AnalysisDataProcessorBuilder::invokeProcessParallel(parallelTask, &SumTask::process, e, tt, parallelSlicer, pool);
+
+  BOOST_CHECK_EQUAL(parallelTask.sums.lastIndex(), serialTask.sums.lastIndex());
+  BOOST_CHECK_EQUAL(parallelTask.sums.lastIndex(), 99);
+  auto serialTable = serialBuilder.finalize();
+  auto parallelTable = parallelBuilder.finalize();
+  BOOST_REQUIRE_EQUAL(parallelTable->num_rows(), 100);
+  BOOST_CHECK(parallelTable->Equals(*serialTable));
+
+  auto serialHist = serialTask.registry.get<TH1>(HIST("n"));
+  auto parallelHist = parallelTask.registry.get<TH1>(HIST("n"));
+  BOOST_CHECK_EQUAL(parallelHist->GetEntries(), 100);
+  for (int bin = 1; bin <= 10; ++bin) {
+    BOOST_CHECK_EQUAL(parallelHist->GetBinContent(bin), serialHist->GetBinContent(bin));
+  }
+}
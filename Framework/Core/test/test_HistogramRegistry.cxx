@@ -15,6 +15,7 @@
 #include "Framework/HistogramRegistry.h"
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <random>
 
 using namespace o2;
 using namespace o2::framework;
@@ -129,3 +130,229 @@ BOOST_AUTO_TEST_CASE(HistogramRegistryStepTHn)
 
   registry.print();
 }
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryParallelFill)
+{
+  HistogramRegistry registry{"registry", {{"x", "x", {HistType::kTH1F, {{100, 0., 100.}}}}, {"step", "step", {HistType::kStepTHnF, {{10, 0., 10.}}, 2}}}};
+
+  ProcessingPool pool(4);
+  for (int iteration = 0; iteration < 3; ++iteration) {
+    registry.beginParallel(pool.size());
+    pool.run(100, [&registry](int chunk) {
+      registry.fill(HIST("x"), chunk + 0.5);
+      registry.fill(HIST("step"), 0, 1.5);
+    });
+    registry.endParallel();
+  }
+
+  auto& histo = registry.get<TH1>(HIST("x"));
+  BOOST_CHECK_EQUAL(histo->GetEntries(), 300);
+  for (int bin = 1; bin <= 100; ++bin) {
+    BOOST_CHECK_EQUAL(histo->GetBinContent(bin), 3);
+  }
+  auto values = registry.get<StepTHn>(HIST("step"))->getValues(0);
+  double sum = 0;
+  for (int i = 0; i < values->GetSize(); ++i) {
+    sum += values->GetAt(i);
+  }
+  BOOST_CHECK_EQUAL(sum, 300);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryParallelInsert)
+{
+  HistogramRegistry registry{"registry", {{"x", "x", {HistType::kTH1F, {{100, 0., 100.}}}}}};
+
+  ProcessingPool pool(4);
+  registry.beginParallel(pool.size());
+  // a histogram added during the parallel processing has its copies as well
+  registry.add("y", "y", HistType::kTH1F, {{100, 0., 100.}});
+  pool.run(100, [&registry](int chunk) {
+    registry.fill(HIST("x"), chunk + 0.5);
+    registry.fill(HIST("y"), chunk + 0.5);
+  });
+  registry.endParallel();
+
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("x"))->GetEntries(), 100);
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("y"))->GetEntries(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryGrowth)
+{
+  HistogramRegistry registry{"registry", {{"first", "first", {HistType::kTH1F, {{10, 0., 1.}}}}}};
+  // the reference stays valid when the registry grows
+  auto& first = registry.get<TH1>(HIST("first"));
+  for (int i = 0; i < 1000; ++i) {
+    registry.add(("h" + std::to_string(i)).data(), "", HistType::kTH1F, {{i + 1, 0., 1.}});
+  }
+  registry.add("last", "last", HistType::kTH1F, {{20, 0., 1.}});
+
+  BOOST_CHECK_EQUAL(first->GetNbinsX(), 10);
+  BOOST_CHECK(&first == &registry.get<TH1>(HIST("first")));
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("h0"))->GetNbinsX(), 1);
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("h511"))->GetNbinsX(), 512);
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("h999"))->GetNbinsX(), 1000);
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("last"))->GetNbinsX(), 20);
+  registry.fill(HIST("h999"), 0.5);
+  BOOST_CHECK_EQUAL(registry.get<TH1>(HIST("h999"))->GetEntries(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryBufferedFill)
+{
+  const AxisSpec variableAxisX{std::vector<double>{-1., -0.5, -0.1, 0., 0.2, 0.7, 1.}};
+  const AxisSpec variableAxisY{std::vector<double>{-1., 0., 0.5, 1.}};
+  auto makeRegistry = [&]() {
+    return HistogramRegistry{"registry", {
+                                           {"x", "x", {HistType::kTH1F, {{50, -1., 1.}}}},                                   //
+                                           {"xw", "xw", {HistType::kTH1D, {variableAxisX}}},                                 //
+                                           {"xy", "xy", {HistType::kTH2D, {{20, -1., 1.}, variableAxisY}}},                  //
+                                           {"xyz", "xyz", {HistType::kTH3F, {{10, -1., 1.}, {10, -1., 1.}, {5, -1., 1.}}}}, //
+                                           {"profile", "profile", {HistType::kTProfile, {{10, -1., 1.}}}},                  //
+                                           {"sparse", "sparse", {HistType::kTHnSparseD, {{10, -1., 1.}, {10, -1., 1.}}}}    //
+                                         }};
+  };
+  auto direct = makeRegistry();
+  auto buffered = makeRegistry();
+  buffered.setFillBufferSize(64);
+
+  auto fillBoth = [&](auto&&... positionAndWeight) {
+    direct.fill(positionAndWeight...);
+    buffered.fill(positionAndWeight...);
+  };
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(-1.2, 1.2);
+  std::uniform_real_distribution<double> weight(0.5, 2.);
+  for (int i = 0; i < 1000; ++i) {
+    double x = coordinate(generator), y = coordinate(generator), z = coordinate(generator), w = weight(generator);
+    fillBoth(HIST("x"), x);
+    fillBoth(HIST("xw"), x, w);
+    fillBoth(HIST("xy"), x, y, w);
+    fillBoth(HIST("xyz"), x, y, z);
+    fillBoth(HIST("profile"), x, y);
+    fillBoth(HIST("sparse"), x, y);
+  }
+
+  auto compare = [](TH1* lhs, TH1* rhs) {
+    BOOST_CHECK_EQUAL(lhs->GetEntries(), rhs->GetEntries());
+    BOOST_CHECK_EQUAL(lhs->GetSumw2N(), rhs->GetSumw2N());
+    for (int bin = 0; bin < lhs->GetNcells(); ++bin) {
+      BOOST_CHECK_EQUAL(lhs->GetBinContent(bin), rhs->GetBinContent(bin));
+      BOOST_CHECK_EQUAL(lhs->GetBinError(bin), rhs->GetBinError(bin));
+    }
+    double lhsStats[TH1::kNstat] = {0}, rhsStats[TH1::kNstat] = {0};
+    lhs->GetStats(lhsStats);
+    rhs->GetStats(rhsStats);
+    for (int i = 0; i < TH1::kNstat; ++i) {
+      BOOST_CHECK_EQUAL(lhsStats[i], rhsStats[i]);
+    }
+  };
+  compare(direct.get<TH1>(HIST("x")).get(), buffered.get<TH1>(HIST("x")).get());
+  compare(direct.get<TH1>(HIST("xw")).get(), buffered.get<TH1>(HIST("xw")).get());
+  compare(direct.get<TH2>(HIST("xy")).get(), buffered.get<TH2>(HIST("xy")).get());
+  compare(direct.get<TH3>(HIST("xyz")).get(), buffered.get<TH3>(HIST("xyz")).get());
+  compare(direct.get<TProfile>(HIST("profile")).get(), buffered.get<TProfile>(HIST("profile")).get());
+  BOOST_CHECK_EQUAL(direct.get<THnSparse>(HIST("sparse"))->GetEntries(), buffered.get<THnSparse>(HIST("sparse"))->GetEntries());
+
+  // pending fills are applied before the histograms are handed out
+  buffered.fill(HIST("x"), 0.1);
+  BOOST_CHECK_EQUAL(buffered.get<TH1>(HIST("x"))->GetEntries(), 1001);
+  buffered.fill(HIST("x"), 0.1);
+  buffered.setFillBufferSize(0);
+  buffered.fill(HIST("x"), 0.1);
+  BOOST_CHECK_EQUAL(buffered.get<TH1>(HIST("x"))->GetEntries(), 1003);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryBufferedFillNoSumOfWeights)
+{
+  // entries without sum of weights, from fills outside of the axis range or
+  // from weights cancelling each other, make GetStats recompute the stats
+  // from the bin contents
+  auto makeRegistry = []() {
+    return HistogramRegistry{"registry", {
+                                           {"overflow", "overflow", {HistType::kTH1D, {{10, 0., 1.}}}}, //
+                                           {"signed", "signed", {HistType::kTH1D, {{10, 0., 1.}}}}      //
+                                         }};
+  };
+  auto direct = makeRegistry();
+  auto buffered = makeRegistry();
+  buffered.setFillBufferSize(16);
+
+  auto fillBoth = [&](auto&&... positionAndWeight) {
+    direct.fill(positionAndWeight...);
+    buffered.fill(positionAndWeight...);
+  };
+  fillBoth(HIST("overflow"), -0.5);
+  fillBoth(HIST("overflow"), 1.5);
+  fillBoth(HIST("signed"), 0.35, 1.);
+  fillBoth(HIST("signed"), 0.35, -1.);
+  // the first fills are applied before the next ones are buffered
+  BOOST_CHECK_EQUAL(buffered.get<TH1>(HIST("overflow"))->GetEntries(), 2);
+  BOOST_CHECK_EQUAL(buffered.get<TH1>(HIST("signed"))->GetEntries(), 2);
+  for (int i = 0; i < 10; ++i) {
+    fillBoth(HIST("overflow"), 0.05 + 0.1 * i);
+    fillBoth(HIST("signed"), 0.05 + 0.1 * i, 0.5 + i);
+  }
+
+  auto compare = [](TH1* lhs, TH1* rhs) {
+    BOOST_CHECK_EQUAL(lhs->GetEntries(), rhs->GetEntries());
+    BOOST_CHECK_CLOSE(lhs->GetMean(), rhs->GetMean(), 1e-9);
+    BOOST_CHECK_CLOSE(lhs->GetStdDev(), rhs->GetStdDev(), 1e-9);
+  };
+  compare(direct.get<TH1>(HIST("overflow")).get(), buffered.get<TH1>(HIST("overflow")).get());
+  compare(direct.get<TH1>(HIST("signed")).get(), buffered.get<TH1>(HIST("signed")).get());
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryColumnFill)
+{
+  TableBuilder builder;
+  auto rowWriter = builder.persist<float, float>({"x", "y"});
+  for (int i = 0; i < 100; ++i) {
+    rowWriter(0, 0.1f * i, -0.05f * i);
+  }
+  auto table = builder.finalize();
+  using TestA = o2::soa::Table<o2::soa::Index<>, test::X, test::Y>;
+  TestA tests{table};
+
+  auto makeRegistry = []() {
+    return HistogramRegistry{"registry", {
+                                           {"x", "x", {HistType::kTH1F, {{20, 0., 8.}}}},                                  //
+                                           {"xy", "xy", {HistType::kTH2D, {{10, 0., 10.}, {10, -5., 0.}}}},                //
+                                           {"xw", "xw", {HistType::kTH1D, {{10, 0., 10.}}}},                               //
+                                           {"profile", "profile", {HistType::kTProfile, {{10, 0., 10.}}}},                 //
+                                           {"sparse", "sparse", {HistType::kTHnSparseF, {{10, 0., 10.}, {10, -5., 0.}}}} //
+                                         }};
+  };
+  auto columns = makeRegistry();
+  auto rows = makeRegistry();
+
+  columns.fillColumns<test::X>(HIST("x"), tests);
+  columns.fillColumns<test::X, test::Y>(HIST("xy"), tests, test::x > 3.0f);
+  columns.fillColumns<test::X, test::Y>(HIST("xw"), tests, test::y > -2.0f);
+  columns.fillColumns<test::X, test::Y>(HIST("profile"), tests);
+  columns.fillColumns<test::X, test::Y>(HIST("sparse"), tests);
+  for (auto& row : tests) {
+    rows.fill(HIST("x"), row.x());
+    if (row.x() > 3.0f) {
+      rows.fill(HIST("xy"), row.x(), row.y());
+    }
+    if (row.y() > -2.0f) {
+      rows.fill(HIST("xw"), row.x(), row.y());
+    }
+    rows.fill(HIST("profile"), row.x(), row.y());
+    rows.fill(HIST("sparse"), row.x(), row.y());
+  }
+
+  auto compare = [](TH1* lhs, TH1* rhs) {
+    BOOST_CHECK_EQUAL(lhs->GetEntries(), rhs->GetEntries());
+    for (int bin = 0; bin < lhs->GetNcells(); ++bin) {
+      BOOST_CHECK_EQUAL(lhs->GetBinContent(bin), rhs->GetBinContent(bin));
+      BOOST_CHECK_EQUAL(lhs->GetBinError(bin), rhs->GetBinError(bin));
+    }
+    BOOST_CHECK_EQUAL(lhs->GetMean(), rhs->GetMean());
+  };
+  compare(columns.get<TH1>(HIST("x")).get(), rows.get<TH1>(HIST("x")).get());
+  compare(columns.get<TH2>(HIST("xy")).get(), rows.get<TH2>(HIST("xy")).get());
+  compare(columns.get<TH1>(HIST("xw")).get(), rows.get<TH1>(HIST("xw")).get());
+  compare(columns.get<TProfile>(HIST("profile")).get(), rows.get<TProfile>(HIST("profile")).get());
+  BOOST_CHECK_EQUAL(columns.get<THnSparse>(HIST("sparse"))->GetEntries(), 100);
+  BOOST_CHECK_EQUAL(columns.get<TH1>(HIST("x"))->GetEntries(), 100);
+}
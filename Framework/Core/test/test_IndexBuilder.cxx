@@ -133,3 +133,62 @@ BOOST_AUTO_TEST_CASE(TestIndexBuilder)
     ++i;
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestIndexBuilderUnsortedParallel)
+{
+  TableBuilder b1;
+  auto w1 = b1.cursor<Points>();
+  TableBuilder b2;
+  auto w2 = b2.cursor<Distances>();
+  TableBuilder b3;
+  auto w3 = b3.cursor<Flags>();
+  TableBuilder b4;
+  auto w4 = b4.cursor<Categorys>();
+
+  for (auto i = 0; i < 10; ++i) {
+    w1(0, i * 2., i * 3., i * 4.);
+  }
+  // the flags and categories are not grouped by point, -1 is not associated to any point
+  std::array<int, 7> d{0, 1, 2, 4, 7, 8, 9};
+  std::array<int, 6> f{8, 2, -1, 0, 5, 1};
+  std::array<int, 7> c{3, 0, 8, 7, 1, 2, 5};
+  for (auto i : d) {
+    w2(0, i, i * 10.);
+  }
+  for (auto i : f) {
+    w3(0, i, static_cast<bool>(i % 2));
+  }
+  for (auto i : c) {
+    w4(0, i, i + 2);
+  }
+  Points st1{b1.finalize()};
+  Distances st2{b2.finalize()};
+  Flags st3{b3.finalize()};
+  Categorys st4{b4.finalize()};
+
+  ProcessingPool pool(3);
+  auto t5 = IndexExclusive::indexBuilder("test1", typename IDXs::persistent_columns_t{}, st1, std::tie(st1, st2, st3, st4), &pool);
+  BOOST_REQUIRE_EQUAL(t5->num_rows(), 4);
+  IDXs idxt{t5};
+  idxt.bindExternalIndices(&st1, &st2, &st3, &st4);
+  std::vector<int> points;
+  for (auto& row : idxt) {
+    points.push_back(row.pointId());
+    BOOST_REQUIRE(row.distance().pointId() == row.pointId());
+    BOOST_REQUIRE(row.flag().pointId() == row.pointId());
+    BOOST_REQUIRE(row.category().pointId() == row.pointId());
+  }
+  BOOST_CHECK((points == std::vector<int>{0, 1, 2, 8}));
+
+  auto t6 = IndexSparse::indexBuilder("test2", typename IDX2s::persistent_columns_t{}, st1, std::tie(st2, st1, st3, st4), &pool);
+  BOOST_REQUIRE_EQUAL(t6->num_rows(), st2.size());
+  IDXs idxs{t6};
+  std::array<int, 7> fs{3, 5, 1, -1, -1, 0, -1};
+  std::array<int, 7> cs{1, 4, 5, -1, 3, 2, -1};
+  auto i = 0;
+  for (auto const& row : idxs) {
+    BOOST_REQUIRE(row.flagId() == fs[i]);
+    BOOST_REQUIRE(row.categoryId() == cs[i]);
+    ++i;
+  }
+}
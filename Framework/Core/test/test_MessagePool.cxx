@@ -0,0 +1,65 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework MessagePool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "Framework/MessagePool.h"
+#include <fairmq/FairMQDevice.h>
+#include <fairmq/FairMQTransportFactory.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestSizeClass)
+{
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(0), 0);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(1), 0);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(MessagePool::MinBlockSize), 0);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(MessagePool::MinBlockSize + 1), 1);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(1000), 4);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(1024), 4);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(MessagePool::MaxBlockSize), MessagePool::NSizeClasses - 1);
+  BOOST_CHECK_EQUAL(MessagePool::sizeClass(MessagePool::MaxBlockSize + 1), -1);
+}
+
+BOOST_AUTO_TEST_CASE(TestRecycling)
+{
+  FairMQDevice device;
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  device.fChannels["pool"].emplace_back("pool", "push", transport);
+  MessagePool pool{&device, 1 << 20};
+
+  auto msg = pool.create("pool", 100);
+  BOOST_REQUIRE(msg != nullptr);
+  BOOST_CHECK_EQUAL(msg->GetSize(), 100);
+  void* block = msg->GetData();
+  BOOST_CHECK_EQUAL(pool.hits(), 0);
+  BOOST_CHECK_EQUAL(pool.misses(), 1);
+
+  // Releasing the message invokes the region callback, which puts the
+  // block back in the free list of its size class.
+  msg.reset();
+  auto recycled = pool.create("pool", 120);
+  BOOST_REQUIRE(recycled != nullptr);
+  BOOST_CHECK_EQUAL(recycled->GetData(), block);
+  BOOST_CHECK_EQUAL(recycled->GetSize(), 120);
+  BOOST_CHECK_EQUAL(pool.hits(), 1);
+
+  // The block is in use again, so a new one is needed for the same class.
+  auto other = pool.create("pool", 100);
+  BOOST_REQUIRE(other != nullptr);
+  BOOST_CHECK(other->GetData() != block);
+  BOOST_CHECK_EQUAL(pool.misses(), 2);
+
+  // Too large for the pool
+  BOOST_CHECK(pool.create("pool", MessagePool::MaxBlockSize + 1) == nullptr);
+}
@@ -0,0 +1,72 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework ProcessingPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "Framework/ProcessingPool.h"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestAllChunksProcessed)
+{
+  ProcessingPool pool(4);
+  BOOST_CHECK_EQUAL(pool.size(), 4);
+  BOOST_CHECK_EQUAL(ProcessingSlot::current().slot, -1);
+
+  // the checks are done on the main thread, the test tools are not thread safe
+  for (int iteration = 0; iteration < 10; ++iteration) {
+    std::vector<int> chunks(100, -1);
+    std::vector<int> slots(100, -1);
+    pool.run(chunks.size(), [&](int chunk) {
+      chunks[chunk] = ProcessingSlot::current().chunk;
+      slots[chunk] = ProcessingSlot::current().slot;
+    });
+    for (int chunk = 0; chunk < (int)chunks.size(); ++chunk) {
+      BOOST_CHECK_EQUAL(chunks[chunk], chunk);
+      BOOST_CHECK(slots[chunk] >= 0 && slots[chunk] < pool.size());
+    }
+  }
+  BOOST_CHECK_EQUAL(ProcessingSlot::current().slot, -1);
+  BOOST_CHECK_EQUAL(ProcessingSlot::current().chunk, -1);
+}
+
+BOOST_AUTO_TEST_CASE(TestChunkException)
+{
+  ProcessingPool pool(3);
+  std::atomic<int> processed = 0;
+  BOOST_CHECK_THROW(pool.run(50, [&processed](int chunk) {
+    ++processed;
+    if (chunk == 10) {
+      throw std::runtime_error("failed chunk");
+    }
+  }),
+                    std::runtime_error);
+  BOOST_CHECK(processed <= 50);
+
+  // the pool is still usable
+  processed = 0;
+  pool.run(20, [&processed](int) { ++processed; });
+  BOOST_CHECK_EQUAL(processed, 20);
+}
+
+BOOST_AUTO_TEST_CASE(TestSingleSlot)
+{
+  ProcessingPool pool(1);
+  BOOST_CHECK_EQUAL(pool.size(), 1);
+  std::vector<int> slots;
+  pool.run(5, [&slots](int) { slots.push_back(ProcessingSlot::current().slot); });
+  BOOST_CHECK(slots == std::vector<int>(5, 0));
+}
@@ -162,6 +162,46 @@ BOOST_AUTO_TEST_CASE(TestStreamServices)
   BOOST_CHECK_EQUAL(tt2->threadId, 2);
 }
 
+BOOST_AUTO_TEST_CASE(TestStreamServicesFallback)
+{
+  using namespace o2::framework;
+  ServiceRegistry registry;
+
+  DummyService t0{0};
+  DummyService t1{1};
+  registry.registerService(TypeIdHelpers::uniqueId<DummyService>(), &t0, ServiceKind::Stream, 0);
+
+  /// A thread without its own instance uses the one of thread 0...
+  auto tt1 = reinterpret_cast<DummyService*>(registry.get(TypeIdHelpers::uniqueId<DummyService>(), 1, ServiceKind::Serial));
+  BOOST_CHECK_EQUAL(tt1->threadId, 0);
+  /// ... until it registers its own.
+  registry.registerService(TypeIdHelpers::uniqueId<DummyService>(), &t1, ServiceKind::Stream, 1);
+  tt1 = reinterpret_cast<DummyService*>(registry.get(TypeIdHelpers::uniqueId<DummyService>(), 1, ServiceKind::Serial));
+  BOOST_CHECK_EQUAL(tt1->threadId, 1);
+  auto tt0 = reinterpret_cast<DummyService*>(registry.get(TypeIdHelpers::uniqueId<DummyService>(), 0, ServiceKind::Serial));
+  BOOST_CHECK_EQUAL(tt0->threadId, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestStreamRegistry)
+{
+  using namespace o2::framework;
+  ServiceRegistry registry;
+
+  DummyService t0{0};
+  DummyService s1{1};
+  registry.registerService(TypeIdHelpers::uniqueId<DummyService>(), &t0, ServiceKind::Stream, 0);
+
+  /// The stream registry uses its own instance, whatever the thread...
+  auto streamRegistry = registry.makeStreamRegistry({ServiceHandle{TypeIdHelpers::uniqueId<DummyService>(), &s1, ServiceKind::Stream}});
+  auto ts0 = reinterpret_cast<DummyService*>(streamRegistry.get(TypeIdHelpers::uniqueId<DummyService>(), 0, ServiceKind::Serial));
+  auto ts1 = reinterpret_cast<DummyService*>(streamRegistry.get(TypeIdHelpers::uniqueId<DummyService>(), 1, ServiceKind::Serial));
+  BOOST_CHECK_EQUAL(ts0->threadId, 1);
+  BOOST_CHECK_EQUAL(ts1->threadId, 1);
+  /// ... while the original one is left untouched.
+  auto tt0 = reinterpret_cast<DummyService*>(registry.get(TypeIdHelpers::uniqueId<DummyService>(), 0, ServiceKind::Serial));
+  BOOST_CHECK_EQUAL(tt0->threadId, 0);
+}
+
 BOOST_AUTO_TEST_CASE(TestServiceRegistryCtor)
 {
   using namespace o2::framework;
@@ -98,3 +98,35 @@ BOOST_AUTO_TEST_CASE(TestLRUReplacement)
     BOOST_CHECK(action == TimesliceIndex::ActionTaken::Wait);
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestFindSlot)
+{
+  using namespace o2::framework;
+  TimesliceIndex index;
+  index.resize(3);
+  data_matcher::VariableContext context;
+
+  BOOST_CHECK(TimesliceSlot::isValid(index.findSlot(TimesliceId{10})) == false);
+  index.associate(TimesliceId{10}, TimesliceSlot{1});
+  BOOST_CHECK_EQUAL(index.findSlot(TimesliceId{10}).index, 1);
+  // Reassociating the slot drops the old timeslice
+  index.associate(TimesliceId{20}, TimesliceSlot{1});
+  BOOST_CHECK(TimesliceSlot::isValid(index.findSlot(TimesliceId{10})) == false);
+  BOOST_CHECK_EQUAL(index.findSlot(TimesliceId{20}).index, 1);
+
+  context.put({0, uint64_t{30}});
+  context.commit();
+  auto [action, slot] = index.replaceLRUWith(context);
+  BOOST_CHECK(action == TimesliceIndex::ActionTaken::ReplaceUnused);
+  BOOST_CHECK_EQUAL(index.findSlot(TimesliceId{30}).index, slot.index);
+
+  index.markAsInvalid(slot);
+  BOOST_CHECK(TimesliceSlot::isValid(index.findSlot(TimesliceId{30})) == false);
+
+  // Variables filled directly need to be registered explicitly
+  index.getVariablesForSlot(TimesliceSlot{2}).put({0, uint64_t{40}});
+  index.getVariablesForSlot(TimesliceSlot{2}).commit();
+  BOOST_CHECK(TimesliceSlot::isValid(index.findSlot(TimesliceId{40})) == false);
+  index.indexSlot(TimesliceSlot{2});
+  BOOST_CHECK_EQUAL(index.findSlot(TimesliceId{40}).index, 2);
+}
@@ -20,6 +20,7 @@
 #include "Framework/Logger.h"
 
 #include <TTree.h>
+#include <TParameter.h>
 #include <TRandom.h>
 #include <arrow/table.h>
 
@@ -128,7 +129,7 @@ BOOST_AUTO_TEST_CASE(TreeToTableConversion)
 
   // save table as tree
   TFile* f2 = new TFile("table2tree.root", "RECREATE");
-  TableToTree ta2tr(table, f2, "mytree");
+  TableToTree ta2tr(withSourceRows(table, {ndp, 7}), f2, "mytree");
   stat = ta2tr.addAllBranches();
 
   auto t2 = ta2tr.process();
@@ -138,5 +139,105 @@ BOOST_AUTO_TEST_CASE(TreeToTableConversion)
   br = (TBranch*)t2->GetBranch("tests");
   BOOST_REQUIRE_EQUAL(br->GetEntries(), ndp);
 
+  // the schema of the saved table is identified by its hash
+  auto hash = (TParameter<double>*)t2->GetUserInfo()->FindObject("schema-hash");
+  BOOST_REQUIRE_NE(hash, nullptr);
+  BOOST_CHECK_EQUAL(static_cast<uint32_t>(hash->GetVal()), schemaHash(*table->schema()));
+  BOOST_CHECK_NE(schemaHash(*table->schema()), schemaHash(*table->schema()->RemoveField(0).ValueOrDie()));
+
+  // as are the numbers of rows of the sources of an index
+  TreeToTable tr2ta2;
+  tr2ta2.addColumn("ok");
+  tr2ta2.fill(t2);
+  BOOST_CHECK(getSourceRows(*tr2ta2.finalize()->schema()) == (std::vector<int64_t>{ndp, 7}));
+  BOOST_CHECK(getSourceRows(*table->schema()).empty());
+
   f2->Close();
 }
+
+BOOST_AUTO_TEST_CASE(TreeToTableVariableSize)
+{
+  using namespace o2::framework;
+  Int_t ndp = 1000;
+
+  TFile f1("tree2tablevla.root", "RECREATE");
+  TTree t1("t1", "a simple Tree with a variable size array");
+  Int_t n;
+  Float_t vals[10];
+  Short_t sid;
+  t1.Branch("n", &n, "n/I");
+  t1.Branch("vals", vals, "vals[n]/F");
+  t1.Branch("sid", &sid, "sid/S");
+  for (int i = 0; i < ndp; i++) {
+    n = i % 10;
+    for (int j = 0; j < n; j++) {
+      vals[j] = i + 0.1f * j;
+    }
+    sid = -i;
+    t1.Fill();
+  }
+  t1.Write();
+
+  TreeToTable tr2ta;
+  tr2ta.addColumn("n");
+  tr2ta.addColumn("vals");
+  tr2ta.addColumn("sid");
+  tr2ta.fill(&t1);
+  auto table = tr2ta.finalize();
+  f1.Close();
+
+  BOOST_REQUIRE_EQUAL(table->Validate().ok(), true);
+  BOOST_REQUIRE_EQUAL(table->num_rows(), ndp);
+  BOOST_REQUIRE_EQUAL(table->column(1)->type()->id(), arrow::list(arrow::float32())->id());
+
+  auto sids = std::static_pointer_cast<arrow::Int16Array>(table->column(2)->chunk(0));
+  auto lists = std::static_pointer_cast<arrow::ListArray>(table->column(1)->chunk(0));
+  auto values = std::static_pointer_cast<arrow::FloatArray>(lists->values());
+  for (int i = 0; i < ndp; i++) {
+    BOOST_CHECK_EQUAL(sids->Value(i), -i);
+    BOOST_REQUIRE_EQUAL(lists->value_length(i), i % 10);
+    for (int j = 0; j < i % 10; j++) {
+      BOOST_CHECK_EQUAL(values->Value(lists->value_offset(i) + j), i + 0.1f * j);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TreeToTableRequestedColumns)
+{
+  using namespace o2::framework;
+  Int_t ndp = 10000;
+
+  {
+    TFile f1("tree2tablecolumns.root", "RECREATE");
+    TTree t1("t1", "a tree with a small and a large branch");
+    Int_t small;
+    Double_t large[16];
+    t1.Branch("small", &small, "small/I");
+    t1.Branch("large", large, "large[16]/D");
+    TRandom rndm;
+    for (int i = 0; i < ndp; i++) {
+      small = i;
+      for (auto& value : large) {
+        value = rndm.Rndm();
+      }
+      t1.Fill();
+    }
+    t1.Write();
+  }
+
+  TFile f2("tree2tablecolumns.root", "READ");
+  auto t2 = (TTree*)f2.Get("t1");
+  BOOST_REQUIRE(t2 != nullptr);
+  auto largeBytes = t2->GetBranch("large")->GetZipBytes();
+
+  // only the requested branch is read from the file
+  TreeToTable tr2ta;
+  tr2ta.addColumn("small");
+  tr2ta.fill(t2);
+  auto table = tr2ta.finalize();
+
+  BOOST_REQUIRE_EQUAL(table->Validate().ok(), true);
+  BOOST_REQUIRE_EQUAL(table->num_columns(), 1);
+  BOOST_REQUIRE_EQUAL(table->num_rows(), ndp);
+  BOOST_CHECK_LT(f2.GetBytesRead(), largeBytes / 4);
+}
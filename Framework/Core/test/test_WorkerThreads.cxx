@@ -0,0 +1,90 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/DataProcessorSpec.h"
+#include "Framework/DataProcessorLabel.h"
+#include "Framework/DataProcessingHeader.h"
+#include "Framework/DataRefUtils.h"
+#include "Framework/ControlService.h"
+#include "Framework/CallbackService.h"
+#include "Framework/EndOfStreamContext.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace o2::framework;
+
+#define ASSERT_ERROR(condition)                                   \
+  if ((condition) == false) {                                     \
+    LOG(FATAL) << R"(Test condition ")" #condition R"(" failed)"; \
+  }
+
+constexpr int nTimeslices = 20;
+
+// The processor is run with --worker-threads 4 (see CMakeLists.txt), so that
+// its timeslices are processed concurrently by the worker threads. The sink
+// checks that every output is sent with the timeslice of its inputs.
+std::vector<DataProcessorSpec> defineDataProcessing(ConfigContext const&)
+{
+  DataProcessorSpec producer{
+    "producer",
+    Inputs{},
+    {OutputSpec{"TST", "A"}},
+    AlgorithmSpec{adaptStateless([counter = std::make_shared<int>(0)](DataAllocator& outputs, ControlService& control) {
+      outputs.snapshot(Output{"TST", "A"}, *counter);
+      if (++(*counter) == nTimeslices) {
+        control.endOfStream();
+        control.readyToQuit(QuitRequest::Me);
+      }
+    })}};
+
+  DataProcessorSpec processor{
+    "processor",
+    {InputSpec{"a", "TST", "A"}},
+    {OutputSpec{"TST", "B"}},
+    AlgorithmSpec{adaptStateful([]() {
+      auto mainThread = std::this_thread::get_id();
+      return adaptStateless([mainThread](InputRecord& inputs, DataAllocator& outputs) {
+        ASSERT_ERROR(std::this_thread::get_id() != mainThread);
+        auto value = inputs.get<int>("a");
+        // give the other workers the time to pick up the next timeslices
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        outputs.make<int>(Output{"TST", "B"}) = 2 * value;
+      });
+    })}};
+  processor.labels.push_back(DataProcessorLabel{"independent-timeslices"});
+
+  DataProcessorSpec sink{
+    "sink",
+    {InputSpec{"a", "TST", "A"},
+     InputSpec{"b", "TST", "B"}},
+    {},
+    AlgorithmSpec{adaptStateful([](CallbackService& callbacks) {
+      auto received = std::make_shared<int>(0);
+      callbacks.set(CallbackService::Id::EndOfStream, [received](EndOfStreamContext& context) {
+        ASSERT_ERROR(*received == nTimeslices);
+        context.services().get<ControlService>().readyToQuit(QuitRequest::All);
+      });
+      return adaptStateless([received](InputRecord& inputs) {
+        auto a = inputs.get<int>("a");
+        auto b = inputs.get<int>("b");
+        ASSERT_ERROR(b == 2 * a);
+        auto startTimeA = DataRefUtils::getHeader<DataProcessingHeader*>(inputs.get("a"))->startTime;
+        auto startTimeB = DataRefUtils::getHeader<DataProcessingHeader*>(inputs.get("b"))->startTime;
+        ASSERT_ERROR(startTimeA == startTimeB);
+        ++(*received);
+      });
+    })}};
+
+  return WorkflowSpec{producer, processor, sink};
+}
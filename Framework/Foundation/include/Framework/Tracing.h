@@ -41,6 +41,8 @@
   }
 #define TracyLockableN(T, V, N) T V
 #define LockableBase(T) T
+#define TracySharedLockableN(T, V, N) T V
+#define SharedLockableBase(T) T
 #endif
 
 #endif // O2_FRAMEWORK_TRACING_H_
@@ -15,9 +15,11 @@
 /// @brief
 
 #include <vector>
+#include <random>
 
 #include <benchmark/benchmark.h>
 
+#include "rANS/rans.h"
 #include "rANS/utils.h"
 
 static void BM_Array_Read_Copy(benchmark::State& state)
@@ -111,4 +113,68 @@ static void BM_Array_Write_Iterator(benchmark::State& state)
 
 BENCHMARK(BM_Array_Write_Iterator)->RangeMultiplier(2)->Range(10e4, 2 * 10e6);
 
+// source message with a realistic, steeply falling symbol distribution
+static std::vector<uint16_t> makeSourceMessage(size_t size)
+{
+  std::mt19937 generator(42);
+  std::geometric_distribution<uint16_t> distribution(0.05);
+  std::vector<uint16_t> message(size);
+  for (auto& symbol : message) {
+    symbol = distribution(generator);
+  }
+  return message;
+}
+
+template <size_t nStreams_V>
+static void BM_Encode_Interleaved(benchmark::State& state)
+{
+  const auto source = makeSourceMessage(state.range(0));
+  o2::rans::FrequencyTable frequencies;
+  frequencies.addSamples(std::begin(source), std::end(source));
+  const o2::rans::LiteralEncoder64<uint16_t> encoder{frequencies, 16};
+
+  std::vector<uint32_t> encodeBuffer(source.size() + 1024);
+  std::vector<uint16_t> literals;
+  for (auto _ : state) {
+    literals.clear();
+    benchmark::DoNotOptimize(encoder.process<nStreams_V>(std::begin(source), std::end(source), encodeBuffer.data(), literals));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * source.size() * sizeof(uint16_t));
+}
+
+BENCHMARK_TEMPLATE(BM_Encode_Interleaved, 2)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+BENCHMARK_TEMPLATE(BM_Encode_Interleaved, 4)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+BENCHMARK_TEMPLATE(BM_Encode_Interleaved, 8)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+BENCHMARK_TEMPLATE(BM_Encode_Interleaved, 16)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+
+template <size_t nStreams_V>
+static void BM_Decode_Interleaved(benchmark::State& state)
+{
+  const auto source = makeSourceMessage(state.range(0));
+  o2::rans::FrequencyTable frequencies;
+  frequencies.addSamples(std::begin(source), std::end(source));
+  const o2::rans::LiteralEncoder64<uint16_t> encoder{frequencies, 16};
+  const o2::rans::LiteralDecoder64<uint16_t> decoder{frequencies, 16};
+
+  std::vector<uint32_t> encodeBuffer(source.size() + 1024);
+  std::vector<uint16_t> literals;
+  const auto encodedEnd = encoder.process<nStreams_V>(std::begin(source), std::end(source), encodeBuffer.data(), literals);
+
+  std::vector<uint16_t> decodeBuffer(source.size());
+  for (auto _ : state) {
+    auto literalsCopy = literals;
+    decoder.process<nStreams_V>(encodedEnd, decodeBuffer.data(), source.size(), literalsCopy);
+    benchmark::DoNotOptimize(decodeBuffer.data());
+  }
+  if (decodeBuffer != source) {
+    state.SkipWithError("decoded message does not match source");
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * source.size() * sizeof(uint16_t));
+}
+
+BENCHMARK_TEMPLATE(BM_Decode_Interleaved, 2)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+BENCHMARK_TEMPLATE(BM_Decode_Interleaved, 4)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+BENCHMARK_TEMPLATE(BM_Decode_Interleaved, 8)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+BENCHMARK_TEMPLATE(BM_Decode_Interleaved, 16)->RangeMultiplier(4)->Range(10e4, 2 * 10e6);
+
 BENCHMARK_MAIN();
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <array>
 
 #include <fairlogger/Logger.h>
 
@@ -45,7 +46,8 @@ class Decoder : public internal::DecoderBase<coder_T, stream_T, source_T>
  public:
   using internal::DecoderBase<coder_T, stream_T, source_T>::DecoderBase;
 
-  template <typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<stream_T, stream_IT>, bool> = true>
+  // nStreams_V has to match the number of interleaved streams used for encoding.
+  template <size_t nStreams_V = internal::DefaultNStreams, typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<stream_T, stream_IT>, bool> = true>
   void process(stream_IT inputEnd, source_IT outputBegin, size_t messageLength) const;
 
  private:
@@ -53,7 +55,7 @@ class Decoder : public internal::DecoderBase<coder_T, stream_T, source_T>
 };
 
 template <typename coder_T, typename stream_T, typename source_T>
-template <typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<stream_T, stream_IT>, bool>>
+template <size_t nStreams_V, typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<stream_T, stream_IT>, bool>>
 void Decoder<coder_T, stream_T, source_T>::process(stream_IT inputEnd, source_IT outputBegin, size_t messageLength) const
 {
   using namespace internal;
@@ -72,26 +74,33 @@ void Decoder<coder_T, stream_T, source_T>::process(stream_IT inputEnd, source_IT
   // make Iter point to the last last element
   --inputIter;
 
-  ransDecoder_t rans0{this->mSymbolTablePrecission};
-  ransDecoder_t rans1{this->mSymbolTablePrecission};
+  static_assert(isValidNStreams_v<nStreams_V>, "number of interleaved streams must be a power of 2");
+  auto decoders = makeCoders<ransDecoder_t, nStreams_V>(this->mSymbolTablePrecission);
 
-  inputIter = rans0.init(inputIter);
-  inputIter = rans1.init(inputIter);
+  for (auto& decoder : decoders) {
+    inputIter = decoder.init(inputIter);
+  }
 
-  for (size_t i = 0; i < (messageLength & ~1); i += 2) {
-    const int64_t s0 = this->mReverseLUT[rans0.get()];
-    const int64_t s1 = this->mReverseLUT[rans1.get()];
-    *it++ = s0;
-    *it++ = s1;
-    inputIter = rans0.advanceSymbol(inputIter, this->mSymbolTable[s0]);
-    inputIter = rans1.advanceSymbol(inputIter, this->mSymbolTable[s1]);
+  const size_t nFullRounds = messageLength / nStreams_V;
+  std::array<int64_t, nStreams_V> symbols;
+  for (size_t round = 0; round < nFullRounds; ++round) {
+    // look up all states first: they are independent of each other
+    for (size_t i = 0; i < nStreams_V; ++i) {
+      symbols[i] = this->mReverseLUT[decoders[i].get()];
+    }
+    for (size_t i = 0; i < nStreams_V; ++i) {
+      *it++ = symbols[i];
+    }
+    for (size_t i = 0; i < nStreams_V; ++i) {
+      inputIter = decoders[i].advanceSymbol(inputIter, this->mSymbolTable[symbols[i]]);
+    }
   }
 
-  // last byte, if message length was odd
-  if (messageLength & 1) {
-    const int64_t s0 = this->mReverseLUT[rans0.get()];
-    *it = s0;
-    inputIter = rans0.advanceSymbol(inputIter, this->mSymbolTable[s0]);
+  // incomplete last round, if message length was not a multiple of nStreams_V
+  for (size_t i = 0; i < messageLength % nStreams_V; ++i) {
+    const int64_t s = this->mReverseLUT[decoders[i].get()];
+    *it++ = s;
+    inputIter = decoders[i].advanceSymbol(inputIter, this->mSymbolTable[s]);
   }
   t.stop();
   LOG(debug1) << "Decoder::" << __func__ << " { DecodedSymbols: " << messageLength << ","
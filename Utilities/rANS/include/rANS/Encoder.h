@@ -44,7 +44,9 @@ class Encoder : public internal::EncoderBase<coder_T, stream_T, source_T>
   //inherit constructors;
   using internal::EncoderBase<coder_T, stream_T, source_T>::EncoderBase;
 
-  template <typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<source_T, source_IT>, bool> = true>
+  // nStreams_V independent rANS states are interleaved symbol by symbol, giving the CPU nStreams_V
+  // independent dependency chains. The decoder has to be run with the same number of streams.
+  template <size_t nStreams_V = internal::DefaultNStreams, typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<source_T, source_IT>, bool> = true>
   const stream_IT process(source_IT inputBegin, source_IT inputEnd, stream_IT outputBegin) const;
 
  private:
@@ -52,7 +54,7 @@ class Encoder : public internal::EncoderBase<coder_T, stream_T, source_T>
 };
 
 template <typename coder_T, typename stream_T, typename source_T>
-template <typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<source_T, source_IT>, bool>>
+template <size_t nStreams_V, typename stream_IT, typename source_IT, std::enable_if_t<internal::isCompatibleIter_v<source_T, source_IT>, bool>>
 const stream_IT Encoder<coder_T, stream_T, source_T>::process(source_IT inputBegin, source_IT inputEnd, stream_IT outputBegin) const
 {
   using namespace internal;
@@ -65,8 +67,8 @@ const stream_IT Encoder<coder_T, stream_T, source_T>::process(source_IT inputBeg
     return outputBegin;
   }
 
-  ransCoder_t rans0{this->mSymbolTablePrecission};
-  ransCoder_t rans1{this->mSymbolTablePrecission};
+  static_assert(isValidNStreams_v<nStreams_V>, "number of interleaved streams must be a power of 2");
+  auto coders = makeCoders<ransCoder_t, nStreams_V>(this->mSymbolTablePrecission);
 
   stream_IT outputIter = outputBegin;
   source_IT inputIT = inputEnd;
@@ -79,17 +81,19 @@ const stream_IT Encoder<coder_T, stream_T, source_T>::process(source_IT inputBeg
     return coder.putSymbol(outputIter, encoderSymbol);
   };
 
-  // odd number of bytes?
-  if (inputBufferSize & 1) {
-    outputIter = encode(--inputIT, outputIter, rans0);
+  // symbol i is always encoded by coder i % nStreams_V. Encode the incomplete tail first.
+  for (size_t i = inputBufferSize % nStreams_V; i-- > 0;) {
+    outputIter = encode(--inputIT, outputIter, coders[i]);
   }
 
   while (inputIT != inputBegin) { // NB: working in reverse!
-    outputIter = encode(--inputIT, outputIter, rans1);
-    outputIter = encode(--inputIT, outputIter, rans0);
+    for (size_t i = nStreams_V; i-- > 0;) {
+      outputIter = encode(--inputIT, outputIter, coders[i]);
+    }
+  }
+  for (size_t i = nStreams_V; i-- > 0;) {
+    outputIter = coders[i].flush(outputIter);
   }
-  outputIter = rans1.flush(outputIter);
-  outputIter = rans0.flush(outputIter);
   // first iterator past the range so that sizes, distances and iterators work correctly.
   ++outputIter;
 
@@ -108,6 +112,7 @@ const stream_IT Encoder<coder_T, stream_T, source_T>::process(source_IT inputBeg
               << "streamTypeB: " << sizeof(stream_T) << ", "
               << "coderTypeB: " << sizeof(coder_T) << ", "
               << "probabilityBits: " << this->mSymbolTablePrecission << ", "
+              << "nStreams: " << nStreams_V << ", "
               << "inputBufferSizeB: " << inputBufferSizeB << "}";
 #endif
 
@@ -22,6 +22,8 @@
 #include <chrono>
 #include <type_traits>
 #include <iterator>
+#include <array>
+#include <utility>
 
 namespace o2
 {
@@ -83,6 +85,27 @@ class RANSTimer
   std::chrono::time_point<std::chrono::high_resolution_clock> mStop;
 };
 
+// number of interleaved rANS states used by the coders unless requested otherwise.
+// Two states correspond to the original coder layout, so data encoded before the
+// number of states became configurable is decoded with this value.
+inline constexpr size_t DefaultNStreams = 2;
+
+template <size_t nStreams_V>
+inline constexpr bool isValidNStreams_v = (nStreams_V > 0) && ((nStreams_V & (nStreams_V - 1)) == 0);
+
+template <typename coder_T, size_t... Is>
+inline std::array<coder_T, sizeof...(Is)> makeCodersImpl(size_t symbolTablePrecission, std::index_sequence<Is...>)
+{
+  return {{((void)Is, coder_T{symbolTablePrecission})...}};
+}
+
+// create an array of independent rANS coders sharing the same symbol table precision
+template <typename coder_T, size_t nCoders_V>
+inline std::array<coder_T, nCoders_V> makeCoders(size_t symbolTablePrecission)
+{
+  return makeCodersImpl<coder_T>(symbolTablePrecission, std::make_index_sequence<nCoders_V>{});
+}
+
 template <typename T, typename IT>
 inline constexpr bool isCompatibleIter_v = std::is_convertible_v<typename std::iterator_traits<IT>::value_type, T>;
 template <typename IT>
@@ -148,6 +148,33 @@ struct EncodeDecodeLiteral : public EncodeDecodeBase<o2::rans::LiteralEncoder, o
   std::vector<typename Params<coder_T>::source_t> literals;
 };
 
+template <typename coder_T, size_t nStreams_V, class dictString_T, class testString_T>
+struct EncodeDecodeInterleaved : public EncodeDecodeBase<o2::rans::Encoder, o2::rans::Decoder, coder_T, dictString_T, testString_T> {
+  void encode() override
+  {
+    BOOST_CHECK_NO_THROW(this->encoder.template process<nStreams_V>(std::begin(this->source.data), std::end(this->source.data), std::back_inserter(this->encodeBuffer)));
+  };
+  void decode() override
+  {
+    BOOST_CHECK_NO_THROW(this->decoder.template process<nStreams_V>(this->encodeBuffer.end(), std::back_inserter(this->decodeBuffer), this->source.data.size()));
+  };
+};
+
+template <typename coder_T, size_t nStreams_V, class dictString_T, class testString_T>
+struct EncodeDecodeLiteralInterleaved : public EncodeDecodeBase<o2::rans::LiteralEncoder, o2::rans::LiteralDecoder, coder_T, dictString_T, testString_T> {
+  void encode() override
+  {
+    BOOST_CHECK_NO_THROW(this->encoder.template process<nStreams_V>(std::begin(this->source.data), std::end(this->source.data), std::back_inserter(this->encodeBuffer), literals));
+  };
+  void decode() override
+  {
+    BOOST_CHECK_NO_THROW(this->decoder.template process<nStreams_V>(this->encodeBuffer.end(), std::back_inserter(this->decodeBuffer), this->source.data.size(), literals));
+    BOOST_CHECK(literals.empty());
+  };
+
+  std::vector<typename Params<coder_T>::source_t> literals;
+};
+
 template <typename coder_T, class dictString_T, class testString_T>
 struct EncodeDecodeDedup : public EncodeDecodeBase<o2::rans::DedupEncoder, o2::rans::DedupDecoder, coder_T, dictString_T, testString_T> {
   void encode() override
@@ -180,10 +207,26 @@ using testCase_t = boost::mpl::vector<EncodeDecode<uint32_t, EmptyTestString, Em
                                       EncodeDecodeDedup<uint32_t, FullTestString, FullTestString>,
                                       EncodeDecodeDedup<uint64_t, FullTestString, FullTestString>>;
 
+using interleavedTestCase_t = boost::mpl::vector<EncodeDecodeInterleaved<uint32_t, 4, FullTestString, FullTestString>,
+                                                 EncodeDecodeInterleaved<uint64_t, 4, FullTestString, FullTestString>,
+                                                 EncodeDecodeInterleaved<uint64_t, 8, EmptyTestString, EmptyTestString>,
+                                                 EncodeDecodeInterleaved<uint64_t, 16, FullTestString, FullTestString>,
+                                                 EncodeDecodeLiteralInterleaved<uint32_t, 8, FullTestString, FullTestString>,
+                                                 EncodeDecodeLiteralInterleaved<uint64_t, 4, EmptyTestString, FullTestString>,
+                                                 EncodeDecodeLiteralInterleaved<uint64_t, 16, EmptyTestString, FullTestString>>;
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(test_encodeDecode, testCase_T, testCase_t)
 {
   testCase_T testCase;
   testCase.encode();
   testCase.decode();
   testCase.check();
-};
\ No newline at end of file
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_encodeDecodeInterleaved, testCase_T, interleavedTestCase_t)
+{
+  testCase_T testCase;
+  testCase.encode();
+  testCase.decode();
+  testCase.check();
+};